@@ -0,0 +1,486 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Checking whole levels trees from the command line
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+#include <assert.h>
+#include <time.h>
+
+#include "kernel.h"
+
+#include "Err.h"
+#include "msgtrans.h"
+#include "Macros.h"
+#include "Debug.h"
+#include "DirIter.h"
+#include "FileUtils.h"
+#include "Hourglass.h"
+
+#include "BatchCheck.h"
+#include "FilePaths.h"
+#include "Utils.h"
+#include "DataType.h"
+#include "DFileUtils.h"
+#include "FilenamesData.h"
+#include "Filenames.h"
+#include "Map.h"
+#include "MapEdit.h"
+#include "MapEditCtx.h"
+#include "Obj.h"
+#include "ObjectsEdit.h"
+#include "ObjEditCtx.h"
+#include "MapAnims.h"
+#include "Mission.h"
+#include "Triggers.h"
+#include "MapTex.h"
+#include "MapTexData.h"
+#include "MapTexBitm.h"
+#include "ObjGfx.h"
+#include "ObjGfxData.h"
+#include "ObjGfxMesh.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+enum {
+  MaxGfxSets = 32,
+};
+
+typedef struct {
+  DataType data_type;
+  Filename leaf_name;
+  int count; /* of tiles or ground objects, or -1 if the file failed to load */
+} BatchCheckGfx;
+
+typedef struct {
+  int num_checked;
+  int num_failed;
+  int num_saved;
+  size_t ngfx;
+  BatchCheckGfx gfx[MaxGfxSets]; /* graphics used by missions checked so far */
+} BatchCheckStats;
+
+/* ---------------- Private functions ---------------- */
+
+static _Optional DFile *create_dfile(DataType const data_type)
+{
+  _Optional DFile *dfile = NULL;
+  switch (data_type)
+  {
+    case DataType_BaseMap:
+    case DataType_OverlayMap:
+      {
+        _Optional MapData *const map = data_type == DataType_BaseMap ?
+                                       map_create_base() : map_create_overlay();
+        if (map) {
+          dfile = map_get_dfile(&*map);
+        }
+      }
+      break;
+
+    case DataType_BaseObjects:
+    case DataType_OverlayObjects:
+      {
+        _Optional ObjectsData *const objects = data_type == DataType_BaseObjects ?
+                                 objects_create_base() : objects_create_overlay();
+        if (objects) {
+          dfile = objects_get_dfile(&*objects);
+        }
+      }
+      break;
+
+    case DataType_BaseMapAnimations:
+    case DataType_OverlayMapAnimations:
+      {
+        _Optional ConvAnimations *const anims = MapAnims_create();
+        if (anims) {
+          dfile = MapAnims_get_dfile(&*anims);
+        }
+      }
+      break;
+
+    default:
+      assert("Unsupported data type" == NULL);
+      break;
+  }
+  return dfile;
+}
+
+static void print_error(char const *const path, SFError const err)
+{
+  printf("%s: %s\n", path, get_error_text(err, path, ""));
+}
+
+static int load_gfx_count(char const *const path, DataType const data_type)
+{
+  /* Returns -1 if the graphics file could not be loaded */
+  SFError err = SFERROR(NoMem);
+  int count = -1;
+
+  if (data_type == DataType_MapTextures) {
+    _Optional MapTex *const textures = MapTex_create();
+    if (textures) {
+      DFile *const dfile = MapTex_get_dfile(&*textures);
+      err = load_compressed(dfile, path);
+      if (!SFError_fail(err)) {
+        count = MapTexBitmaps_get_count(&textures->tiles);
+      }
+      dfile_release(dfile);
+    }
+  } else {
+    assert(data_type == DataType_PolygonMeshes);
+    _Optional ObjGfx *const graphics = ObjGfx_create();
+    if (graphics) {
+      DFile *const dfile = ObjGfx_get_dfile(&*graphics);
+      err = load_compressed(dfile, path);
+      if (!SFError_fail(err)) {
+        count = ObjGfxMeshes_get_ground_count(&graphics->meshes);
+      }
+      dfile_release(dfile);
+    }
+  }
+
+  if (SFError_fail(err)) {
+    print_error(path, err);
+  }
+  return count;
+}
+
+static int get_gfx_count(char const *const levels_dir, DataType const data_type,
+  char const *const leaf_name, BatchCheckStats *const stats)
+{
+  /* Each graphics file is loaded once, however many missions use it */
+  assert(stats);
+  for (size_t i = 0; i < stats->ngfx; ++i) {
+    if (stats->gfx[i].data_type == data_type &&
+        !stricmp(stats->gfx[i].leaf_name, leaf_name)) {
+      return stats->gfx[i].count;
+    }
+  }
+
+  _Optional char *const path = make_file_path_in_subdir(levels_dir,
+                                 data_type_to_sub_dir(data_type), leaf_name);
+  if (!path) {
+    printf("%s\n", get_error_text(SFERROR(NoMem), "", ""));
+    return -1;
+  }
+
+  ++stats->num_checked;
+  int const count = load_gfx_count(&*path, data_type);
+  if (count < 0) {
+    ++stats->num_failed;
+  }
+  free(path);
+
+  if (stats->ngfx < ARRAY_SIZE(stats->gfx)) {
+    BatchCheckGfx *const gfx = &stats->gfx[stats->ngfx++];
+    gfx->data_type = data_type;
+    STRCPY_SAFE(gfx->leaf_name, leaf_name);
+    gfx->count = count;
+  }
+  return count;
+}
+
+static bool load_ref(char const *const levels_dir, char const *const mission_path,
+  FilenamesData const *const filenames, DataType const data_type,
+  DFile *const dfile)
+{
+  /* Loads a file that a mission refers to */
+  char const *const leaf_name = filenames_get(filenames, data_type);
+  _Optional char *const path = make_file_path_in_subdir(levels_dir,
+                                 data_type_to_sub_dir(data_type), leaf_name);
+  if (!path) {
+    printf("%s\n", get_error_text(SFERROR(NoMem), "", ""));
+    return false;
+  }
+
+  SFError const err = load_compressed(dfile, &*path);
+  if (SFError_fail(err)) {
+    printf("%s: %s: %s\n", mission_path, &*path, get_error_text(err, &*path, ""));
+  }
+  free(path);
+  return !SFError_fail(err);
+}
+
+static bool check_triggers(char const *const mission_path,
+  ObjEditContext const *const objects, TriggersData *const triggers)
+{
+  /* Every trigger (and the next target of every chain reaction) must be
+     on an object, otherwise it can never fire */
+  bool ok = true;
+  MapArea const all = {{0, 0}, {Obj_Size - 1, Obj_Size - 1}};
+
+  TriggersIter iter;
+  TriggerFullParam fparam;
+  for (MapPoint p = TriggersIter_get_first(&iter, triggers, &all, &fparam);
+       !TriggersIter_done(&iter);
+       p = TriggersIter_get_next(&iter, &fparam)) {
+    if (!objects_ref_is_object(ObjectsEdit_read_ref(objects, p))) {
+      printf("%s: %s trigger at %" PRIMapCoord ",%" PRIMapCoord " is not on an object\n",
+             mission_path, TriggerAction_to_string(fparam.param.action), p.x, p.y);
+      ok = false;
+    }
+  }
+
+  TriggersChainIter chain_iter;
+  for (MapPoint p = TriggersChainIter_get_first(&chain_iter, triggers, &all, &fparam);
+       !TriggersChainIter_done(&chain_iter);
+       p = TriggersChainIter_get_next(&chain_iter, &fparam)) {
+    if (!objects_ref_is_object(ObjectsEdit_read_ref(objects, p)) ||
+        !objects_ref_is_object(ObjectsEdit_read_ref(objects, fparam.next_coords))) {
+      printf("%s: chain reaction from %" PRIMapCoord ",%" PRIMapCoord " to %"
+             PRIMapCoord ",%" PRIMapCoord " is not between objects\n",
+             mission_path, p.x, p.y, fparam.next_coords.x, fparam.next_coords.y);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+static bool check_mission_refs(char const *const levels_dir,
+  char const *const mission_path, MissionData *const mission,
+  BatchCheckStats *const stats)
+{
+  /* Ship, flightpath and waypoint references are already checked when
+     the mission is read. This checks the files that the mission uses. */
+  FilenamesData const *const filenames = mission_get_filenames(mission);
+
+  _Optional MapData *const base_map = map_create_base();
+  _Optional MapData *const overlay_map = map_create_overlay();
+  _Optional ObjectsData *const base_objects = objects_create_base();
+  _Optional ObjectsData *const overlay_objects = objects_create_overlay();
+
+  bool ok = false;
+  if (!base_map || !overlay_map || !base_objects || !overlay_objects) {
+    printf("%s\n", get_error_text(SFERROR(NoMem), "", ""));
+  } else if (load_ref(levels_dir, mission_path, filenames, DataType_BaseMap,
+                      map_get_dfile(&*base_map)) &&
+             load_ref(levels_dir, mission_path, filenames, DataType_OverlayMap,
+                      map_get_dfile(&*overlay_map)) &&
+             load_ref(levels_dir, mission_path, filenames, DataType_BaseObjects,
+                      objects_get_dfile(&*base_objects)) &&
+             load_ref(levels_dir, mission_path, filenames, DataType_OverlayObjects,
+                      objects_get_dfile(&*overlay_objects))) {
+    MapEditContext const map = {.base = base_map, .overlay = overlay_map};
+    ObjEditContext const objects = {.base = base_objects,
+                                    .overlay = overlay_objects,
+                                    .triggers = mission_get_triggers(mission)};
+    ok = true;
+
+    int const num_tiles = get_gfx_count(levels_dir, DataType_MapTextures,
+                            filenames_get(filenames, DataType_MapTextures), stats);
+    if (num_tiles < 0) {
+      ok = false;
+    } else if (!MapEdit_check_tile_range(&map, (size_t)num_tiles)) {
+      printf("%s: %s\n", mission_path, msgs_lookup("TileSet"));
+      ok = false;
+    }
+
+    int const num_refs = get_gfx_count(levels_dir, DataType_PolygonMeshes,
+                           filenames_get(filenames, DataType_PolygonMeshes), stats);
+    if (num_refs < 0) {
+      ok = false;
+    } else if (!ObjectsEdit_check_ref_range(&objects, (size_t)num_refs)) {
+      printf("%s: %s\n", mission_path, msgs_lookup("ObjSet"));
+      ok = false;
+    }
+
+    if (!check_triggers(mission_path, &objects, mission_get_triggers(mission))) {
+      ok = false;
+    }
+  }
+
+  if (overlay_objects) {
+    dfile_release(objects_get_dfile(&*overlay_objects));
+  }
+  if (base_objects) {
+    dfile_release(objects_get_dfile(&*base_objects));
+  }
+  if (overlay_map) {
+    dfile_release(map_get_dfile(&*overlay_map));
+  }
+  if (base_map) {
+    dfile_release(map_get_dfile(&*base_map));
+  }
+  return ok;
+}
+
+static bool check_file(char const *const levels_dir, char *const full_path,
+  DataType const data_type, bool const resave, BatchCheckStats *const stats)
+{
+  assert(full_path);
+  assert(stats);
+
+  DEBUGF("Checking %s\n", full_path);
+  ++stats->num_checked;
+
+  _Optional MissionData *mission = NULL;
+  _Optional DFile *dfile = NULL;
+  if (data_type == DataType_Mission) {
+    mission = mission_create();
+    if (mission) {
+      dfile = mission_get_dfile(&*mission);
+    }
+  } else {
+    dfile = create_dfile(data_type);
+  }
+
+  if (!dfile) {
+    printf("%s\n", get_error_text(SFERROR(NoMem), "", ""));
+    ++stats->num_failed;
+    return false; /* give up */
+  }
+
+  bool ok = false;
+  SFError const err = load_compressed(&*dfile, full_path);
+  if (SFError_fail(err)) {
+    print_error(full_path, err);
+  } else {
+    ok = !mission || check_mission_refs(levels_dir, full_path, &*mission, stats);
+  }
+
+  if (ok && resave) {
+    SFError const save_err = save_compressed(&*dfile, full_path);
+    if (SFError_fail(save_err)) {
+      print_error(full_path, save_err);
+      ok = false;
+    } else {
+      _Optional const _kernel_oserror *const e = set_file_type(full_path,
+                                                   data_type_to_file_type(data_type));
+      if (e) {
+        printf("%s: %s\n", full_path, e->errmess);
+        ok = false;
+      } else {
+        ++stats->num_saved;
+      }
+    }
+  }
+
+  if (!ok) {
+    ++stats->num_failed;
+  }
+
+  dfile_release(&*dfile);
+  return true;
+}
+
+static bool check_dir(char const *const levels_dir, char const *const sub_dir,
+  DataType const data_type, bool const resave, BatchCheckStats *const stats)
+{
+  /* Returns false only if checking should stop */
+  assert(levels_dir);
+  assert(sub_dir);
+
+  _Optional char *const dir = make_file_path_in_dir(levels_dir, sub_dir);
+  if (!dir) {
+    printf("%s\n", get_error_text(SFERROR(NoMem), "", ""));
+    return false;
+  }
+
+  bool keep_going = true;
+  if (file_exists(&*dir)) {
+    int const file_type = data_type_to_file_type(data_type);
+    _Optional DirIterator *iter = NULL;
+    _Optional const _kernel_oserror *e = diriterator_make(&iter, 0, &*dir, NULL);
+
+    for (; keep_going && !e && iter && !diriterator_is_empty(&*iter);
+         e = diriterator_advance(&*iter)) {
+      DirIteratorObjectInfo info;
+      int const object_type = diriterator_get_object_info(&*iter, &info);
+
+      if (object_type != ObjectType_File || info.file_type != file_type) {
+        continue;
+      }
+
+      size_t const n = diriterator_get_object_path_name(&*iter, NULL, 0);
+      _Optional char *const full_path = malloc(n + 1);
+      if (!full_path) {
+        printf("%s\n", get_error_text(SFERROR(NoMem), "", ""));
+        keep_going = false;
+        break;
+      }
+
+      (void)diriterator_get_object_path_name(&*iter, &*full_path, n + 1);
+      keep_going = check_file(levels_dir, &*full_path, data_type, resave, stats);
+      free(full_path);
+    }
+
+    if (e) {
+      printf("%s\n", e->errmess);
+      ++stats->num_failed;
+    }
+    diriterator_destroy(iter);
+  }
+
+  free(dir);
+  return keep_going;
+}
+
+/* ---------------- Public functions ---------------- */
+
+bool BatchCheck_run(char const *const levels_dir, bool const resave)
+{
+  static struct {
+    char const *sub_dir;
+    DataType data_type;
+  } const dirs[] = {
+    { BASEMAP_DIR, DataType_BaseMap },
+    { BASEGRID_DIR, DataType_BaseObjects },
+    { BASEANIMS_DIR, DataType_BaseMapAnimations },
+    { LEVELMAP_DIR, DataType_OverlayMap },
+    { LEVELGRID_DIR, DataType_OverlayObjects },
+    { LEVELANIMS_DIR, DataType_OverlayMapAnimations },
+    { MISSION_E_DIR, DataType_Mission },
+    { MISSION_M_DIR, DataType_Mission },
+    { MISSION_H_DIR, DataType_Mission },
+    { MISSION_U_DIR, DataType_Mission },
+  };
+
+  assert(levels_dir);
+  DEBUGF("Checking levels in %s%s\n", levels_dir, resave ? " (resave)" : "");
+
+  BatchCheckStats stats = {.num_checked = 0, .num_failed = 0, .num_saved = 0,
+                           .ngfx = 0};
+  clock_t const start = clock();
+
+  hourglass_on();
+  for (size_t i = 0; i < ARRAY_SIZE(dirs); ++i) {
+    hourglass_percentage((int)((i * 100) / ARRAY_SIZE(dirs)));
+    if (!check_dir(levels_dir, dirs[i].sub_dir, dirs[i].data_type, resave,
+                   &stats)) {
+      break;
+    }
+  }
+  hourglass_off();
+
+  clock_t const elapsed = clock() - start;
+  printf("Checked %d files in %s (%d failed, %d saved)\n",
+         stats.num_checked, levels_dir, stats.num_failed, stats.num_saved);
+
+  if (elapsed > 0) {
+    printf("Time taken %.2f s (%.1f files/s)\n",
+           (double)elapsed / CLOCKS_PER_SEC,
+           (double)stats.num_checked * CLOCKS_PER_SEC / (double)elapsed);
+  }
+
+  return stats.num_failed == 0;
+}
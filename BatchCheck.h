@@ -0,0 +1,19 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Checking whole levels trees from the command line
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef BatchCheck_h
+#define BatchCheck_h
+
+#include <stdbool.h>
+
+/* Loads every map, objects grid, animations and mission file in a levels
+   directory (which has the same layout as the game's), optionally saving
+   each file again after loading it. Errors and a summary are written to
+   the standard output stream instead of being reported in the desktop.
+   Returns false if any file could not be loaded or saved. */
+bool BatchCheck_run(char const *levels_dir, bool resave);
+
+#endif
@@ -0,0 +1,1141 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Benchmarks of editing and rendering operations
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "Macros.h"
+#include "Debug.h"
+#include "Hourglass.h"
+#include "PalEntry.h"
+#include "ReaderFlex.h"
+#include "WriterFlex.h"
+#include "flex.h"
+
+#include "Bench.h"
+#include "Utils.h"
+#include "SFInit.h"
+#include "DFile.h"
+#include "DFileUtils.h"
+#include "Map.h"
+#include "MapAnims.h"
+#include "MapEdit.h"
+#include "MapEditCtx.h"
+#include "MapEditSel.h"
+#include "MTransfers.h"
+#include "MapTex.h"
+#include "MapTexData.h"
+#include "MapTexBitm.h"
+#include "Obj.h"
+#include "ObjectsEdit.h"
+#include "ObjEditCtx.h"
+#include "ObjGfx.h"
+#include "ObjGfxData.h"
+#include "Triggers.h"
+#include "Hill.h"
+#include "HillCache.h"
+#include "Mission.h"
+#include "Ships.h"
+#include "Paths.h"
+#include "Smooth.h"
+#include "MSnakes.h"
+#include "DrawTiles.h"
+#include "SprMem.h"
+#include "SprPoly.h"
+#include "Plot.h"
+#include "Vertex.h"
+#include "View.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+#define SPRITE_NAME "bench"
+
+enum {
+  MaxResults = 48,
+  MaxNameLen = 31,
+  NumShapes = 256, /* of each type */
+  MaxShapeSize = 32,
+  ClusterSizeLog2 = 4,
+  SmoothAreaSize = 64,
+  AnimSteps = 256,
+  NumTris = 4096,
+  PolyImageSize = 512, /* in pixels */
+  TriggerRounds = 64, /* each fills the triggers table */
+  SnakeSegments = 8, /* per line drawn with a snake */
+  NumMeshes = 1024,
+  CameraDistance = 65536 * 4, /* as for drawing objects in a view */
+  MinRepeats = 3,
+  MaxRepeats = 100,
+  MinBenchCs = 50, /* keep repeating until at least this much time is used */
+  RegressionPercent = 10,
+  RegressionCs = 2, /* smaller differences are timer noise */
+};
+
+typedef enum {
+  BenchMapKind_Random,
+  BenchMapKind_Clustered,
+  BenchMapKind_WorstCase,
+  BenchMapKind_Count
+} BenchMapKind;
+
+typedef enum {
+  BenchInput_None,
+  BenchInput_Map,
+  BenchInput_MapAnims,
+  BenchInput_MapSnakes, /* only if the textures have snakes */
+  BenchInput_Objects,
+  BenchInput_Hills,
+  BenchInput_Mission,
+  BenchInput_Meshes, /* only if graphics were loaded */
+} BenchInput;
+
+typedef struct {
+  char name[MaxNameLen + 1];
+  long int time; /* fastest run, in clock ticks */
+} BenchResult;
+
+typedef struct {
+  MapData *base;
+  MapData *overlay;
+  MapEditContext map;
+  MapTex *textures;
+  ObjectsData *base_objects;
+  ObjectsData *overlay_objects;
+  ObjEditContext objects;
+  ObjGfx *graphics; /* empty, so every object has no collision box */
+  _Optional ObjGfx *meshes; /* only if a graphics file was given */
+  _Optional ConvAnimations *anims; /* only for BenchInput_MapAnims */
+  _Optional MissionData *mission; /* only for BenchInput_Objects and _Mission */
+  int ntiles;
+  unsigned int seed;
+  size_t nresults;
+  BenchResult results[MaxResults];
+} BenchContext;
+
+typedef bool BenchFn(BenchContext *ctx);
+
+typedef struct {
+  char const *name;
+  BenchFn *fn;
+  BenchInput input;
+} BenchDef;
+
+/* ---------------- Private functions ---------------- */
+
+static unsigned int next_rand(BenchContext *const ctx, unsigned int const limit)
+{
+  /* Linear congruential generator, so that results are reproducible
+     regardless of the C library's implementation of rand() */
+  assert(ctx);
+  assert(limit > 0);
+  ctx->seed = (ctx->seed * 1664525u) + 1013904223u;
+  return (ctx->seed >> 8) % limit;
+}
+
+static MapPoint rand_point(BenchContext *const ctx)
+{
+  return (MapPoint){next_rand(ctx, Map_Size), next_rand(ctx, Map_Size)};
+}
+
+static MapRef rand_tile(BenchContext *const ctx)
+{
+  return map_ref_from_num((unsigned char)next_rand(ctx, (unsigned)ctx->ntiles));
+}
+
+static void generate_map(BenchContext *const ctx, BenchMapKind const kind)
+{
+  assert(ctx);
+  ctx->seed = (unsigned)kind + 1;
+
+  MapAreaIter iter;
+  MapArea const all = {{0, 0}, {Map_Size - 1, Map_Size - 1}};
+  MapRef cluster_tile = map_ref_from_num(0);
+
+  for (MapPoint p = MapAreaIter_get_first(&iter, &all);
+       !MapAreaIter_done(&iter);
+       p = MapAreaIter_get_next(&iter)) {
+    MapRef tile = map_ref_from_num(0);
+    switch (kind) {
+      case BenchMapKind_Random:
+        tile = rand_tile(ctx);
+        break;
+
+      case BenchMapKind_Clustered:
+        /* Blocks of the same tile with occasional exceptions */
+        if (((p.x | p.y) & ((1 << ClusterSizeLog2) - 1)) == 0) {
+          cluster_tile = rand_tile(ctx);
+        }
+        tile = next_rand(ctx, 16) ? cluster_tile : rand_tile(ctx);
+        break;
+
+      default:
+        /* Checkerboard defeats any optimisation for runs of one tile */
+        tile = map_ref_from_num((unsigned char)((p.x ^ p.y) & 1));
+        break;
+    }
+    MapEdit_write_tile(&ctx->map, p, tile, NULL);
+  }
+}
+
+static bool bench_flood(BenchContext *const ctx)
+{
+  MapEdit_flood_fill(&ctx->map, map_ref_from_num((unsigned char)(ctx->ntiles - 1)),
+                     (MapPoint){Map_Size / 2, Map_Size / 2}, NULL);
+  return true;
+}
+
+static bool bench_shapes(BenchContext *const ctx)
+{
+  for (int i = 0; i < NumShapes; ++i) {
+    MapPoint const a = rand_point(ctx);
+    MapPoint const b = MapPoint_add(a, (MapPoint){next_rand(ctx, MaxShapeSize),
+                                                 next_rand(ctx, MaxShapeSize)});
+    MapPoint const c = MapPoint_add(a, (MapPoint){next_rand(ctx, MaxShapeSize),
+                                                 next_rand(ctx, MaxShapeSize)});
+    MapRef const tile = rand_tile(ctx);
+
+    MapEdit_plot_circ(&ctx->map, a, next_rand(ctx, MaxShapeSize), tile, NULL);
+    MapEdit_plot_line(&ctx->map, a, b, tile, next_rand(ctx, 4), NULL);
+    MapEdit_plot_tri(&ctx->map, a, b, c, tile, NULL);
+  }
+  return true;
+}
+
+static bool bench_smooth(BenchContext *const ctx)
+{
+  MapAreaIter iter;
+  MapArea const area = {{0, 0}, {SmoothAreaSize - 1, SmoothAreaSize - 1}};
+  for (MapPoint p = MapAreaIter_get_first(&iter, &area);
+       !MapAreaIter_done(&iter);
+       p = MapAreaIter_get_next(&iter)) {
+    MapTexGroups_smooth(&ctx->map, &ctx->textures->groups, p, NULL);
+  }
+  return true;
+}
+
+static bool bench_snakes(BenchContext *const ctx)
+{
+  /* Draw lines with each snake in turn, as when dragging with the mouse */
+  MapSnakes *const snakes = &ctx->textures->snakes;
+  int const nsnakes = MapSnakes_get_count(snakes);
+  assert(nsnakes > 0);
+
+  for (int i = 0; i < NumShapes; ++i) {
+    MapPoint pos = rand_point(ctx);
+    MapSnakesContext snake_ctx;
+    MapSnakes_begin_line(&snake_ctx, &ctx->map, snakes, pos, i % nsnakes,
+                         next_rand(ctx, 2) != 0, NULL);
+
+    for (int s = 0; s < SnakeSegments; ++s) {
+      pos = MapPoint_add(pos, (MapPoint){next_rand(ctx, MaxShapeSize),
+                                         next_rand(ctx, MaxShapeSize)});
+      MapSnakes_plot_line(&snake_ctx, pos, NULL);
+    }
+  }
+  return true;
+}
+
+static bool transfers_equal(MapTransfer *const a, MapTransfer *const b)
+{
+  MapPoint const dims = MapTransfers_get_dims(a);
+  if (!MapPoint_compare(dims, MapTransfers_get_dims(b)) ||
+      MapTransfers_get_anim_count(a) != MapTransfers_get_anim_count(b)) {
+    return false;
+  }
+
+  for (MapPoint pos = {.y = 0}; pos.y < dims.y; ++pos.y) {
+    for (pos.x = 0; pos.x < dims.x; ++pos.x) {
+      if (map_ref_to_num(MapTransfers_read_ref(a, pos)) !=
+          map_ref_to_num(MapTransfers_read_ref(b, pos))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool write_read(DFile *const src, DFile *const dst)
+{
+  /* Writes one file to memory and reads it back into another */
+  bool success = false;
+  void *buffer = NULL;
+  if (flex_alloc(&buffer, (int)HIGHEST(dfile_get_min_size(src), 1))) {
+    Writer writer;
+    writer_flex_init(&writer, &buffer);
+    dfile_write(src, &writer);
+    long int const size = writer_destroy(&writer);
+
+    if (size != -1L && flex_extend(&buffer, (int)HIGHEST(size, 1))) {
+      Reader reader;
+      reader_flex_init(&reader, &buffer);
+      SFError const err = dfile_read(dst, &reader);
+      reader_destroy(&reader);
+      success = !SFError_fail(err);
+    }
+    flex_free(&buffer);
+  }
+  return success;
+}
+
+static bool round_trip(MapTransfer *const transfer)
+{
+  /* Write the transfer and check that it reads back the same */
+  _Optional MapTransfer *const copy = MapTransfer_create();
+  if (!copy) {
+    return false;
+  }
+
+  bool const success = write_read(MapTransfer_get_dfile(transfer),
+                                  MapTransfer_get_dfile(&*copy)) &&
+                       transfers_equal(transfer, &*copy);
+
+  dfile_release(MapTransfer_get_dfile(&*copy));
+  return success;
+}
+
+static bool bench_sparse_transfer(BenchContext *const ctx)
+{
+  MapEditSelection selection;
+  if (SFError_fail(MapEditSelection_init(&selection, NULL, NULL))) {
+    return false;
+  }
+
+  /* A sparse selection spanning the whole map */
+  for (int i = 0; i < NumShapes; ++i) {
+    MapEditSelection_select_circ(&selection, rand_point(ctx),
+                                 next_rand(ctx, MaxShapeSize));
+  }
+
+  bool success = false;
+  _Optional MapTransfer *const transfer = MapTransfers_grab_selection(&ctx->map,
+                                                                      &selection);
+  if (transfer) {
+    success = round_trip(&*transfer);
+    dfile_release(MapTransfer_get_dfile(&*transfer));
+  }
+
+  MapEditSelection_destroy(&selection);
+  return success;
+}
+
+static ObjRef rand_object(BenchContext *const ctx)
+{
+  return objects_ref_object(next_rand(ctx, Obj_ObjectCount));
+}
+
+static void generate_objects(BenchContext *const ctx, BenchMapKind const kind)
+{
+  /* Dense grids of objects, unlike real maps which are mostly empty */
+  assert(ctx);
+  ctx->seed = (unsigned)kind + 1;
+
+  MapAreaIter iter;
+  MapArea const all = {{0, 0}, {Obj_Size - 1, Obj_Size - 1}};
+  ObjRef cluster_obj = objects_ref_none();
+
+  for (MapPoint p = MapAreaIter_get_first(&iter, &all);
+       !MapAreaIter_done(&iter);
+       p = MapAreaIter_get_next(&iter)) {
+    ObjRef obj = objects_ref_none();
+    switch (kind) {
+      case BenchMapKind_Random:
+        if (next_rand(ctx, 2)) {
+          obj = rand_object(ctx);
+        }
+        break;
+
+      case BenchMapKind_Clustered:
+        if (((p.x | p.y) & ((1 << ClusterSizeLog2) - 1)) == 0) {
+          cluster_obj = next_rand(ctx, 4) ? objects_ref_none() : rand_object(ctx);
+        }
+        obj = cluster_obj;
+        break;
+
+      default:
+        /* An object on every location */
+        obj = objects_ref_object((size_t)(p.x ^ p.y) % Obj_ObjectCount);
+        break;
+    }
+    objects_set_ref(ctx->base_objects, p, obj);
+    objects_set_ref(ctx->overlay_objects, p, objects_ref_mask());
+  }
+}
+
+static bool bench_obj_shapes(BenchContext *const ctx)
+{
+  for (int i = 0; i < NumShapes; ++i) {
+    MapPoint const a = rand_point(ctx);
+    MapPoint const b = MapPoint_add(a, (MapPoint){next_rand(ctx, MaxShapeSize),
+                                                 next_rand(ctx, MaxShapeSize)});
+    MapPoint const c = MapPoint_add(a, (MapPoint){next_rand(ctx, MaxShapeSize),
+                                                 next_rand(ctx, MaxShapeSize)});
+    ObjRef const obj = rand_object(ctx);
+
+    ObjectsEdit_plot_circ(&ctx->objects, a, next_rand(ctx, MaxShapeSize), obj,
+                          NULL, &ctx->graphics->meshes);
+    ObjectsEdit_plot_line(&ctx->objects, a, b, obj, next_rand(ctx, 4), NULL,
+                          &ctx->graphics->meshes);
+    ObjectsEdit_plot_tri(&ctx->objects, a, b, c, obj, NULL,
+                         &ctx->graphics->meshes);
+  }
+  return true;
+}
+
+static bool bench_triggers(BenchContext *const ctx)
+{
+  /* Fill the triggers table with chain reactions then delete them by
+     overwriting their objects, many times over */
+  for (int round = 0; round < TriggerRounds; ++round) {
+    MapPoint points[TriggersMax];
+    for (size_t i = 0; i < ARRAY_SIZE(points); ++i) {
+      MapPoint p;
+      do {
+        p = rand_point(ctx);
+      } while (!objects_can_place(p));
+      points[i] = p;
+      ObjectsEdit_write_ref(&ctx->objects, p, rand_object(ctx),
+                            TriggersWipeAction_BreakChain, NULL,
+                            &ctx->graphics->meshes);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(points); ++i) {
+      TriggerFullParam const fparam = {
+        .param = {.action = TriggerAction_ChainReaction, .value = 0},
+        .next_coords = points[(i + 1) % ARRAY_SIZE(points)],
+      };
+      if (!ObjectsEdit_add_trigger(&ctx->objects, points[i], fparam, NULL)) {
+        return false;
+      }
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(points); ++i) {
+      ObjectsEdit_write_ref(&ctx->objects, points[i], objects_ref_none(),
+                            TriggersWipeAction_BreakChain, NULL,
+                            &ctx->graphics->meshes);
+    }
+  }
+  return true;
+}
+
+static void generate_hills(BenchContext *const ctx, BenchMapKind const kind)
+{
+  /* Hill objects only, from which the hills' heights are generated */
+  assert(ctx);
+  ctx->seed = (unsigned)kind + 1;
+
+  MapAreaIter iter;
+  MapArea const all = {{0, 0}, {Obj_Size - 1, Obj_Size - 1}};
+  bool cluster_is_hill = false;
+
+  for (MapPoint p = MapAreaIter_get_first(&iter, &all);
+       !MapAreaIter_done(&iter);
+       p = MapAreaIter_get_next(&iter)) {
+    bool is_hill = true;
+    switch (kind) {
+      case BenchMapKind_Random:
+        is_hill = next_rand(ctx, 4) == 0;
+        break;
+
+      case BenchMapKind_Clustered:
+        if (((p.x | p.y) & ((1 << ClusterSizeLog2) - 1)) == 0) {
+          cluster_is_hill = next_rand(ctx, 4) == 0;
+        }
+        is_hill = cluster_is_hill;
+        break;
+
+      default:
+        /* A hill on every location */
+        break;
+    }
+    objects_set_ref(ctx->base_objects, p,
+                    is_hill ? objects_ref_hill() : objects_ref_none());
+    objects_set_ref(ctx->overlay_objects, p, objects_ref_mask());
+  }
+}
+
+static _Optional ObjEditContext const *hill_objects;
+
+static bool read_hill(struct EditWin const *const edit_win, MapPoint const pos)
+{
+  /* There is no editing window from which to read objects */
+  NOT_USED(edit_win);
+  assert(hill_objects);
+  return hill_objects &&
+         objects_ref_is_hill(ObjectsEdit_read_ref(&*hill_objects, pos));
+}
+
+static void init_view(View *const view, int const zoom, MapAngle const angle)
+{
+  /* Projects objects in the same way as an editing window */
+  *view = (View){.config = {.zoom_factor = zoom, .angle = angle}};
+  int const map_scaler = SIGNED_R_SHIFT(256 << TexelToOSCoordLog2, zoom);
+  ObjGfxMeshes_set_direction(&view->plot_ctx,
+    (ObjGfxDirection){ObjGfxAngle_from_map(angle), {-OBJGFXMESH_ANGLE_QUART}, {0}},
+    map_scaler);
+}
+
+static bool bench_hill(BenchContext *const ctx)
+{
+  /* Generate all hills then rebuild a view's cache of their polygons
+     from every angle, as when a view is rotated */
+  HillsData hills;
+  hill_objects = &ctx->objects;
+  if (SFError_fail(hills_init(&hills, read_hill, NULL, NULL))) {
+    return false;
+  }
+  hills_make(&hills);
+
+  _Optional HillCache *const cache = HillCache_create();
+  if (cache) {
+    for (MapAngle angle = MapAngle_First; angle < MapAngle_Count; ++angle) {
+      View view;
+      init_view(&view, 0, angle);
+      HillCache_set_view(&*cache, &view, NULL);
+
+      MapAreaIter iter;
+      MapArea const all = {{0, 0}, {Hill_Size - 1, Hill_Size - 1}};
+      for (MapPoint p = MapAreaIter_get_first(&iter, &all);
+           !MapAreaIter_done(&iter);
+           p = MapAreaIter_get_next(&iter)) {
+        unsigned char colours[Hill_MaxPolygons] = {0};
+        unsigned char heights[HillCorner_Count] = {0};
+        HillType const hill_type = hills_read(&hills, p, &colours, &heights);
+
+        ObjGfxHillGeom geom;
+        ObjGfxMeshes_get_poly_hill(&view.plot_ctx, NULL, hill_type, &colours,
+                                   &heights, CameraDistance, (Vertex3D){0, 0, 0},
+                                   &geom);
+        HillCache_add(&*cache, p, &geom);
+      }
+    }
+    HillCache_destroy(cache);
+  }
+
+  hills_destroy(&hills);
+  hill_objects = NULL;
+  return cache != NULL;
+}
+
+static CoarsePoint3d rand_coarse_point(BenchContext *const ctx)
+{
+  return (CoarsePoint3d){(CoarseCoord)next_rand(ctx, UINT8_MAX + 1),
+                         (CoarseCoord)next_rand(ctx, UINT8_MAX + 1),
+                         (CoarseCoord)next_rand(ctx, UINT8_MAX + 1)};
+}
+
+static bool generate_mission(BenchContext *const ctx)
+{
+  /* As many ships and paths as a mission can hold, with every ship
+     following a path */
+  assert(ctx);
+  assert(ctx->mission);
+  ctx->seed = 1;
+
+  PathsData *const paths = mission_get_paths(&*ctx->mission);
+  ShipsData *const ships = mission_get_ships(&*ctx->mission);
+
+  _Optional Waypoint *first_waypoints[PathsMax];
+  size_t npaths = 0;
+  for (; npaths < ARRAY_SIZE(first_waypoints); ++npaths) {
+    _Optional Path *const path = paths_add(paths);
+    if (!path) {
+      return false;
+    }
+    for (int w = 0; w < PathMaxWaypoints; ++w) {
+      _Optional Waypoint *const waypoint =
+        path_add_waypoint(&*path, rand_coarse_point(ctx));
+      if (!waypoint) {
+        return false;
+      }
+      if (w == 0) {
+        first_waypoints[npaths] = waypoint;
+      }
+    }
+  }
+
+  for (int i = 0; i < ShipsMax; ++i) {
+    _Optional Ship *ship = NULL;
+    if (SFError_fail(ships_add(ships,
+                               FinePoint3d_from_coarse(rand_coarse_point(ctx)),
+                               (ShipDirection)next_rand(ctx, 8), ShipType_Fighter1,
+                               ShipBehaviour_Moving, ShipMission_NotImportant,
+                               (ShipFlags){0}, ShipPilot_None, &ship)) || !ship) {
+      return false;
+    }
+    _Optional Waypoint *const waypoint = first_waypoints[(size_t)i % npaths];
+    if (waypoint) {
+      ship_set_flightpath(&*ship, &*waypoint);
+    }
+  }
+  return true;
+}
+
+static bool bench_mission_io(BenchContext *const ctx)
+{
+  /* Save and reload a mission with many ships and paths */
+  assert(ctx->mission);
+  _Optional MissionData *const copy = mission_create();
+  if (!copy) {
+    return false;
+  }
+
+  bool const success = write_read(mission_get_dfile(&*ctx->mission),
+                                  mission_get_dfile(&*copy)) &&
+                       ships_get_count(mission_get_ships(&*copy)) ==
+                       ships_get_count(mission_get_ships(&*ctx->mission));
+
+  dfile_release(mission_get_dfile(&*copy));
+  return success;
+}
+
+static void read_tiles(void *const cb_arg, MapPoint const map_pos,
+  MapPoint const step, size_t const count, MapRef *const tile_refs,
+  bool *const is_selected)
+{
+  BenchContext const *const ctx = cb_arg;
+  MapEdit_read_tiles(&ctx->map, map_pos, step, count, tile_refs);
+  for (size_t i = 0; i < count; ++i) {
+    is_selected[i] = false;
+  }
+}
+
+static bool draw_tiles(BenchContext *const ctx, int const zoom)
+{
+  int const size = (Map_Size * MapTexSize) >> zoom;
+  SprMem sm;
+  if (!SprMem_init(&sm, 0)) {
+    return false;
+  }
+
+  bool success = SprMem_create_sprite(&sm, SPRITE_NAME, false,
+                   (Vertex){size, size}, DrawTilesModeNumber);
+  if (success) {
+    MapArea const scr_area = {{0, 0}, {Map_Size - 1, Map_Size - 1}};
+    bool needs_mask;
+    success = DrawTiles_to_sprite(&ctx->textures->tiles, &sm, SPRITE_NAME,
+                                  MapAngle_North, &scr_area, read_tiles, ctx,
+                                  zoom, NULL, &needs_mask);
+  }
+  SprMem_destroy(&sm);
+  return success;
+}
+
+static bool bench_draw_tiles(BenchContext *const ctx)
+{
+  return draw_tiles(ctx, 2);
+}
+
+static bool bench_draw_colours(BenchContext *const ctx)
+{
+  return draw_tiles(ctx, MapTexSizeLog2);
+}
+
+static bool bench_anims(BenchContext *const ctx)
+{
+  MapEditContext const *const map = &ctx->map;
+  for (int i = 0; i < AnimsMax; ++i) {
+    MapAnimParam param = {.period = (uint16_t)(1 + next_rand(ctx, 8))};
+    for (size_t f = 0; f < ARRAY_SIZE(param.tiles); ++f) {
+      param.tiles[f] = rand_tile(ctx);
+    }
+    if (!MapEdit_write_anim(map, rand_point(ctx), param, NULL)) {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < AnimSteps; ++i) {
+    (void)MapEdit_update_anims(map, 1, NULL);
+  }
+  return true;
+}
+
+static void rand_tri(BenchContext *const ctx, Vertex (*const tri)[3])
+{
+  int const max = PolyImageSize << DrawTilesModeXEig;
+  for (size_t v = 0; v < ARRAY_SIZE(*tri); ++v) {
+    (*tri)[v] = (Vertex){(int)next_rand(ctx, max), (int)next_rand(ctx, max)};
+  }
+}
+
+static bool fill_tris(BenchContext *const ctx, bool const use_sprpoly)
+{
+  SprMem sm;
+  if (!SprMem_init(&sm, 0)) {
+    return false;
+  }
+
+  bool success = SprMem_create_sprite(&sm, SPRITE_NAME, false,
+                   (Vertex){PolyImageSize, PolyImageSize}, DrawTilesModeNumber);
+  if (success && use_sprpoly) {
+    _Optional SpriteHeader *const sprite = SprMem_get_sprite_address(&sm, SPRITE_NAME);
+    SprPoly sp;
+    success = sprite && SprPoly_init_sprite(&sp, &*sprite,
+                (Vertex){DrawTilesModeXEig, DrawTilesModeYEig}, palette);
+    if (success) {
+      for (int i = 0; i < NumTris; ++i) {
+        Vertex tri[3];
+        rand_tri(ctx, &tri);
+        SprPoly_set_colour(&sp, (*palette)[i % NumColours]);
+        SprPoly_fill_tri(&sp, tri[0], tri[1], tri[2]);
+      }
+    }
+    if (sprite) {
+      SprMem_put_sprite_address(&sm, &*sprite);
+    }
+  } else if (success) {
+    success = SprMem_output_to_sprite(&sm, SPRITE_NAME);
+    if (success) {
+      for (int i = 0; i < NumTris; ++i) {
+        Vertex tri[3];
+        rand_tri(ctx, &tri);
+        plot_set_col((*palette)[i % NumColours]);
+        plot_move(tri[0]);
+        plot_move(tri[1]);
+        plot_fg_tri(tri[2]);
+      }
+      SprMem_restore_output(&sm);
+    }
+  }
+
+  SprMem_destroy(&sm);
+  return success;
+}
+
+static bool bench_sprpoly_tris(BenchContext *const ctx)
+{
+  ctx->seed = 1;
+  return fill_tris(ctx, true);
+}
+
+static bool bench_os_tris(BenchContext *const ctx)
+{
+  ctx->seed = 1; /* same triangles as bench_sprpoly_tris */
+  return fill_tris(ctx, false);
+}
+
+static int count_meshes(BenchContext const *const ctx)
+{
+  /* Number of normal objects that have a mesh in the loaded graphics */
+  assert(ctx);
+  if (!ctx->meshes) {
+    return 0;
+  }
+  int const nobj = ObjGfxMeshes_get_ground_count(&ctx->meshes->meshes) -
+                   Obj_RefMinObject;
+  return HIGHEST(0, LOWEST(nobj, Obj_ObjectCount));
+}
+
+static void plot_meshes(BenchContext *const ctx, View const *const view)
+{
+  assert(ctx->meshes);
+  int const nobj = count_meshes(ctx);
+  int const max = PolyImageSize << DrawTilesModeXEig;
+
+  for (int i = 0; i < NumMeshes; ++i) {
+    Vertex const centre = {(int)next_rand(ctx, max), (int)next_rand(ctx, max)};
+    ObjGfxMeshes_plot(&ctx->meshes->meshes, &view->plot_ctx, NULL,
+                      objects_ref_object(next_rand(ctx, (unsigned)nobj)), centre,
+                      CameraDistance, (Vertex3D){0, 0, 0}, palette, NULL,
+                      ObjGfxMeshStyle_Filled);
+  }
+}
+
+static bool draw_meshes(BenchContext *const ctx, bool const use_sprpoly)
+{
+  View view;
+  init_view(&view, 0, MapAngle_North);
+
+  SprMem sm;
+  if (!SprMem_init(&sm, 0)) {
+    return false;
+  }
+
+  bool success = SprMem_create_sprite(&sm, SPRITE_NAME, false,
+                   (Vertex){PolyImageSize, PolyImageSize}, DrawTilesModeNumber);
+  if (success && use_sprpoly) {
+    _Optional SpriteHeader *const sprite = SprMem_get_sprite_address(&sm, SPRITE_NAME);
+    SprPoly sp;
+    success = sprite && SprPoly_init_sprite(&sp, &*sprite,
+                (Vertex){DrawTilesModeXEig, DrawTilesModeYEig}, palette);
+    if (success) {
+      ObjGfxMeshes_set_sprite_target(&sp);
+      plot_meshes(ctx, &view);
+      ObjGfxMeshes_set_sprite_target(NULL);
+    }
+    if (sprite) {
+      SprMem_put_sprite_address(&sm, &*sprite);
+    }
+  } else if (success) {
+    success = SprMem_output_to_sprite(&sm, SPRITE_NAME);
+    if (success) {
+      plot_meshes(ctx, &view);
+      SprMem_restore_output(&sm);
+    }
+  }
+
+  SprMem_destroy(&sm);
+  return success;
+}
+
+static bool bench_sprpoly_meshes(BenchContext *const ctx)
+{
+  ctx->seed = 1;
+  return draw_meshes(ctx, true);
+}
+
+static bool bench_os_meshes(BenchContext *const ctx)
+{
+  ctx->seed = 1; /* same meshes as bench_sprpoly_meshes */
+  return draw_meshes(ctx, false);
+}
+
+static bool is_available(BenchContext const *const ctx, BenchInput const input)
+{
+  /* Some benchmarks need data which is optional */
+  assert(ctx);
+  switch (input) {
+    case BenchInput_MapSnakes:
+      return MapSnakes_get_count(&ctx->textures->snakes) > 0;
+
+    case BenchInput_Meshes:
+      return count_meshes(ctx) > 0;
+
+    default:
+      return true;
+  }
+}
+
+static bool prepare(BenchContext *const ctx, BenchInput const input,
+  BenchMapKind const kind)
+{
+  /* Generates the same input before every run of a benchmark */
+  assert(ctx);
+  switch (input) {
+    case BenchInput_Map:
+    case BenchInput_MapAnims:
+    case BenchInput_MapSnakes:
+      ctx->map = (MapEditContext){.base = ctx->base, .overlay = NULL,
+                   .anims = NULL, .prechange_cb = NULL, .redraw_cb = NULL};
+      generate_map(ctx, kind);
+
+      if (input == BenchInput_MapAnims) {
+        ctx->anims = MapAnims_create();
+        if (!ctx->anims) {
+          return false;
+        }
+        ctx->map.overlay = ctx->overlay;
+        ctx->map.anims = ctx->anims;
+        MapEdit_fill_area(&ctx->map, &(MapArea){{0, 0}, {Map_Size - 1, Map_Size - 1}},
+                          map_ref_mask(), NULL);
+      }
+      break;
+
+    case BenchInput_Objects:
+    case BenchInput_Mission:
+      ctx->mission = mission_create();
+      if (!ctx->mission) {
+        return false;
+      }
+
+      if (input == BenchInput_Mission) {
+        return generate_mission(ctx);
+      }
+
+      ctx->objects = (ObjEditContext){.base = ctx->base_objects,
+                       .overlay = ctx->overlay_objects,
+                       .triggers = mission_get_triggers(&*ctx->mission)};
+      generate_objects(ctx, kind);
+      break;
+
+    case BenchInput_Hills:
+      ctx->objects = (ObjEditContext){.base = ctx->base_objects,
+                       .overlay = ctx->overlay_objects};
+      generate_hills(ctx, kind);
+      break;
+
+    default:
+      break;
+  }
+  return true;
+}
+
+static void finish(BenchContext *const ctx)
+{
+  assert(ctx);
+  if (ctx->anims) {
+    dfile_release(MapAnims_get_dfile(&*ctx->anims));
+    ctx->anims = NULL;
+  }
+  if (ctx->mission) {
+    dfile_release(mission_get_dfile(&*ctx->mission));
+    ctx->mission = NULL;
+  }
+}
+
+static bool run(BenchContext *const ctx, char const *const prefix,
+  BenchDef const *const bench, BenchMapKind const kind)
+{
+  assert(ctx);
+  assert(bench);
+  assert(ctx->nresults < ARRAY_SIZE(ctx->results));
+
+  if (!is_available(ctx, bench->input)) {
+    printf("%s%s skipped\n", prefix, bench->name);
+    return true;
+  }
+
+  BenchResult *const result = &ctx->results[ctx->nresults++];
+  snprintf(result->name, sizeof(result->name), "%s%s", prefix, bench->name);
+  result->time = LONG_MAX;
+
+  /* A single run is too short to time reliably with a centisecond clock,
+     so repeat until enough time has passed and keep the fastest run */
+  clock_t const min_total = (clock_t)MinBenchCs * CLOCKS_PER_SEC / 100;
+  clock_t total = 0;
+  bool success = true;
+
+  for (int n = 0;
+       success && (n < MinRepeats || (total < min_total && n < MaxRepeats));
+       ++n) {
+    success = prepare(ctx, bench->input, kind);
+    if (success) {
+      clock_t const start = clock();
+      success = bench->fn(ctx);
+      clock_t const elapsed = clock() - start;
+      total += elapsed;
+      result->time = LOWEST(result->time, (long)elapsed);
+    }
+    finish(ctx);
+  }
+
+  if (!success) {
+    printf("%s failed\n", result->name);
+  }
+  return success;
+}
+
+static _Optional BenchResult const *find_result(BenchResult const *const results,
+  size_t const nresults, char const *const name)
+{
+  for (size_t i = 0; i < nresults; ++i) {
+    if (strcmp(results[i].name, name) == 0) {
+      return &results[i];
+    }
+  }
+  return NULL;
+}
+
+static bool report(BenchContext const *const ctx, _Optional char const *const baseline_path)
+{
+  /* Compare with the baseline, if any */
+  BenchResult baseline[MaxResults];
+  size_t nbaseline = 0;
+  bool have_baseline = false;
+
+  if (baseline_path) {
+    _Optional FILE *const f = fopen(&*baseline_path, "r");
+    if (f) {
+      have_baseline = true;
+      while (nbaseline < ARRAY_SIZE(baseline) &&
+             fscanf(&*f, "%31s %ld", baseline[nbaseline].name,
+                    &baseline[nbaseline].time) == 2) {
+        ++nbaseline;
+      }
+      fclose(&*f);
+    }
+  }
+
+  bool success = true;
+  for (size_t i = 0; i < ctx->nresults; ++i) {
+    BenchResult const *const result = &ctx->results[i];
+    printf("%-*s %8.2f s", MaxNameLen, result->name,
+           (double)result->time / CLOCKS_PER_SEC);
+
+    _Optional BenchResult const *const base = find_result(baseline, nbaseline, result->name);
+    if (base && base->time > 0) {
+      long int const diff = result->time - base->time;
+      long int const percent = (diff * 100) / base->time;
+      printf(" %+4ld%%", percent);
+      if (percent > RegressionPercent &&
+          diff > (long)RegressionCs * CLOCKS_PER_SEC / 100) {
+        printf(" regressed");
+        success = false;
+      }
+    }
+    printf("\n");
+  }
+
+  if (baseline_path && !have_baseline) {
+    /* Save the results as the baseline for future runs */
+    bool saved = false;
+    _Optional FILE *const f = fopen(&*baseline_path, "w");
+    if (f) {
+      saved = true;
+      for (size_t i = 0; saved && i < ctx->nresults; ++i) {
+        saved = fprintf(&*f, "%s %ld\n", ctx->results[i].name,
+                        ctx->results[i].time) >= 0;
+      }
+      if (fclose(&*f)) {
+        saved = false;
+      }
+    }
+    if (!saved) {
+      printf("%s\n", get_error_text(SFERROR(WriteFail), &*baseline_path, ""));
+      success = false;
+    }
+  }
+  return success;
+}
+
+static bool run_all(BenchContext *const ctx)
+{
+  static BenchDef const map_benches[] = {
+    { "flood", bench_flood, BenchInput_Map },
+    { "shapes", bench_shapes, BenchInput_Map },
+    { "smooth", bench_smooth, BenchInput_Map },
+    { "snakes", bench_snakes, BenchInput_MapSnakes },
+    { "draw_tiles", bench_draw_tiles, BenchInput_Map },
+    { "draw_colours", bench_draw_colours, BenchInput_Map },
+    { "anims", bench_anims, BenchInput_MapAnims },
+    { "sparse_transfer", bench_sparse_transfer, BenchInput_Map },
+    { "obj_shapes", bench_obj_shapes, BenchInput_Objects },
+    { "triggers", bench_triggers, BenchInput_Objects },
+    { "hill", bench_hill, BenchInput_Hills },
+  };
+  static BenchDef const other_benches[] = {
+    { "mission_io", bench_mission_io, BenchInput_Mission },
+    { "sprpoly_tris", bench_sprpoly_tris, BenchInput_None },
+    { "os_tris", bench_os_tris, BenchInput_None },
+    { "sprpoly_meshes", bench_sprpoly_meshes, BenchInput_Meshes },
+    { "os_meshes", bench_os_meshes, BenchInput_Meshes },
+  };
+  static char const *const map_prefixes[BenchMapKind_Count] = {
+    [BenchMapKind_Random] = "random.",
+    [BenchMapKind_Clustered] = "clustered.",
+    [BenchMapKind_WorstCase] = "worst.",
+  };
+
+  for (BenchMapKind kind = BenchMapKind_Random; kind < BenchMapKind_Count; ++kind) {
+    for (size_t i = 0; i < ARRAY_SIZE(map_benches); ++i) {
+      if (!run(ctx, map_prefixes[kind], &map_benches[i], kind)) {
+        return false;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < ARRAY_SIZE(other_benches); ++i) {
+    if (!run(ctx, "", &other_benches[i], BenchMapKind_Random)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* ---------------- Public functions ---------------- */
+
+bool Bench_run(char const *const tiles_path,
+  _Optional char const *const graphics_path,
+  _Optional char const *const baseline_path)
+{
+  assert(tiles_path);
+  DEBUGF("Running benchmarks with %s\n", tiles_path);
+
+  bool success = false;
+  _Optional MapData *const base = map_create_base();
+  _Optional MapData *const overlay = map_create_overlay();
+  _Optional MapTex *const textures = MapTex_create();
+  _Optional ObjectsData *const base_objects = objects_create_base();
+  _Optional ObjectsData *const overlay_objects = objects_create_overlay();
+  _Optional ObjGfx *const graphics = ObjGfx_create();
+  _Optional ObjGfx *const meshes = graphics_path ? ObjGfx_create() : NULL;
+
+  if (!base || !overlay || !textures || !base_objects || !overlay_objects ||
+      !graphics || (graphics_path && !meshes)) {
+    printf("%s\n", get_error_text(SFERROR(NoMem), "", ""));
+  } else {
+    DFile *const dfile = MapTex_get_dfile(&*textures);
+    char const *path = tiles_path;
+    SFError err = load_compressed(dfile, path);
+    if (!SFError_fail(err) && graphics_path && meshes) {
+      path = &*graphics_path;
+      err = load_compressed(ObjGfx_get_dfile(&*meshes), path);
+    }
+
+    if (SFError_fail(err)) {
+      printf("%s\n", get_error_text(err, path, ""));
+    } else if (set_saved_with_stamp(dfile, tiles_path)) {
+      /* Tile groups and snakes are needed for smoothing and snakes */
+      MapTex_load_metadata(&*textures);
+
+      BenchContext ctx = {
+        .base = &*base,
+        .overlay = &*overlay,
+        .textures = &*textures,
+        .base_objects = &*base_objects,
+        .overlay_objects = &*overlay_objects,
+        .graphics = &*graphics,
+        .meshes = meshes,
+        .anims = NULL,
+        .mission = NULL,
+        .ntiles = MapTexBitmaps_get_count(&textures->tiles),
+        .seed = 1,
+        .nresults = 0,
+      };
+
+      if (ctx.ntiles > 0) {
+        hourglass_on();
+        success = run_all(&ctx);
+        hourglass_off();
+        success = report(&ctx, baseline_path) && success;
+      }
+    }
+  }
+
+  if (meshes) {
+    dfile_release(ObjGfx_get_dfile(&*meshes));
+  }
+  if (graphics) {
+    dfile_release(ObjGfx_get_dfile(&*graphics));
+  }
+  if (overlay_objects) {
+    dfile_release(objects_get_dfile(&*overlay_objects));
+  }
+  if (base_objects) {
+    dfile_release(objects_get_dfile(&*base_objects));
+  }
+  if (textures) {
+    dfile_release(MapTex_get_dfile(&*textures));
+  }
+  if (overlay) {
+    dfile_release(map_get_dfile(&*overlay));
+  }
+  if (base) {
+    dfile_release(map_get_dfile(&*base));
+  }
+  return success;
+}
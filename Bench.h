@@ -0,0 +1,26 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Benchmarks of editing and rendering operations
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef Bench_h
+#define Bench_h
+
+#include <stdbool.h>
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+/* Times editing and rendering operations on reproducible synthetic maps,
+   objects grids and missions using the given map textures, and writes the
+   fastest of several runs of each to the standard output stream. Meshes are
+   only drawn if a graphics file is given, and snakes are only drawn if the
+   map textures have any. If a baseline file exists then each result is
+   compared with it; otherwise the results are saved as the new baseline.
+   Returns false if anything failed or regressed. */
+bool Bench_run(char const *tiles_path, _Optional char const *graphics_path,
+  _Optional char const *baseline_path);
+
+#endif
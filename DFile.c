@@ -28,6 +28,7 @@
 #include "WriterNull.h"
 #include "Reader.h"
 #include "StrExtra.h"
+#include "flex.h"
 
 #include "SFError.h"
 #include "DFile.h"
@@ -175,6 +176,7 @@ void dfile_init(DFile *const dfile,
   *dfile = (DFile){
     .is_modified = false,
     .name = NULL, /* untitled */
+    .snapshot = NULL,
     .read = read,
     .write = write,
     .get_min_size = get_min_size,
@@ -191,6 +193,10 @@ void dfile_destroy(DFile *const dfile)
     assert(removed == dfile);
     NOT_USED(removed);
   }
+  if (dfile->snapshot)
+  {
+    flex_free(&dfile->snapshot);
+  }
   free(dfile->name);
 }
 
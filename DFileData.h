@@ -40,6 +40,7 @@ struct DFile
   bool is_modified;
   int date[2];
   _Optional char *name;
+  void *snapshot; /* flex anchor for a compressed copy of the saved state */
   _Optional DFileReadFn *read;
   _Optional DFileWriteFn *write;
   _Optional DFileGetMinSizeFn *get_min_size;
@@ -27,16 +27,23 @@
 
 #include "Err.h"
 #include "msgtrans.h"
+#include "Macros.h"
 #include "Debug.h"
 #include "FOpenCount.h"
 #include "ReaderGKey.h"
 #include "WriterGKey.h"
 #include "WriterGKC.h"
+#include "ReaderFlex.h"
+#include "WriterFlex.h"
+#include "flex.h"
+#include "NoBudge.h"
 #include "DFile.h"
 #include "DFileUtils.h"
+#include "DFileData.h"
 #include "Utils.h"
 #include "FilePaths.h"
 #include "PathTail.h"
+#include "Instrument.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -45,6 +52,8 @@
 enum {
   HistoryLog2 = 9,
   WorstBitsPerChar = 9,
+  SnapshotPageSize = 256, /* one row of a ground map */
+  PreExpandHeap = 512,
 };
 
 char *get_leaf_name(DFile *const dfile)
@@ -99,6 +108,8 @@ SFError load_compressed(DFile *const dfile, char const *const fname)
   Fortify_CheckAllMemory();
 #endif
 
+  INSTRUMENT_START(Load);
+
   SFError err = SFERROR(OpenInFail);
   _Optional FILE *const f = fopen_inc(fname, "rb");
   if (f)
@@ -111,11 +122,14 @@ SFError load_compressed(DFile *const dfile, char const *const fname)
     else
     {
       err = dfile_read(dfile, &reader);
+      INSTRUMENT_COUNT(BytesDecompressed, reader_ftell(&reader));
       reader_destroy(&reader);
     }
     fclose_dec(&*f);
   }
 
+  INSTRUMENT_STOP(Load);
+
 #ifdef FORTIFY
   Fortify_CheckAllMemory();
 #endif
@@ -151,6 +165,8 @@ SFError save_compressed(DFile *const dfile, char *const fname)
   Fortify_CheckAllMemory();
 #endif
 
+  INSTRUMENT_START(Save);
+
   SFError err = SFERROR(OK);
   _Optional FILE *const f = fopen_inc(fname, "wb");
   if (!f)
@@ -180,6 +196,8 @@ SFError save_compressed(DFile *const dfile, char *const fname)
     }
   }
 
+  INSTRUMENT_STOP(Save);
+
 #ifdef FORTIFY
   Fortify_CheckAllMemory();
 #endif
@@ -196,3 +214,168 @@ long int worst_compressed_size(DFile *const dfile)
   return (long int)sizeof(int32_t) +
     ((orig_size * WorstBitsPerChar) / CHAR_BIT);
 }
+
+/* ----------------------------------------------------------------------- */
+
+bool take_snapshot(DFile *const dfile)
+{
+  assert(dfile);
+  DEBUGF("Taking snapshot of %p\n", (void *)dfile);
+
+  if (dfile->snapshot)
+  {
+    flex_free(&dfile->snapshot);
+  }
+
+  if (!flex_alloc(&dfile->snapshot, (int)worst_compressed_size(dfile)))
+  {
+    dfile->snapshot = NULL;
+    return false;
+  }
+
+  Writer writer;
+  writer_flex_init(&writer, &dfile->snapshot);
+  SFError const err = write_compressed(dfile, &writer);
+  if (writer_destroy(&writer) == -1L || SFError_fail(err))
+  {
+    flex_free(&dfile->snapshot);
+    return false;
+  }
+  return true;
+}
+
+bool has_snapshot(DFile const *const dfile)
+{
+  assert(dfile);
+  return dfile->snapshot != NULL;
+}
+
+long int compare_with_snapshot(DFile *const dfile,
+  _Optional DFileChangedFn *const changed, void *const arg)
+{
+  assert(dfile);
+  if (!dfile->snapshot)
+  {
+    return -1;
+  }
+
+  /* Serialise the current state without compression, so that it can be
+     compared with the decompressed snapshot a page at a time */
+  void *current = NULL;
+  long int const min_size = dfile_get_min_size(dfile);
+  if (!flex_alloc(&current, (int)HIGHEST(min_size, 1)))
+  {
+    return -1;
+  }
+
+  Writer writer;
+  writer_flex_init(&writer, &current);
+  dfile_write(dfile, &writer);
+  long int const current_size = writer_destroy(&writer);
+
+  long int nchanged = -1;
+  Reader flex_reader;
+  reader_flex_init(&flex_reader, &dfile->snapshot);
+
+  Reader gkreader;
+  if (current_size != -1L &&
+      reader_gkey_init_from(&gkreader, HistoryLog2, &flex_reader))
+  {
+    nchanged = 0;
+    for (long int offset = 0; ; offset += SnapshotPageSize)
+    {
+      char page[SnapshotPageSize];
+      size_t const nsaved = reader_fread(page, 1, sizeof(page), &gkreader);
+      size_t const ncurrent = offset < current_size ?
+                  (size_t)LOWEST(current_size - offset, SnapshotPageSize) : 0;
+      if (nsaved == 0 && ncurrent == 0)
+      {
+        break;
+      }
+
+      nobudge_register(PreExpandHeap);
+      bool const same = (nsaved == ncurrent) &&
+                        !memcmp(page, (char *)current + offset, nsaved);
+      nobudge_deregister();
+
+      if (!same)
+      {
+        ++nchanged;
+        if (!changed)
+        {
+          break; /* caller only wants to know whether anything differs */
+        }
+        changed(arg, offset, (long)HIGHEST(nsaved, ncurrent));
+      }
+    }
+
+    if (reader_ferror(&gkreader))
+    {
+      nchanged = -1;
+    }
+    reader_destroy(&gkreader);
+  }
+
+  reader_destroy(&flex_reader);
+  flex_free(&current);
+
+  DEBUGF("%ld pages of %p differ from its snapshot\n", nchanged, (void *)dfile);
+  return nchanged;
+}
+
+SFError revert_to_snapshot(DFile *const dfile)
+{
+  assert(dfile);
+  assert(dfile->snapshot);
+  DEBUGF("Reverting %p to its snapshot\n", (void *)dfile);
+
+  Reader reader;
+  reader_flex_init(&reader, &dfile->snapshot);
+  SFError const err = read_compressed(dfile, &reader);
+  reader_destroy(&reader);
+  return err;
+}
+
+SFError patch_uncompressed(DFile *const dfile, DFilePatchFn *const patch,
+  void *const arg)
+{
+  assert(dfile);
+  assert(patch);
+  DEBUGF("Patching %p\n", (void *)dfile);
+
+  void *buffer = NULL;
+  long int const min_size = dfile_get_min_size(dfile);
+  if (!flex_alloc(&buffer, (int)HIGHEST(min_size, 1)))
+  {
+    return SFERROR(NoMem);
+  }
+
+  Writer writer;
+  writer_flex_init(&writer, &buffer);
+  dfile_write(dfile, &writer);
+  long int size = writer_destroy(&writer);
+
+  SFError err = SFERROR(WriteFail);
+  if (size != -1L)
+  {
+    err = SFERROR(ReadFail);
+    if (patch(arg, &buffer, &size))
+    {
+      /* The reader consumes the whole block, so trim it to the data */
+      if (!flex_extend(&buffer, (int)HIGHEST(size, 1)))
+      {
+        err = SFERROR(NoMem);
+      }
+      else
+      {
+        Reader reader;
+        reader_flex_init(&reader, &buffer);
+        err = dfile_read(dfile, &reader);
+        reader_destroy(&reader);
+      }
+    }
+  }
+
+  flex_free(&buffer);
+  return err;
+}
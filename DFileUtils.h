@@ -26,4 +26,30 @@ SFError read_compressed(DFile *dfile, struct Reader *reader);
 
 long int worst_compressed_size(DFile *dfile);
 
+/* Keeps a compressed copy of the current state of a file in memory (e.g.
+   after loading or saving it), replacing any earlier copy. */
+bool take_snapshot(DFile *dfile);
+
+typedef void DFileChangedFn(void *arg, long int offset, long int size);
+
+/* Compares the current state of a file with its snapshot, page by page,
+   calling a function for each page that differs. Returns the number of pages
+   that differ (at most 1 if no function is given), or -1 if there is no
+   snapshot or there was an error. */
+long int compare_with_snapshot(DFile *dfile, _Optional DFileChangedFn *changed,
+  void *arg);
+
+bool has_snapshot(DFile const *dfile);
+
+/* Restores the state of a file from its snapshot, which must exist. */
+SFError revert_to_snapshot(DFile *dfile);
+
+typedef bool DFilePatchFn(void *arg, void **buffer, long int *size);
+
+/* Serialises the current state of a file without compression into a flex
+   block, calls a function to modify it, and then reads the file back from
+   the modified block. The function may resize the block but must update
+   the size of the data accordingly. */
+SFError patch_uncompressed(DFile *dfile, DFilePatchFn *patch, void *arg);
+
 #endif
@@ -94,6 +94,12 @@ Vertex Desktop_get_size_px(void)
   return desktop_size;
 }
 
+int Desktop_get_log2bpp(void)
+{
+  read_mode_vars();
+  return log2bpp;
+}
+
 Vertex Desktop_get_size_os(void)
 {
   read_mode_vars();
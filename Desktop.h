@@ -15,5 +15,6 @@ Vertex Desktop_get_size_px(void), Desktop_get_eigen_factors(void), Desktop_get_s
 void *Desktop_get_trans_table(void);
 void Desktop_put_trans_table(void *trans_table);
 int Desktop_get_screen_mode(void);
+int Desktop_get_log2bpp(void);
 
 #endif
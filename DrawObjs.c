@@ -35,6 +35,7 @@
 #include "ObjGfxMesh.h"
 #include "Plot.h"
 #include "DrawObjs.h"
+#include "HillCache.h"
 #include "ObjEditSel.h"
 #include "Vertex.h"
 #include "Obj.h"
@@ -367,6 +368,7 @@ void DrawObjs_to_screen(
   MapArea const *const scr_area,
   DrawObjsReadObjFn *const read_obj,
   DrawObjsReadHillFn *const read_hill, void *const cb_arg,
+  _Optional HillCache *const hill_cache,
   _Optional TriggersData *const triggers,
   _Optional ObjEditSelection const *const selection,
   Vertex const scr_orig,
@@ -383,6 +385,7 @@ void DrawObjs_to_screen(
   int const zoom = view->config.zoom_factor;
   int const grid_size_log2 = calc_grid_size_log2(zoom);
   int const grid_size = 1 << grid_size_log2;
+  MapPoint const row_step = ObjLayout_derotate_scr_row_step(view->config.angle);
   Vertex const offset_orig = Vertex_add(scr_orig, (Vertex){grid_size / 2, grid_size / 2});
 
   struct {
@@ -398,6 +401,10 @@ void DrawObjs_to_screen(
     plot_set_col(view->config.ghost_colour);
   }
 
+  if (hill_cache) {
+    HillCache_set_view(&*hill_cache, view, hill_colours);
+  }
+
   Vertex screen_pos = {.y = offset_orig.y + SIGNED_L_SHIFT(scr_area->min.y, grid_size_log2)};
 
   for (MapPoint scr_grid_pos = {.y = scr_area->min.y};
@@ -406,24 +413,28 @@ void DrawObjs_to_screen(
   {
     scr_grid_pos.x = scr_area->min.x;
     screen_pos.x = offset_orig.x + SIGNED_L_SHIFT(scr_grid_pos.x, grid_size_log2);
+    MapPoint map_pos = ObjLayout_derotate_scr_coords_to_map(view->config.angle, scr_grid_pos);
 
     for (; scr_grid_pos.x <= scr_area->max.x;
-         scr_grid_pos.x++, screen_pos.x += grid_size)
+         scr_grid_pos.x++, screen_pos.x += grid_size, map_pos = MapPoint_add(map_pos, row_step))
     {
-      MapPoint const map_pos = ObjLayout_derotate_scr_coords_to_map(view->config.angle, scr_grid_pos);
 
       bool const is_selected = selection && ObjEditSelection_is_selected(&*selection, map_pos);
 
-      if ((map_pos.x % Hill_ObjPerHill) == 0 && (map_pos.y % Hill_ObjPerHill) == 0)
+      if ((map_pos.x % Hill_ObjPerHill) == 0 && (map_pos.y % Hill_ObjPerHill) == 0 &&
+          hill_colours)
       {
-        unsigned char colours[Hill_MaxPolygons];
-        unsigned char heights[HillCorner_Count];
-        HillType const hill_type = read_hill(cb_arg,
-                                             MapPoint_div_log2(map_pos, Hill_ObjPerHillLog2),
-                                             &colours, &heights);
+        MapPoint const hill_pos = MapPoint_div_log2(map_pos, Hill_ObjPerHillLog2);
+        _Optional ObjGfxHillGeom const *geom = hill_cache ? HillCache_find(&*hill_cache, hill_pos) : NULL;
+        ObjGfxHillGeom new_geom;
+
+        if (!geom) {
+          unsigned char colours[Hill_MaxPolygons];
+          unsigned char heights[HillCorner_Count];
+          HillType const hill_type = read_hill(cb_arg, hill_pos, &colours, &heights);
+          DEBUGF("DrawObjs read hill type %d at %" PRIMapCoord ",%" PRIMapCoord "\n",
+                 hill_type, map_pos.x, map_pos.y);
 
-        if (hill_type != HillType_None && hill_colours)
-        {
           /* Hills are drawn relative to the centre of a grid square, like any other object.
              Unlike most other objects (which are centred), the origin of a hill ('o') could
              be one corner or even entirely outside a one-polygon hill:
@@ -436,12 +447,17 @@ void DrawObjs_to_screen(
            . A .   . D .
            (Even if points A, B and D have height 0, triangle BCD is plotted relative to 'o'.)
           */
-          ObjGfxMeshes_plot_poly_hill(&view->plot_ctx, hill_colours, hill_type, &colours, &heights,
-            screen_pos, CameraDistance, world_pos, palette, NULL,
-            is_ghost ? ObjGfxMeshStyle_Wireframe : ObjGfxMeshStyle_Filled);
+          ObjGfxMeshes_get_poly_hill(&view->plot_ctx, hill_colours, hill_type, &colours, &heights,
+            CameraDistance, world_pos, &new_geom);
+
+          if (hill_cache) {
+            HillCache_add(&*hill_cache, hill_pos, &new_geom);
+          }
+          geom = &new_geom;
         }
-        DEBUGF("DrawObjs read hill type %d at %" PRIMapCoord ",%" PRIMapCoord "\n",
-               hill_type, map_pos.x, map_pos.y);
+
+        ObjGfxMeshes_plot_hill_geom(&*geom, screen_pos, palette, NULL,
+          is_ghost ? ObjGfxMeshStyle_Wireframe : ObjGfxMeshStyle_Filled);
       }
 
       if (zoom > MaxDrawObjZoom) {
@@ -552,11 +568,11 @@ void DrawObjs_to_screen(
     {
       scr_grid_pos.x = scr_area->min.x;
       screen_pos.x = offset_orig.x + SIGNED_L_SHIFT(scr_grid_pos.x, grid_size_log2);
+      MapPoint map_pos = ObjLayout_derotate_scr_coords_to_map(view->config.angle, scr_grid_pos);
 
       for (; scr_grid_pos.x <= scr_area->max.x;
-           scr_grid_pos.x++, screen_pos.x += grid_size)
+           scr_grid_pos.x++, screen_pos.x += grid_size, map_pos = MapPoint_add(map_pos, row_step))
       {
-        MapPoint const map_pos = ObjLayout_derotate_scr_coords_to_map(view->config.angle, scr_grid_pos);
         ObjRef const obj_ref = read_obj(cb_arg, map_pos);
         bool const is_occluded = occluded && ObjEditSelection_is_selected(&*occluded, map_pos);
         bool const is_selected = selection && ObjEditSelection_is_selected(&*selection, map_pos);
@@ -808,6 +824,20 @@ static MapArea get_obj_draw_bbox(ObjGfxMeshes *const meshes, View const *const v
   }
 }
 
+bool DrawObjs_touch_bbox(View const *const view, MapPoint const grid_pos,
+  MapArea const *const object_bbox, MapArea const *const map_area)
+{
+  MapArea bbox = *object_bbox;
+  return split_obj_bbox(view, grid_pos, &bbox, filter_area_touches, map_area);
+}
+
+bool DrawObjs_in_bbox(View const *const view, MapPoint const grid_pos,
+  MapArea const *const object_bbox, MapArea const *const map_area)
+{
+  MapArea bbox = *object_bbox;
+  return split_obj_bbox(view, grid_pos, &bbox, filter_area_contains, map_area);
+}
+
 bool DrawObjs_touch_select_bbox(ObjGfxMeshes *const meshes, View const *const view, ObjRef const obj_ref,
   MapPoint const grid_pos, MapArea const *const map_area)
 {
@@ -32,6 +32,7 @@ struct ObjEditSelection;
 struct View;
 struct ObjGfxMeshes;
 struct CloudColData;
+struct HillCache;
 
 void DrawObjs_to_screen(
   _Optional PolyColData const *poly_colours,
@@ -42,6 +43,7 @@ void DrawObjs_to_screen(
   MapArea const *scr_area,
   DrawObjsReadObjFn *read_obj,
   DrawObjsReadHillFn *read_hill, void *cb_arg,
+  _Optional struct HillCache *hill_cache,
   _Optional struct TriggersData *triggers,
   _Optional struct ObjEditSelection const *selection,
   Vertex const scr_orig,
@@ -89,6 +91,12 @@ bool DrawObjs_in_select_bbox(
   ObjRef obj_ref, MapPoint grid_pos,
   MapArea const *map_area);
 
+bool DrawObjs_touch_bbox(struct View const *view, MapPoint grid_pos,
+  MapArea const *object_bbox, MapArea const *map_area);
+
+bool DrawObjs_in_bbox(struct View const *view, MapPoint grid_pos,
+  MapArea const *object_bbox, MapArea const *map_area);
+
 bool DrawObjs_touch_ghost_bbox(struct ObjGfxMeshes *meshes,
   struct View const *view, bool triggers,
   ObjRef obj_ref, MapPoint grid_pos, MapArea const *map_area);
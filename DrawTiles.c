@@ -45,11 +45,62 @@
 #include "Map.h"
 #include "SprMem.h"
 #include "MapLayout.h"
+#include "Instrument.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
 #endif
 
+enum {
+  SpanLength = 64, /* max. no. of cells read at once */
+};
+
+typedef struct {
+  DrawTilesReadSpanFn *read;
+  void *cb_arg;
+  MapAngle angle;
+  MapPoint step, start;
+  MapCoord count;
+  MapRef tile_refs[SpanLength];
+  bool is_selected[SpanLength];
+} SpanReader;
+
+static void span_reader_init(SpanReader *const reader, MapAngle const angle,
+  DrawTilesReadSpanFn *const read, void *const cb_arg)
+{
+  assert(reader);
+  assert(read);
+
+  *reader = (SpanReader){
+    .read = read,
+    .cb_arg = cb_arg,
+    .angle = angle,
+    .step = MapLayout_derotate_scr_row_step(angle),
+    .count = 0,
+  };
+}
+
+static size_t span_reader_get(SpanReader *const reader,
+  MapArea const *const scr_area, MapPoint const scr_pos)
+{
+  /* Returns the buffer index of the cell at the given screen position,
+     reading ahead to the end of the row (if necessary) */
+  assert(reader);
+  assert(scr_pos.x <= scr_area->max.x);
+
+  if (scr_pos.y != reader->start.y || scr_pos.x < reader->start.x ||
+      scr_pos.x >= reader->start.x + reader->count) {
+    reader->start = scr_pos;
+    reader->count = LOWEST(scr_area->max.x - scr_pos.x + 1, SpanLength);
+    reader->read(reader->cb_arg,
+                 MapLayout_derotate_scr_coords_to_map(reader->angle, scr_pos),
+                 reader->step, (size_t)reader->count,
+                 reader->tile_refs, reader->is_selected);
+    INSTRUMENT_COUNT(Callbacks, 1);
+  }
+  return (size_t)(scr_pos.x - reader->start.x);
+}
+
 #ifndef FASTPLOT
 
 enum {
@@ -59,7 +110,7 @@ enum {
 
 static bool draw_bitmap_big(MapTexBitmaps *const textures,
   MapAngle const angle, MapArea const *const scr_area,
-  DrawTilesReadFn *const read, void *const cb_arg, int const zoom,
+  DrawTilesReadSpanFn *const read, void *const cb_arg, int const zoom,
   SprMem const *const sprites,
   _Optional unsigned char const (*const sel_colours)[NumColours])
 {
@@ -92,6 +143,9 @@ static bool draw_bitmap_big(MapTexBitmaps *const textures,
     SIGNED_R_SHIFT(MapTexSize << DrawTilesModeXEig, zoom),
     SIGNED_R_SHIFT(MapTexSize << DrawTilesModeYEig, zoom)};
 
+  SpanReader reader;
+  span_reader_init(&reader, angle, read, cb_arg);
+
   hourglass_on();
   MapCoord const nrows = scr_area->max.y - scr_area->min.y + 1;
   size_t const count = MapTexBitmaps_get_count(textures);
@@ -105,21 +159,21 @@ static bool draw_bitmap_big(MapTexBitmaps *const textures,
     for (scr_pos.x = scr_area->min.x, draw_pos.x = 0;
          scr_pos.x <= scr_area->max.x;
          scr_pos.x++, draw_pos.x += tile_size.x) {
-      MapPoint const map_pos = MapLayout_derotate_scr_coords_to_map(angle, scr_pos);
-      DrawTilesReadResult value = read(cb_arg, map_pos);
-      MapRef tile_ref = value.tile_ref;
+      size_t const i = span_reader_get(&reader, scr_area, scr_pos);
+      MapRef tile_ref = reader.tile_refs[i];
 
       if (!map_ref_is_mask(tile_ref)) {
         if (map_ref_to_num(tile_ref) >= count) {
           tile_ref = map_ref_from_num(0); /* FIXME: substitute a placeholder sprite? */
         }
+        INSTRUMENT_COUNT(TilesPlotted, 1);
 
         char tile_name[12];
         sprintf(tile_name, "%d", map_ref_to_num(tile_ref));
 
         int action = SPRITE_ACTION_OVERWRITE;
         _Optional void const *colours = NULL;
-        if (sel_colours && value.is_selected) {
+        if (sel_colours && reader.is_selected[i]) {
           //action = SPRITE_ACTION_EOR;
           colours = sel_colours;
         }
@@ -139,7 +193,7 @@ static bool draw_bitmap_big(MapTexBitmaps *const textures,
 
 static bool draw_bitmap_small(MapTexBitmaps *const textures,
   MapAngle const angle, MapArea const *const scr_area,
-  DrawTilesReadFn *const read, void *const cb_arg,
+  DrawTilesReadSpanFn *const read, void *const cb_arg,
   _Optional unsigned char const (*const sel_colours)[NumColours])
 {
   assert(textures != NULL);
@@ -148,6 +202,9 @@ static bool draw_bitmap_small(MapTexBitmaps *const textures,
   bool needs_mask = false;
   Vertex draw_pos = {0,0};
 
+  SpanReader reader;
+  span_reader_init(&reader, angle, read, cb_arg);
+
   hourglass_on();
   MapCoord const nrows = scr_area->max.y - scr_area->min.y + 1;
   size_t const count = MapTexBitmaps_get_count(textures);
@@ -164,18 +221,18 @@ static bool draw_bitmap_small(MapTexBitmaps *const textures,
     for (scr_pos.x = scr_area->min.x, draw_pos.x = 0;
          scr_pos.x <= scr_area->max.x;
          scr_pos.x++, draw_pos.x += 1 << DrawTilesModeXEig) {
-      MapPoint const map_pos = MapLayout_derotate_scr_coords_to_map(angle, scr_pos);
-      DrawTilesReadResult value = read(cb_arg, map_pos);
-      MapRef tile_ref = value.tile_ref;
+      size_t const i = span_reader_get(&reader, scr_area, scr_pos);
+      MapRef tile_ref = reader.tile_refs[i];
 
       if (!map_ref_is_mask(tile_ref)) {
         if (map_ref_to_num(tile_ref) >= count) {
           tile_ref = map_ref_from_num(0); /* FIXME: substitute a placeholder sprite? */
         }
+        INSTRUMENT_COUNT(TilesPlotted, 1);
 
         /* Plot average colour of tile */
         int new_col = MapTexBitmaps_get_average_colour(textures, tile_ref);
-        if (sel_colours && value.is_selected) {
+        if (sel_colours && reader.is_selected[i]) {
           //new_col ^= UINT8_MAX; /* invert colour */
           assert(new_col >= 0);
           assert(new_col < NumColours);
@@ -212,13 +269,33 @@ static bool draw_bitmap_small(MapTexBitmaps *const textures,
 
 #endif
 
+void DrawTiles_read_cells(void *const cb_arg, MapPoint map_pos,
+  MapPoint const step, size_t const count, MapRef *const tile_refs,
+  bool *const is_selected)
+{
+  DrawTilesCellReader const *const reader = cb_arg;
+  assert(reader);
+  assert(reader->read);
+  assert(tile_refs);
+  assert(is_selected);
+
+  for (size_t i = 0; i < count; ++i) {
+    DrawTilesReadResult const value = reader->read(reader->cb_arg, map_pos);
+    tile_refs[i] = value.tile_ref;
+    is_selected[i] = value.is_selected;
+    map_pos = MapPoint_add(map_pos, step);
+  }
+}
+
 bool DrawTiles_to_sprite(MapTexBitmaps *const textures,
   SprMem *const sm, char const *const name, MapAngle const angle, MapArea const *const scr_area,
-  DrawTilesReadFn *const read, void *const cb_arg,
-  int const zoom, _Optional unsigned char const (*const sel_colours)[NumColours])
+  DrawTilesReadSpanFn *const read, void *const cb_arg,
+  int const zoom, _Optional unsigned char const (*const sel_colours)[NumColours],
+  bool *const needs_mask)
 {
   assert(textures != NULL);
   assert(read);
+  assert(needs_mask);
 
   DEBUGF("Plot bitmap for tiles x %" PRIMapCoord "..%" PRIMapCoord " y %" PRIMapCoord "..%" PRIMapCoord
          " at zoom level %d\n",
@@ -226,7 +303,7 @@ bool DrawTiles_to_sprite(MapTexBitmaps *const textures,
 
   /* Veneer onto FastPlot_plotarea, to take sprite area+name rather than
      raw bitmap pointer */
-  bool needs_mask = false;
+  *needs_mask = false;
 #ifdef FASTPLOT
   /* Use optimised direct plot routine */
   SpriteHeader *const sprite = SprMem_get_sprite_address(sm, name);
@@ -237,23 +314,23 @@ bool DrawTiles_to_sprite(MapTexBitmaps *const textures,
     case -2:
     case -1:
     case 0: /*  1:1 or 2:1 (16x16) */
-      needs_mask = FastPlot_plotarea(textures->sprites, sprite, angle, scr_area, columns,
+      *needs_mask = FastPlot_plotarea(textures->sprites, sprite, angle, scr_area, columns,
         base, overlay);
       break;
 
     case 1: /*  1:2 (8x8) */
-      needs_mask = FastPlot_plotareaB(textures->sprites, sprite, angle, scr_area, columns,
+      *needs_mask = FastPlot_plotareaB(textures->sprites, sprite, angle, scr_area, columns,
         base, overlay);
       break;
 
     case 2: /*  1:4 (4x4) */
-      needs_mask = FastPlot_plotareaC(textures->sprites, sprite, angle, scr_area, columns,
+      *needs_mask = FastPlot_plotareaC(textures->sprites, sprite, angle, scr_area, columns,
         base, overlay);
       break;
 
     case 3: /*  1:16 (1x1) */
     case 4:
-      needs_mask = FastPlot_plotareaD(textures->count,
+      *needs_mask = FastPlot_plotareaD(textures->count,
         textures->avcols_table, sprite, angle, scr_area, columns,
         base, overlay);
       break;
@@ -275,14 +352,14 @@ bool DrawTiles_to_sprite(MapTexBitmaps *const textures,
     return false;
 
   if (zoom < DrawSmallMinZoom) {
-    needs_mask = draw_bitmap_big(textures, angle, scr_area, read, cb_arg, zoom, &*sprites, sel_colours);
+    *needs_mask = draw_bitmap_big(textures, angle, scr_area, read, cb_arg, zoom, &*sprites, sel_colours);
   } else {
-    needs_mask = draw_bitmap_small(textures, angle, scr_area, read, cb_arg, sel_colours);
+    *needs_mask = draw_bitmap_small(textures, angle, scr_area, read, cb_arg, sel_colours);
   }
 
   SprMem_restore_output(sm);
 #endif
-  return needs_mask;
+  return true;
 }
 
 static void draw_mask_bbox(void *cb_arg, BBox const *bbox, MapRef const value)
@@ -294,8 +371,8 @@ static void draw_mask_bbox(void *cb_arg, BBox const *bbox, MapRef const value)
 }
 
 void DrawTiles_to_mask(SprMem *const sm, char const *const name,
-  MapAngle const angle, MapArea const *const scr_area, DrawTilesReadFn *const read, void *const cb_arg,
-  int const zoom)
+  MapAngle const angle, MapArea const *const scr_area, DrawTilesReadSpanFn *const read,
+  void *const cb_arg, int const zoom)
 {
   /* Veneer onto FastPlot_plotmask, to take sprite area+name rather than raw bitmap pointer */
   DEBUGF("Plot mask for tiles x %" PRIMapCoord "..%" PRIMapCoord " y %" PRIMapCoord "..%" PRIMapCoord "\n",
@@ -353,7 +430,7 @@ typedef enum {
 } RectState;
 
 void DrawTiles_to_bbox(
-  MapAngle const angle, MapArea const *const scr_area, DrawTilesReadFn *const read, void *const read_arg,
+  MapAngle const angle, MapArea const *const scr_area, DrawTilesReadSpanFn *const read, void *const read_arg,
   DrawTilesBBoxFn *const give_bbox, void *const give_bbox_arg, Vertex const tile_size)
 {
   assert(read);
@@ -368,6 +445,9 @@ void DrawTiles_to_bbox(
   RectState state = RectState_None;
   BBox bbox = {0, 0, 0, 0};
 
+  SpanReader reader;
+  span_reader_init(&reader, angle, read, read_arg);
+
   hourglass_on();
   MapCoord const nrows = scr_area->max.y - scr_area->min.y + 1;
 
@@ -381,9 +461,8 @@ void DrawTiles_to_bbox(
          scr_pos.x <= scr_area->max.x;
          ++scr_pos.x, draw_pos.x += tile_size.x) {
 
-      MapPoint const map_pos = MapLayout_derotate_scr_coords_to_map(angle, scr_pos);
-      DrawTilesReadResult const value = read(read_arg, map_pos);
-      if (state != RectState_None && map_ref_is_equal(value.tile_ref, span_value)) {
+      MapRef const value = reader.tile_refs[span_reader_get(&reader, scr_area, scr_pos)];
+      if (state != RectState_None && map_ref_is_equal(value, span_value)) {
         continue;
       }
 
@@ -409,9 +488,9 @@ void DrawTiles_to_bbox(
         give_bbox(give_bbox_arg, &bbox, span_value);
       }
 
-      span_value = value.tile_ref;
+      span_value = value;
       DEBUG("Span of %d starts at %" PRIMapCoord ",%" PRIMapCoord "",
-            map_ref_to_num(value.tile_ref), scr_pos.x, scr_pos.y);
+            map_ref_to_num(value), scr_pos.x, scr_pos.y);
 
       BBox_set_min(&bbox, draw_pos);
 
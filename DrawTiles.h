@@ -8,6 +8,7 @@
 #define DrawTiles_h
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "Vertex.h"
 #include "MapCoord.h"
 #include "SFInit.h"
@@ -33,24 +34,41 @@ typedef struct {
 
 typedef DrawTilesReadResult DrawTilesReadFn(void *cb_arg, MapPoint map_pos);
 
+/* Reads a span of count cells starting at map_pos, moving by step (a unit
+   vector along either axis, depending on the map angle) between cells. */
+typedef void DrawTilesReadSpanFn(void *cb_arg, MapPoint map_pos,
+  MapPoint step, size_t count, MapRef *tile_refs, bool *is_selected);
+
+typedef struct {
+  DrawTilesReadFn *read;
+  void *cb_arg;
+} DrawTilesCellReader;
+
+/* Span reader for callers that can only read one cell at a time.
+   The callback argument must point to a DrawTilesCellReader. */
+DrawTilesReadSpanFn DrawTiles_read_cells;
+
 struct MapTexBitmaps;
 struct SprMem;
 struct MapEditSelection;
 
+/* Returns false on failure. Otherwise, *needs_mask is set to whether any
+   of the tiles drawn were masked. */
 bool DrawTiles_to_sprite(struct MapTexBitmaps *tilesdata,
                          struct SprMem *sm, char const *name, MapAngle angle,
                          MapArea const *scr_area,
-                         DrawTilesReadFn *read, void *cb_arg, int zoom,
-                         _Optional unsigned char const (*sel_colours)[NumColours]);
+                         DrawTilesReadSpanFn *read, void *cb_arg, int zoom,
+                         _Optional unsigned char const (*sel_colours)[NumColours],
+                         bool *needs_mask);
 
 typedef void DrawTilesBBoxFn(void *cb_arg, BBox const *bbox, MapRef value);
 
 void DrawTiles_to_mask(struct SprMem *sm, char const *name,
-  MapAngle angle, MapArea const *scr_area, DrawTilesReadFn *read, void *cb_arg,
-  int zoom);
+  MapAngle angle, MapArea const *scr_area, DrawTilesReadSpanFn *read,
+  void *cb_arg, int zoom);
 
 void DrawTiles_to_bbox(
-  MapAngle angle, MapArea const *scr_area, DrawTilesReadFn *read, void *read_arg,
+  MapAngle angle, MapArea const *scr_area, DrawTilesReadSpanFn *read, void *read_arg,
   DrawTilesBBoxFn *give_bbox, void *give_bbox_arg, Vertex tile_size);
 
 #endif
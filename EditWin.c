@@ -69,6 +69,7 @@
 #include "Session.h"
 #include "Debug.h"
 #include "Plot.h"
+#include "PlotList.h"
 #include "SFInit.h"
 #include "EditWin.h"
 #include "OurEvents.h"
@@ -94,6 +95,8 @@
 #include "Config.h"
 #include "ObjGfxData.h"
 #include "DrawObjs.h"
+#include "ObjIndex.h"
+#include "HillCache.h"
 #include "DrawTiles.h"
 #include "DrawInfos.h"
 #include "ObjEditCtx.h"
@@ -105,6 +108,8 @@
 #include "ObjLayout.h"
 #include "MapAreaCol.h"
 #include "Goto.h"
+#include "Navigator.h"
+#include "Instrument.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -304,6 +309,8 @@ static void set_extent(EditWin *const edit_win, _Optional MapPoint const *const
                  Toolbox_ShowObject_FullSpec, &window_state.visible_area,
                  NULL_ObjectId, NULL_ComponentId));
 
+  Navigator_viewport_changed(&edit_win->navigator);
+
   /* We only get open window request events in response to the user dragging or
      resizing the window so ensure that the status bar is reformatted. */
   Editor *const editor = edit_win->editor;
@@ -405,6 +412,77 @@ static Vertex map_to_scr_coords(EditWin const *const edit_win, Vertex const orig
   return screen_pos;
 }
 
+static bool grid_plot_conditions_match(EditWin const *const edit_win)
+{
+  ViewConfig const *const config = &edit_win->view.config;
+  ViewConfig const *const recorded = &edit_win->grid_plot_config;
+
+  return recorded->zoom_factor == config->zoom_factor &&
+         recorded->angle == config->angle &&
+         recorded->grid_colour == config->grid_colour &&
+         edit_win->grid_plot_mode == Editor_get_edit_mode(edit_win->editor);
+}
+
+static bool grid_plot_is_valid(EditWin const *const edit_win,
+  MapArea const *const area)
+{
+  assert(edit_win);
+  assert(area);
+
+  return PlotList_is_valid(&edit_win->grid_plot) &&
+         grid_plot_conditions_match(edit_win) &&
+         MapArea_contains_area(&edit_win->grid_plot_area, area);
+}
+
+static void draw_grid(EditWin *const edit_win,
+  WimpRedrawWindowBlock const *const block, Vertex const window_origin,
+  MapArea const *const area)
+{
+  assert(edit_win);
+  assert(block);
+  assert(area);
+
+  Editor *const editor = edit_win->editor;
+
+  /* Recording fails if the grid needs too many commands. Retrying it for
+     every redraw rectangle would be slower than not recording at all. */
+  bool const known_to_fail = edit_win->grid_plot_failed &&
+                             grid_plot_conditions_match(edit_win);
+
+  if (!known_to_fail && !grid_plot_is_valid(edit_win, area)) {
+    /* Record the grid for the visible area plus a margin so that
+       subsequent redraws (e.g. when scrolling) can replay it. */
+    Vertex const half_vis_size = Vertex_div_log2(
+      (Vertex){block->visible_area.xmax - block->visible_area.xmin,
+               block->visible_area.ymax - block->visible_area.ymin}, 1);
+
+    Vertex const record_min = Vertex_sub(
+      (Vertex){block->visible_area.xmin, block->visible_area.ymin}, half_vis_size);
+
+    Vertex const record_max = Vertex_add(
+      (Vertex){block->visible_area.xmax - 1, block->visible_area.ymax - 1}, half_vis_size);
+
+    edit_win->grid_plot_area = (MapArea){
+      .min = scr_to_map_coords(edit_win, window_origin, record_min),
+      .max = scr_to_map_coords(edit_win, window_origin, record_max)
+    };
+    MapArea_expand_for_area(&edit_win->grid_plot_area, area);
+    edit_win->grid_plot_config = edit_win->view.config;
+    edit_win->grid_plot_mode = Editor_get_edit_mode(editor);
+
+    PlotList_start(&edit_win->grid_plot, window_origin);
+    Editor_draw_grid(editor, window_origin, &edit_win->grid_plot_area, edit_win);
+    edit_win->grid_plot_failed = !PlotList_stop(&edit_win->grid_plot);
+  }
+
+  if (PlotList_is_valid(&edit_win->grid_plot)) {
+    PlotList_replay(&edit_win->grid_plot, window_origin, &block->redraw_area);
+  } else {
+    /* Fall back to drawing directly if the list could not be recorded */
+    Editor_draw_grid(editor, window_origin, area, edit_win);
+  }
+}
+
 static void redraw_loop(EditWin *const edit_win, WimpRedrawWindowBlock *const block)
 {
   /* Separate from redraw handler so that it can also be called after
@@ -419,6 +497,8 @@ static void redraw_loop(EditWin *const edit_win, WimpRedrawWindowBlock *const bl
      render buffer */
   int const compact_state = flex_set_deferred_compaction(1);
 
+  INSTRUMENT_START(Redraw);
+
   int more;
   do {
     /* Convert OS screen coordinates of redraw rectangle to map coordinates
@@ -435,7 +515,9 @@ static void redraw_loop(EditWin *const edit_win, WimpRedrawWindowBlock *const bl
         (edit_win->view.config.flags.MAP_OVERLAY && Session_has_data(session, DataType_OverlayMap)) ||
         Editor_get_edit_mode(editor) == EDITING_MODE_MAP) {
       /* Draw tiled ground map (or chequerboard if graphics turned off) */
+      INSTRUMENT_START(MapDraw);
       MapMode_draw(editor, window_origin, &area, edit_win);
+      INSTRUMENT_STOP(MapDraw);
     } else {
       /* Draw plain background colour */
       plot_set_col(edit_win->view.config.back_colour);
@@ -443,7 +525,7 @@ static void redraw_loop(EditWin *const edit_win, WimpRedrawWindowBlock *const bl
     }
 
     if (edit_win->view.config.flags.GRID && Editor_can_draw_grid(editor, edit_win)) {
-      Editor_draw_grid(editor, window_origin, &area, edit_win);
+      draw_grid(edit_win, block, window_origin, &area);
     }
 
     if (Editor_get_edit_mode(editor) == EDITING_MODE_MAP &&
@@ -452,10 +534,13 @@ static void redraw_loop(EditWin *const edit_win, WimpRedrawWindowBlock *const bl
       Editor_draw_numbers(editor, window_origin, &area, edit_win);
     }
 
-    if ((edit_win->view.config.flags.OBJECTS && Session_has_data(session, DataType_BaseObjects)) ||
-        (edit_win->view.config.flags.OBJECTS_OVERLAY && Session_has_data(session, DataType_OverlayObjects))) {
+    if (((edit_win->view.config.flags.OBJECTS && Session_has_data(session, DataType_BaseObjects)) ||
+         (edit_win->view.config.flags.OBJECTS_OVERLAY && Session_has_data(session, DataType_OverlayObjects))) &&
+        Session_objects_ready(session)) {
       /* Draw polygonal ground objects */
+      INSTRUMENT_START(ObjectsDraw);
       ObjectsMode_draw(editor, window_origin, &area, edit_win);
+      INSTRUMENT_STOP(ObjectsDraw);
     }
 
     if (Editor_get_edit_mode(editor) == EDITING_MODE_OBJECTS &&
@@ -468,12 +553,16 @@ static void redraw_loop(EditWin *const edit_win, WimpRedrawWindowBlock *const bl
     if (Session_has_data(session, DataType_Mission)) {
       if (edit_win->view.config.flags.SHIPS) {
         /* Draw ships and flightpaths */
+        INSTRUMENT_START(ShipsDraw);
         ShipsMode_draw(editor, window_origin, &area, edit_win);
+        INSTRUMENT_STOP(ShipsDraw);
       }
 
       if (edit_win->view.config.flags.INFO) {
         /* Draw strategic target information */
+        INSTRUMENT_START(InfoDraw);
         InfoMode_draw(editor, window_origin, &area, edit_win);
+        INSTRUMENT_STOP(InfoDraw);
       }
     }
 
@@ -486,6 +575,9 @@ static void redraw_loop(EditWin *const edit_win, WimpRedrawWindowBlock *const bl
     }
   } while (more);
 
+  INSTRUMENT_STOP(Redraw);
+  INSTRUMENT_END_FRAME();
+
   /* Restore immediate heap compaction  */
   flex_set_deferred_compaction(compact_state);
   while (flex_compact() != 0) {};
@@ -552,6 +644,8 @@ static void redraw_area(EditWin *const edit_win, MapArea const *const area,
 
 static void redraw_all(EditWin *const edit_win)
 {
+  PlotList_invalidate(&edit_win->grid_plot);
+  edit_win->grid_plot_failed = false;
   static MapArea const area = {{0, 0}, {MAP_COORDS_LIMIT, MAP_COORDS_LIMIT}};
   redraw_area(edit_win, &area, false);
 }
@@ -631,6 +725,8 @@ static bool auto_scroll(EditWin *const edit_win, WimpGetWindowStateBlock *const
       E(toolbox_show_object(0, edit_win->window_id,
           Toolbox_ShowObject_FullSpec, &window_state->visible_area, NULL_ObjectId,
           NULL_ComponentId));
+
+      Navigator_viewport_changed(&edit_win->navigator);
     } else
       DEBUG("Can't scroll until next time");
 
@@ -842,6 +938,8 @@ static void change_angle(EditWin *const edit_win, MapAngle const angle)
                         Toolbox_ShowObject_FullSpec, &window_state.visible_area,
                         NULL_ObjectId, NULL_ComponentId));
 
+  Navigator_viewport_changed(&edit_win->navigator);
+
   BBox extent = {
     .xmin = 0,
     .ymin = edit_win->extent.y,
@@ -1159,6 +1257,8 @@ static int scroll_request(int const event_code, WimpPollBlock *const event,
     Toolbox_ShowObject_FullSpec, &wsre->open.visible_area, id_block->parent_id,
     id_block->parent_component));
 
+  Navigator_viewport_changed(&edit_win->navigator);
+
   return 1; /* claim event */
 }
 
@@ -1470,6 +1570,15 @@ static int useracthandler(int const event_code, ToolboxEvent *const event,
       Goto_show(edit_win);
       return 1; /* claim event */
 
+    case EVENT_NAVIGATOR:
+      if (!Session_has_data(session, DataType_BaseMap) &&
+          !Session_has_data(session, DataType_OverlayMap)) {
+        putchar('\a'); /* no map loaded */
+        return 1; /* claim event */
+      }
+      Navigator_show(&edit_win->navigator);
+      return 1; /* claim event */
+
     case EVENT_ZOOM_IN:
       if (edit_win->wimp_drag_box || edit_win->dragging_obj || edit_win->pointer_trapped) {
         return 1;
@@ -1751,6 +1860,8 @@ static int open_window(int const event_code, WimpPollBlock *const event,
   StatusBar_reformat(&edit_win->statusbar_data, width,
     Editor_get_coord_field_width(editor));
 
+  Navigator_viewport_changed(&edit_win->navigator);
+
   return 1; /* claim event */
 }
 
@@ -2518,6 +2629,10 @@ static void redraw_hill(EditWin *const edit_win, MapPoint const pos,
   HillType const new_type, unsigned char (*const new_heights)[HillCorner_Count])
 {
   DEBUGF("redraw_hill %" PRIMapCoord ",%" PRIMapCoord "\n", pos.x, pos.y);
+  if (edit_win->hill_cache) {
+    HillCache_invalidate_hill(&*edit_win->hill_cache, pos);
+  }
+
   MapPoint const centre = ObjLayout_map_coords_to_centre(&edit_win->view,
                              MapPoint_mul_log2(pos, Hill_ObjPerHillLog2));
 
@@ -2569,6 +2684,12 @@ static void update_read_obj_ctx(EditWin *const edit_win)
     .base = !display_flags.OBJECTS ? NULL : objects->base,
     .overlay = !display_flags.OBJECTS_OVERLAY ? NULL : objects->overlay,
     .triggers = objects->triggers};
+
+  /* The flattened grid can only be used if no layer is hidden */
+  if (edit_win->read_obj_ctx.base == objects->base &&
+      edit_win->read_obj_ctx.overlay == objects->overlay) {
+    edit_win->read_obj_ctx.flat = objects->flat;
+  }
 }
 
 static void update_read_map_ctx(EditWin *const edit_win)
@@ -2580,6 +2701,12 @@ static void update_read_map_ctx(EditWin *const edit_win)
     .base = !display_flags.MAP ? NULL : map->base,
     .overlay = !display_flags.MAP_OVERLAY ? NULL : map->overlay,
     .anims = map->anims};
+
+  /* The flattened map can only be used if no layer is hidden */
+  if (edit_win->read_map_ctx.base == map->base &&
+      edit_win->read_map_ctx.overlay == map->overlay) {
+    edit_win->read_map_ctx.flat = map->flat;
+  }
 }
 
 static void update_read_info_ctx(EditWin *const edit_win)
@@ -2618,9 +2745,11 @@ bool EditWin_init(EditWin *const edit_win, Editor *const editor,
     .wimp_drag_box = false,
     .obj_drag_box = false,
     .pending_hills_update = MapArea_make_invalid(),
+    .grid_plot_failed = false,
   };
   MapAreaCol_init(&edit_win->pending_redraws, MAP_COORDS_LIMIT_LOG2);
   MapAreaCol_init(&edit_win->ghost_bboxes, MAP_COORDS_LIMIT_LOG2);
+  PlotList_init(&edit_win->grid_plot);
 
   edit_win->view.map_size_in_os_units = calc_map_size(edit_win->view.config.zoom_factor);
   edit_win->view.map_units_per_os_unit_log2 = map_units_per_os_unit_log2(edit_win->view.config.zoom_factor);
@@ -2639,8 +2768,15 @@ bool EditWin_init(EditWin *const edit_win, Editor *const editor,
     }
     edit_win->has_hills = true;
     hills_make(&edit_win->hills);
+
+    /* Owned by this view. Either may be null if memory is short.
+       Cleared when the objects layers, hill colours or graphics change. */
+    edit_win->hill_cache = HillCache_create();
+    edit_win->obj_index = ObjIndex_create();
   }
 
+  Navigator_init(&edit_win->navigator, edit_win);
+
   /* Create new map edit_win window and associate with our data block */
   if (!E(toolbox_create_object(0, "EditWin", &edit_win->window_id))) {
     DEBUG("Main window for new edit_win is 0x%x", edit_win->window_id);
@@ -2709,6 +2845,9 @@ bool EditWin_init(EditWin *const edit_win, Editor *const editor,
   if (edit_win->has_hills) {
     hills_destroy(&edit_win->hills);
   }
+  ObjIndex_destroy(edit_win->obj_index);
+  HillCache_destroy(edit_win->hill_cache);
+  PlotList_destroy(&edit_win->grid_plot);
   return false;
 }
 
@@ -2739,6 +2878,8 @@ void EditWin_destroy(EditWin *const edit_win)
 
   free_pointer(edit_win);
 
+  Navigator_destroy(&edit_win->navigator);
+
   // Prevent the toolbar being deleted with the window
   E(window_set_tool_bars(Window_ExternalTopLeftToolbar,
      edit_win->window_id, NULL_ObjectId, NULL_ObjectId, NULL_ObjectId, NULL_ObjectId));
@@ -2752,6 +2893,9 @@ void EditWin_destroy(EditWin *const edit_win)
   if (edit_win->has_hills) {
     hills_destroy(&edit_win->hills);
   }
+  ObjIndex_destroy(edit_win->obj_index);
+  HillCache_destroy(edit_win->hill_cache);
+  PlotList_destroy(&edit_win->grid_plot);
 }
 
 void EditWin_show(EditWin const *const edit_win)
@@ -3018,6 +3162,18 @@ void EditWin_set_ghost_colour(EditWin *const edit_win, PaletteEntry const colour
   }
 }
 
+_Optional struct ObjIndex *EditWin_get_obj_index(EditWin const *const edit_win)
+{
+  assert(edit_win);
+  return edit_win->obj_index;
+}
+
+_Optional struct HillCache *EditWin_get_hill_cache(EditWin const *const edit_win)
+{
+  assert(edit_win);
+  return edit_win->hill_cache;
+}
+
 _Optional HillsData const *EditWin_get_hills(EditWin const *const edit_win)
 {
   assert(edit_win != NULL);
@@ -3074,12 +3230,24 @@ void EditWin_redraw_map(EditWin *const edit_win, MapArea const *const area)
 
   MapArea const map_area = MapLayout_map_area_to_fine(&edit_win->view, area);
   MapAreaCol_add(&edit_win->pending_redraws, &map_area);
+
+  Navigator_redraw_map(&edit_win->navigator, area);
 }
 
 void EditWin_redraw_object(EditWin *const edit_win, MapPoint const pos,
   ObjRef const base_ref, ObjRef const old_ref, ObjRef const new_ref, bool const has_triggers)
 {
   EditSession *const session = EditWin_get_session(edit_win);
+  if (!Session_objects_ready(session)) {
+    return; /* everything will be redrawn when the graphics arrive */
+  }
+
+  if (edit_win->obj_index) {
+    ObjGfx *const graphics = Session_get_graphics(session);
+    ObjIndex_update(&*edit_win->obj_index, &graphics->meshes, &edit_win->view,
+                    &edit_win->read_obj_ctx, pos);
+  }
+
   if (Session_has_data(session, DataType_OverlayObjects)) {
     if (!edit_win->view.config.flags.OBJECTS_OVERLAY && !edit_win->view.config.flags.OBJECTS) {
       return;
@@ -3210,6 +3378,78 @@ void EditWin_set_ghost_map_bbox(EditWin *const edit_win, MapArea const *const ar
   MapAreaCol_add(&edit_win->pending_redraws, &map_bbox);
 }
 
+static void redraw_area_outside(EditWin *const edit_win, MapArea const *const area,
+  MapArea const *const exclude)
+{
+  /* Redraw the parts of an area outside another, as up to four strips */
+  if (!MapArea_overlaps(area, exclude)) {
+    MapAreaCol_add(&edit_win->pending_redraws, area);
+    return;
+  }
+
+  MapArea rest = *area;
+  if (rest.min.y < exclude->min.y) {
+    MapAreaCol_add(&edit_win->pending_redraws,
+      &(MapArea){rest.min, {rest.max.x, exclude->min.y - 1}});
+    rest.min.y = exclude->min.y;
+  }
+  if (rest.max.y > exclude->max.y) {
+    MapAreaCol_add(&edit_win->pending_redraws,
+      &(MapArea){{rest.min.x, exclude->max.y + 1}, rest.max});
+    rest.max.y = exclude->max.y;
+  }
+  if (rest.min.x < exclude->min.x) {
+    MapAreaCol_add(&edit_win->pending_redraws,
+      &(MapArea){rest.min, {exclude->min.x - 1, rest.max.y}});
+  }
+  if (rest.max.x > exclude->max.x) {
+    MapAreaCol_add(&edit_win->pending_redraws,
+      &(MapArea){{exclude->max.x + 1, rest.min.y}, rest.max});
+  }
+}
+
+static void move_ghost_bbox(EditWin *const edit_win, MapArea const *const fine_bbox)
+{
+  MapAreaColIter iter;
+  _Optional MapArea const *const old_bbox = MapAreaColIter_get_first(&iter, &edit_win->ghost_bboxes);
+  if (!old_bbox || MapAreaColIter_get_next(&iter)) {
+    /* Not a single area, so undraw the whole of the old ghost */
+    EditWin_redraw_ghost(edit_win);
+    MapAreaCol_add(&edit_win->pending_redraws, fine_bbox);
+  } else {
+    MapArea const old_fine_bbox = *old_bbox;
+    redraw_area_outside(edit_win, &old_fine_bbox, fine_bbox);
+    redraw_area_outside(edit_win, fine_bbox, &old_fine_bbox);
+  }
+
+  MapAreaCol_init(&edit_win->ghost_bboxes, MAP_COORDS_LIMIT_LOG2);
+  MapAreaCol_add(&edit_win->ghost_bboxes, fine_bbox);
+}
+
+void EditWin_move_ghost_map_bbox(EditWin *const edit_win, MapArea const *const area)
+{
+  assert(edit_win != NULL);
+  assert(MapArea_is_valid(area));
+
+  DEBUGF("Move ghost bbox to %" PRIMapCoord ",%" PRIMapCoord ",%" PRIMapCoord ",%" PRIMapCoord "\n",
+         area->min.x, area->min.y, area->max.x, area->max.y);
+
+  MapArea const map_bbox = MapLayout_map_area_to_fine(&edit_win->view, area);
+  move_ghost_bbox(edit_win, &map_bbox);
+}
+
+void EditWin_move_ghost_unknown_obj(EditWin *const edit_win, MapArea const *const bbox)
+{
+  assert(edit_win != NULL);
+  assert(MapArea_is_valid(bbox));
+
+  DEBUGF("Move unknown objects ghost to %" PRIMapCoord ",%" PRIMapCoord ",%" PRIMapCoord ",%" PRIMapCoord "\n",
+         bbox->min.x, bbox->min.y, bbox->max.x, bbox->max.y);
+
+  MapArea const unknown_bbox = ObjLayout_map_area_to_fine(&edit_win->view, bbox);
+  move_ghost_bbox(edit_win, &unknown_bbox);
+}
+
 MapArea EditWin_get_ghost_obj_bbox(EditWin *const edit_win, MapPoint const pos, ObjRef const obj_ref)
 {
   ObjGfx *const graphics = Session_get_graphics(EditWin_get_session(edit_win));
@@ -3409,6 +3649,12 @@ void EditWin_set_display_flags(EditWin *const edit_win, ViewDisplayFlags const f
         old_flags.OBJECTS_OVERLAY != flags.OBJECTS_OVERLAY) {
       update_read_obj_ctx(edit_win);
       hills_make(&edit_win->hills);
+      if (edit_win->hill_cache) {
+        HillCache_invalidate(&*edit_win->hill_cache);
+      }
+      if (edit_win->obj_index) {
+        ObjIndex_invalidate(&*edit_win->obj_index);
+      }
     }
 
     if (old_flags.INFO != flags.INFO) {
@@ -3542,6 +3788,22 @@ void EditWin_resource_change(EditWin *const edit_win, EditorChange const event,
   case EDITOR_CHANGE_OBJ_ALL_REPLACED:
     update_read_obj_ctx(edit_win);
     hills_make(&edit_win->hills);
+    if (edit_win->hill_cache) {
+      HillCache_invalidate(&*edit_win->hill_cache);
+    }
+    if (edit_win->obj_index) {
+      ObjIndex_invalidate(&*edit_win->obj_index);
+    }
+    break;
+  case EDITOR_CHANGE_GFX_ALL_RELOADED:
+    if (edit_win->obj_index) {
+      ObjIndex_invalidate(&*edit_win->obj_index);
+    }
+    break;
+  case EDITOR_CHANGE_HILL_COLOURS:
+    if (edit_win->hill_cache) {
+      HillCache_invalidate(&*edit_win->hill_cache);
+    }
     break;
   case EDITOR_CHANGE_MAP_ALL_REPLACED:
     update_read_map_ctx(edit_win);
@@ -3566,6 +3828,8 @@ void EditWin_set_scroll_pos(EditWin const *const edit_win, MapPoint const pos)
     E(toolbox_show_object(0, edit_win->window_id,
                           Toolbox_ShowObject_FullSpec, &window_state.visible_area,
                           NULL_ObjectId, NULL_ComponentId));
+
+    Navigator_viewport_changed(&edit_win->navigator);
   }
 }
 
@@ -3580,3 +3844,27 @@ MapPoint EditWin_get_scroll_pos(EditWin const *const edit_win)
   }
   return (MapPoint){0,0};
 }
+
+bool EditWin_get_visible_area(EditWin const *const edit_win, MapArea *const area)
+{
+  assert(edit_win);
+  assert(area);
+  WimpGetWindowStateBlock window_state = {
+    .window_handle = edit_win->wimp_id,
+  };
+  if (E(wimp_get_window_state(&window_state))) {
+    return false;
+  }
+
+  /* Wimp visible area maximum coordinates are exclusive */
+  Vertex const visible_size = calc_visible_size(edit_win, &window_state);
+  Vertex const visible_max = Vertex_sub(BBox_get_max(&window_state.visible_area), (Vertex){1, 1});
+  Vertex const visible_min = Vertex_sub(visible_max, Vertex_sub(visible_size, (Vertex){1, 1}));
+  Vertex const window_origin = calc_window_origin(edit_win, &window_state);
+
+  *area = (MapArea){
+    .min = scr_to_map_coords(edit_win, window_origin, visible_min),
+    .max = scr_to_map_coords(edit_win, window_origin, visible_max)
+  };
+  return true;
+}
@@ -154,6 +154,11 @@ int EditWin_get_wimp_handle(EditWin const *edit_win);
 
 _Optional struct HillsData const *EditWin_get_hills(EditWin const *edit_win);
 
+struct ObjIndex;
+_Optional struct ObjIndex *EditWin_get_obj_index(EditWin const *edit_win);
+
+_Optional struct HillCache *EditWin_get_hill_cache(EditWin const *edit_win);
+
 void EditWin_redraw_map(EditWin *edit_win, MapArea const *area);
 
 void EditWin_redraw_object(EditWin *edit_win, MapPoint pos, ObjRef base_ref, ObjRef old_ref, ObjRef new_ref, bool has_triggers);
@@ -168,8 +173,16 @@ void EditWin_trig_changed(EditWin *edit_win, MapPoint pos, ObjRef obj_ref, Trigg
 void EditWin_redraw_ghost(EditWin *edit_win);
 void EditWin_clear_ghost_bbox(EditWin *edit_win);
 void EditWin_set_ghost_map_bbox(EditWin *edit_win, MapArea const *area);
+
+/* Like EditWin_set_ghost_map_bbox but only redraws locations that entered or
+   left the ghost. Only for ghosts that look the same at every location they
+   cover. */
+void EditWin_move_ghost_map_bbox(EditWin *edit_win, MapArea const *area);
 void EditWin_add_ghost_obj(EditWin *edit_win, MapPoint pos, ObjRef obj_ref);
 void EditWin_add_ghost_unknown_obj(EditWin *edit_win, MapArea const *bbox);
+
+/* Like EditWin_move_ghost_map_bbox but for a ghost of unknown objects. */
+void EditWin_move_ghost_unknown_obj(EditWin *edit_win, MapArea const *bbox);
 void EditWin_add_ghost_unknown_info(EditWin *edit_win, MapArea const *bbox);
 MapArea EditWin_get_ghost_obj_bbox(EditWin *edit_win, MapPoint const pos, ObjRef obj_ref);
 MapArea EditWin_get_ghost_info_bbox(EditWin *edit_win, MapPoint pos);
@@ -198,4 +211,7 @@ void EditWin_resource_change(EditWin *edit_win, EditorChange event,
 void EditWin_set_scroll_pos(EditWin const *edit_win, MapPoint pos);
 MapPoint EditWin_get_scroll_pos(EditWin const *edit_win);
 
+/* Gets the area visible in the window, in fine screen coordinates. */
+bool EditWin_get_visible_area(EditWin const *edit_win, MapArea *area);
+
 #endif
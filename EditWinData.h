@@ -17,6 +17,7 @@
 #include "Vertex.h"
 #include "MapCoord.h"
 #include "StatusBar.h"
+#include "Navigator.h"
 #include "EditWin.h"
 #include "SFInit.h"
 #include "Hill.h"
@@ -25,6 +26,8 @@
 #include "View.h"
 #include "MapTexBitm.h"
 #include "MapAreaColData.h"
+#include "PlotListData.h"
+#include "Editor.h"
 
 struct EditWin
 {
@@ -33,6 +36,7 @@ struct EditWin
   SchedulerTime last_scroll; /* time of last auto-scroll update */
 
   StatusBarData statusbar_data;
+  NavigatorData navigator;
 
   MapPoint start_drag_pos, old_grid_pos;
   MapArea sent_drag_bbox, shown_drag_bbox, drop_bbox, ghost_bbox;
@@ -51,9 +55,18 @@ struct EditWin
   void (*can_paste_fn)(void *arg, bool cb_valid), *can_paste_arg;
 
   HillsData hills;
+  _Optional struct ObjIndex *obj_index;
+  _Optional struct HillCache *hill_cache;
   struct MapAreaColData pending_redraws, ghost_bboxes;
   MapArea pending_hills_update;
 
+  /* Recorded grid lines and the conditions under which they were recorded */
+  PlotListData grid_plot;
+  MapArea grid_plot_area;
+  ViewConfig grid_plot_config;
+  EditMode grid_plot_mode;
+  bool grid_plot_failed; /* don't retry until the view or mode changes */
+
   struct ObjEditContext read_obj_ctx;
   struct MapEditContext read_map_ctx;
   struct InfoEditContext const *read_info_ctx;
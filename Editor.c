@@ -2394,6 +2394,19 @@ void Editor_set_ghost_map_bbox(Editor *const editor, MapArea const *area)
 #endif
 }
 
+void Editor_move_ghost_map_bbox(Editor *const editor, MapArea const *area)
+{
+  assert(editor != NULL);
+#if PER_VIEW_SELECT
+  _Optional EditWin *const edit_win = Session_editor_to_win(editor);
+  if (edit_win) {
+    EditWin_move_ghost_map_bbox(&*edit_win, area);
+  }
+#else
+  Session_move_ghost_map_bbox(editor->session, area);
+#endif
+}
+
 void Editor_add_ghost_obj(Editor *const editor, MapPoint const pos, ObjRef const obj_ref)
 {
   assert(editor != NULL);
@@ -2420,6 +2433,19 @@ void Editor_add_ghost_info(Editor *const editor, MapPoint const pos)
 #endif
 }
 
+void Editor_move_ghost_unknown_obj(Editor *const editor, MapArea const *const bbox)
+{
+  assert(editor != NULL);
+#if PER_VIEW_SELECT
+  _Optional EditWin *const edit_win = Session_editor_to_win(editor);
+  if (edit_win) {
+    EditWin_move_ghost_unknown_obj(&*edit_win, bbox);
+  }
+#else
+  Session_move_ghost_unknown_obj(editor->session, bbox);
+#endif
+}
+
 void Editor_add_ghost_unknown_obj(Editor *const editor, MapArea const *const bbox)
 {
   assert(editor != NULL);
@@ -209,9 +209,11 @@ void Editor_occluded_info_changed(Editor *editor, MapPoint pos);
 void Editor_redraw_ghost(Editor *editor);
 void Editor_clear_ghost_bbox(Editor *editor);
 void Editor_set_ghost_map_bbox(Editor *editor, MapArea const *area);
+void Editor_move_ghost_map_bbox(Editor *editor, MapArea const *area);
 void Editor_add_ghost_obj(Editor *editor, MapPoint pos, ObjRef obj_ref);
 void Editor_add_ghost_info(Editor *editor, MapPoint pos);
 void Editor_add_ghost_unknown_obj(Editor *editor, MapArea const *bbox);
+void Editor_move_ghost_unknown_obj(Editor *editor, MapArea const *bbox);
 void Editor_add_ghost_unknown_info(Editor *editor, MapArea const *bbox);
 void Editor_redraw_pending(Editor *editor, bool immediate);
 
@@ -29,6 +29,8 @@
 #define TILEGROUPS_DIR "TileGroups"
 #define TILESNAKES_DIR "TileSnakes"
 #define OBJSNAKES_DIR "ObjSnakes"
+#define PRECOMP_DIR "Compiled"
+#define JOURNAL_DIR "Journal"
 #define CONFIG_FILE "Config"
 
 /* Fixed paths to Landscapes directories */
@@ -37,6 +37,7 @@
 #include "DirIter.h"
 #include "Hourglass.h"
 #include "StringBuff.h"
+#include "OSFile.h"
 
 #include "FileScan.h"
 #include "FilePaths.h"
@@ -50,11 +51,20 @@
 #include "Optional.h"
 #endif
 
+/* Catalogue information of a scanned directory, used to detect changes
+   that we weren't told about */
+typedef struct {
+  int object_type;
+  unsigned int load, exec;
+} fs_dir_stamp;
+
 struct fs_dir_info {
   DataType data_type;
   _Optional filescan_leafname *leaf_names;
   bool rescan_needed;
   int scan_no;
+  size_t count; /* number of leaf_names, excluding terminator */
+  fs_dir_stamp intern_stamp, extern_stamp;
 };
 
 static struct fs_dir_info knowledge[FS_LAST] =
@@ -147,6 +157,36 @@ static void fs_array_destroy(fs_array *const array)
   free(array->names);
 }
 
+static int fs_compare(void const *const a, void const *const b)
+{
+  filescan_leafname const *const name_a = a, *const name_b = b;
+  return stricmp(name_a->leaf_name, name_b->leaf_name);
+}
+
+static void fs_array_sort(fs_array *const array)
+{
+  /* Sort names into the order expected by filescan_combine_filenames
+     and remove any that differ only in case */
+  assert(array != NULL);
+  assert(array->used <= array->len);
+
+  if (array->used < 2 || !array->names) {
+    return;
+  }
+
+  qsort(&*array->names, array->used, sizeof(*array->names), fs_compare);
+
+  size_t out = 1;
+  for (size_t in = 1; in < array->used; ++in) {
+    if (fs_compare(&array->names[in], &array->names[out - 1]) != 0) {
+      array->names[out++] = array->names[in];
+    } else {
+      DEBUGF("Ignoring duplicate name '%s'\n", array->names[in].leaf_name);
+    }
+  }
+  array->used = out;
+}
+
 #ifdef USE_REPORTER
 static void print_list(const filescan_leafname *const filenames)
 {
@@ -161,48 +201,52 @@ static int fs_file_type(filescan_type const directory)
   return data_type_to_file_type(filescan_get_data_type(directory));
 }
 
-static bool fs_not_empty(char const *const s, filescan_type const directory)
+static fs_dir_stamp fs_get_stamp(char const *const root_dir,
+  filescan_type const directory)
 {
-  /* Returns true if the directory exists and contains one or more files of the
-     specified type */
+  fs_dir_stamp stamp = {.object_type = ObjectType_NotFound, .load = 0, .exec = 0};
+
+  _Optional char *const path = make_file_path_in_dir(root_dir,
+                                 filescan_get_directory(directory));
+  if (path) {
+    OS_File_CatalogueInfo info;
+    if (os_file_read_cat_no_path(&*path, &info) == NULL) {
+      stamp = (fs_dir_stamp){.object_type = info.object_type,
+                             .load = info.load, .exec = info.exec};
+    }
+    free(path);
+  }
+  return stamp;
+}
 
-  if (!file_exists(s)) {
+static bool fs_stamps_match(filescan_type const directory)
+{
+  /* Reading the catalogue information of a directory is much cheaper than
+     enumerating its contents */
+  struct fs_dir_info const *const info = &knowledge[directory];
+  fs_dir_stamp const intern_stamp = fs_get_stamp(Config_get_read_dir(), directory);
+  if (memcmp(&intern_stamp, &info->intern_stamp, sizeof(intern_stamp)) != 0) {
+    DEBUGF("Internal directory %d has changed\n", directory);
     return false;
   }
 
-  int const file_type = fs_file_type(directory);
-  DEBUG("Checking for existence of files of type %x in %s", file_type, s);
-
-  bool found_object = false;
-  _Optional DirIterator *iter = NULL;
-  for (_Optional const _kernel_oserror *e = diriterator_make(&iter, 0, s, NULL);
-       !E(e) && iter;
-       e = diriterator_advance(&*iter)) {
-
-    DirIteratorObjectInfo info;
-    int const object_type = diriterator_get_object_info(&*iter, &info);
-    if (object_type == ObjectType_NotFound) {
-      break;
-    }
-
-    if (info.file_type != file_type) {
-      continue;
-    }
-
-    /* Check that filename within length limit */
-    filescan_leafname tmp;
-    if (diriterator_get_object_leaf_name(&*iter, tmp.leaf_name,
-        sizeof(tmp.leaf_name)) >= sizeof(tmp.leaf_name)) {
-      DEBUGF("%s exceeds the character limit\n", tmp.leaf_name);
-      continue;
+  if (Config_get_use_extern_levels_dir()) {
+    fs_dir_stamp const extern_stamp = fs_get_stamp(Config_get_extern_levels_dir(), directory);
+    if (memcmp(&extern_stamp, &info->extern_stamp, sizeof(extern_stamp)) != 0) {
+      DEBUGF("External directory %d has changed\n", directory);
+      return false;
     }
-
-    found_object = true;
-    break;
   }
-  diriterator_destroy(iter);
+  return true;
+}
 
-  return found_object;
+static size_t fs_count(filescan_leafname const *const filenames)
+{
+  size_t count = 0;
+  while (*filenames[count].leaf_name != '\0') {
+    ++count;
+  }
+  return count;
 }
 
 static _Optional filescan_leafname *fs_dir(char const *const s,
@@ -253,6 +297,10 @@ static _Optional filescan_leafname *fs_dir(char const *const s,
     hourglass_off();
   }
 
+  if (success) {
+    fs_array_sort(&scan_results);
+  }
+
   if (success && !fs_array_end(&scan_results)) {
     report_error(SFERROR(NoMem), "", "");
     success = false;
@@ -385,43 +433,39 @@ char const *filescan_get_directory(filescan_type const directory)
 
 bool filescan_dir_not_empty(filescan_type const directory)
 {
-  bool not_empty = false;
+  /* Served from the catalogue of directory contents unless that is stale */
+  _Optional filescan_leafname const *const leaf_names =
+    filescan_get_leaf_names(directory, NULL);
 
-  if (!Config_get_lazydirscan() || knowledge[directory].rescan_needed)
-  {
-    /* Rather than scanning the entire directory we simply check for the
-    presence of one or more files */
-    char const *const sub_dir = filescan_get_directory(directory);
+  return leaf_names && *leaf_names[0].leaf_name != '\0';
+}
 
-    /* construct FULL path for internal game directory to scan */
-    _Optional char *const intern_path = make_file_path_in_dir(Config_get_read_dir(), sub_dir);
-    if (intern_path)
-    {
-      /* Scan internal game directory */
-      not_empty = fs_not_empty(&*intern_path, directory);
-      free(intern_path);
+bool filescan_find_leaf_name(filescan_type const directory,
+                             char const *const leaf_name,
+                             _Optional bool *const is_internal)
+{
+  assert(leaf_name != NULL);
 
-      /* do we have an external levels directory configured? */
-      if (!not_empty && Config_get_use_extern_levels_dir())
-      {
-        /* construct FULL path for external game directory to scan */
-        _Optional char *const extern_path = make_file_path_in_dir(Config_get_extern_levels_dir(), sub_dir);
-        if (extern_path)
-        {
-          /* Scan external game directory */
-          not_empty = fs_not_empty(&*extern_path, directory);
-          free(extern_path);
-        }
-      }
-    }
+  _Optional filescan_leafname const *const leaf_names =
+    filescan_get_leaf_names(directory, NULL);
+  if (!leaf_names) {
+    return false;
   }
-  else
-  {
-    /* Check cached catalogue of directory contents */
-    not_empty = knowledge[directory].leaf_names &&
-                *knowledge[directory].leaf_names[0].leaf_name != '\0';
+
+  filescan_leafname key = {.is_internal = false};
+  STRCPY_SAFE(key.leaf_name, leaf_name);
+
+  _Optional filescan_leafname const *const found = bsearch(&key, &*leaf_names,
+    knowledge[directory].count, sizeof(key), fs_compare);
+
+  if (!found) {
+    return false;
+  }
+
+  if (is_internal) {
+    *is_internal = found->is_internal;
   }
-  return not_empty;
+  return true;
 }
 
 _Optional filescan_leafname *filescan_get_leaf_names(filescan_type const directory,
@@ -432,16 +476,28 @@ _Optional filescan_leafname *filescan_get_leaf_names(filescan_type const directo
 
   DEBUG("Filescan received request for catalogue of directory %d", directory);
 
-  /* Scan directory? */
-  if (!Config_get_lazydirscan() || knowledge[directory].rescan_needed)
+  /* Scan directory? Unless lazy, check for changes we weren't told about. */
+  if (knowledge[directory].rescan_needed ||
+      (!Config_get_lazydirscan() && !fs_stamps_match(directory)))
   {
     DEBUG("filescan_get_leaf_names about to scan directory %d", directory);
+
+    /* Record the directories' catalogue information before scanning them,
+       so that any change during the scan forces another */
+    fs_dir_stamp const intern_stamp = fs_get_stamp(Config_get_read_dir(), directory),
+                       extern_stamp = Config_get_use_extern_levels_dir() ?
+                         fs_get_stamp(Config_get_extern_levels_dir(), directory) :
+                         (fs_dir_stamp){.object_type = ObjectType_NotFound};
+
     _Optional filescan_leafname *const newfiles = fs_scanlevelspath(directory);
 
     if (newfiles != NULL)
     {
       free(knowledge[directory].leaf_names);
       knowledge[directory].leaf_names = &*newfiles;
+      knowledge[directory].count = fs_count(&*newfiles);
+      knowledge[directory].intern_stamp = intern_stamp;
+      knowledge[directory].extern_stamp = extern_stamp;
 
       knowledge[directory].rescan_needed = false;
 
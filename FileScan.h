@@ -47,6 +47,11 @@ char const *filescan_get_emh_path(filescan_type directory);
 const char *filescan_get_directory(filescan_type directory);
 bool filescan_dir_not_empty(filescan_type directory);
 
+/* Finds a leaf name in the catalogue of a directory without regard to case.
+   Optionally outputs whether the file is in the internal game directory. */
+bool filescan_find_leaf_name(filescan_type directory, char const *leaf_name,
+                             _Optional bool *is_internal);
+
 _Optional filescan_leafname *filescan_get_leaf_names(filescan_type directory,
                                                      _Optional int *vsn);
 void filescan_directory_updated(filescan_type directory);
@@ -0,0 +1,118 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Cache of projected hill polygons
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "stdlib.h"
+
+#include "Macros.h"
+#include "Debug.h"
+
+#include "View.h"
+#include "MapCoord.h"
+#include "Hill.h"
+#include "HillCol.h"
+#include "ObjGfxMesh.h"
+#include "HillCache.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+enum {
+  HillArea = Hill_Size * Hill_Size,
+};
+
+struct HillCache {
+  int zoom_factor;
+  MapAngle angle;
+  _Optional struct HillColData const *hill_colours;
+  bool is_valid[HillArea];
+  ObjGfxHillGeom geoms[HillArea];
+};
+
+/* ---------------- Public functions ---------------- */
+
+_Optional HillCache *HillCache_create(void)
+{
+  _Optional HillCache *const cache = malloc(sizeof(*cache));
+  if (cache) {
+    cache->zoom_factor = 0;
+    cache->angle = MapAngle_North;
+    cache->hill_colours = NULL;
+    HillCache_invalidate(&*cache);
+  }
+  return cache;
+}
+
+void HillCache_destroy(_Optional HillCache *const cache)
+{
+  free(cache);
+}
+
+void HillCache_invalidate(HillCache *const cache)
+{
+  assert(cache);
+  DEBUGF("Invalidate all cached hills\n");
+  memset(cache->is_valid, 0, sizeof(cache->is_valid));
+}
+
+void HillCache_invalidate_hill(HillCache *const cache, MapPoint const hill_pos)
+{
+  assert(cache);
+  cache->is_valid[hill_coords_to_index(hill_pos)] = false;
+}
+
+void HillCache_set_view(HillCache *const cache, View const *const view,
+  _Optional HillColData const *const hill_colours)
+{
+  assert(cache);
+  assert(view);
+
+  if (cache->zoom_factor != view->config.zoom_factor ||
+      cache->angle != view->config.angle ||
+      cache->hill_colours != hill_colours) {
+    cache->zoom_factor = view->config.zoom_factor;
+    cache->angle = view->config.angle;
+    cache->hill_colours = hill_colours;
+    HillCache_invalidate(cache);
+  }
+}
+
+_Optional ObjGfxHillGeom const *HillCache_find(HillCache const *const cache,
+  MapPoint const hill_pos)
+{
+  assert(cache);
+  size_t const index = hill_coords_to_index(hill_pos);
+  return cache->is_valid[index] ? &cache->geoms[index] : NULL;
+}
+
+void HillCache_add(HillCache *const cache, MapPoint const hill_pos,
+  ObjGfxHillGeom const *const geom)
+{
+  assert(cache);
+  assert(geom);
+  size_t const index = hill_coords_to_index(hill_pos);
+  cache->geoms[index] = *geom;
+  cache->is_valid[index] = true;
+}
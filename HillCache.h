@@ -0,0 +1,44 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Cache of projected hill polygons
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef HillCache_h
+#define HillCache_h
+
+#include <stdbool.h>
+
+#include "MapCoord.h"
+#include "ObjGfxMesh.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+struct View;
+struct HillColData;
+
+typedef struct HillCache HillCache;
+
+/* A cache of the projected polygons of each hill in a view. Individual
+   hills must be invalidated whenever they are regenerated, and the whole
+   cache whenever all hills are regenerated or the hill colours change. */
+_Optional HillCache *HillCache_create(void);
+void HillCache_destroy(_Optional HillCache *cache);
+
+void HillCache_invalidate(HillCache *cache);
+void HillCache_invalidate_hill(HillCache *cache, MapPoint hill_pos);
+
+/* Discards all cached hills if the given view or colours differ from
+   those for which they were projected. */
+void HillCache_set_view(HillCache *cache, struct View const *view,
+  _Optional struct HillColData const *hill_colours);
+
+_Optional ObjGfxHillGeom const *HillCache_find(HillCache const *cache,
+  MapPoint hill_pos);
+
+void HillCache_add(HillCache *cache, MapPoint hill_pos,
+  ObjGfxHillGeom const *geom);
+
+#endif
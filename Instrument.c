@@ -0,0 +1,172 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Counters and timers for hot paths
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "Macros.h"
+#include "Debug.h"
+
+#include "Instrument.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+#ifdef INSTRUMENT
+
+enum {
+  FrameCount = 128, /* size of the ring buffer */
+};
+
+typedef struct {
+  long int counters[InstrumentCounter_Count];
+  long int times[InstrumentTimer_Count]; /* in clock ticks */
+  long int calls[InstrumentTimer_Count];
+} InstrumentFrame;
+
+static InstrumentFrame frames[FrameCount];
+static size_t current_frame, frames_done;
+static clock_t start_times[InstrumentTimer_Count];
+static int nesting[InstrumentTimer_Count];
+static _Optional char *dump_path;
+static bool dump_registered;
+
+/* ---------------- Private functions ---------------- */
+
+static void dump_at_exit(void)
+{
+  if (dump_path) {
+    (void)Instrument_dump(&*dump_path);
+    free(dump_path);
+    dump_path = NULL;
+  }
+}
+
+/* ---------------- Public functions ---------------- */
+
+void Instrument_count(InstrumentCounter const counter, long int const n)
+{
+  assert(counter >= 0);
+  assert(counter < InstrumentCounter_Count);
+  frames[current_frame].counters[counter] += n;
+}
+
+void Instrument_start(InstrumentTimer const timer)
+{
+  assert(timer >= 0);
+  assert(timer < InstrumentTimer_Count);
+
+  /* Only the outermost of any nested calls is timed */
+  if (nesting[timer]++ == 0) {
+    start_times[timer] = clock();
+  }
+  ++frames[current_frame].calls[timer];
+}
+
+void Instrument_stop(InstrumentTimer const timer)
+{
+  assert(timer >= 0);
+  assert(timer < InstrumentTimer_Count);
+  assert(nesting[timer] > 0);
+
+  if (--nesting[timer] == 0) {
+    frames[current_frame].times[timer] += (long)(clock() - start_times[timer]);
+  }
+}
+
+void Instrument_end_frame(void)
+{
+  current_frame = (current_frame + 1) % ARRAY_SIZE(frames);
+  frames[current_frame] = (InstrumentFrame){{0}, {0}, {0}};
+  ++frames_done;
+}
+
+bool Instrument_dump(char const *const path)
+{
+  static char const *const counter_names[InstrumentCounter_Count] = {
+    [InstrumentCounter_TilesPlotted] = "tiles",
+    [InstrumentCounter_PolygonsDrawn] = "polygons",
+    [InstrumentCounter_Callbacks] = "callbacks",
+    [InstrumentCounter_BytesDecompressed] = "bytes_in",
+  };
+  static char const *const timer_names[InstrumentTimer_Count] = {
+    [InstrumentTimer_Redraw] = "redraw",
+    [InstrumentTimer_MapDraw] = "map",
+    [InstrumentTimer_ObjectsDraw] = "objects",
+    [InstrumentTimer_ShipsDraw] = "ships",
+    [InstrumentTimer_InfoDraw] = "info",
+    [InstrumentTimer_Load] = "load",
+    [InstrumentTimer_Save] = "save",
+    [InstrumentTimer_Edit] = "edit",
+  };
+
+  assert(path);
+  DEBUGF("Dumping %zu frames to %s\n", frames_done, path);
+
+  _Optional FILE *const f = fopen(path, "w");
+  if (!f) {
+    return false;
+  }
+
+  /* Times are in clock ticks; each is followed by the number of calls */
+  fprintf(&*f, "frame");
+  for (size_t c = 0; c < ARRAY_SIZE(counter_names); ++c) {
+    fprintf(&*f, " %s", counter_names[c]);
+  }
+  for (size_t t = 0; t < ARRAY_SIZE(timer_names); ++t) {
+    fprintf(&*f, " %s %s_calls", timer_names[t], timer_names[t]);
+  }
+  fprintf(&*f, " (%ld ticks/s)\n", (long)CLOCKS_PER_SEC);
+
+  size_t const n = LOWEST(frames_done, ARRAY_SIZE(frames) - 1);
+  for (size_t i = n; i > 0; --i) {
+    size_t const index = (current_frame + ARRAY_SIZE(frames) - i) % ARRAY_SIZE(frames);
+    InstrumentFrame const *const frame = &frames[index];
+
+    fprintf(&*f, "%zu", frames_done - i);
+    for (size_t c = 0; c < ARRAY_SIZE(frame->counters); ++c) {
+      fprintf(&*f, " %ld", frame->counters[c]);
+    }
+    for (size_t t = 0; t < ARRAY_SIZE(frame->times); ++t) {
+      fprintf(&*f, " %ld %ld", frame->times[t], frame->calls[t]);
+    }
+    fprintf(&*f, "\n");
+  }
+
+  return fclose(&*f) == 0;
+}
+
+void Instrument_dump_at_exit(char const *const path)
+{
+  assert(path);
+  free(dump_path);
+  dump_path = strdup(path);
+  if (!dump_registered) {
+    atexit(dump_at_exit);
+    dump_registered = true;
+  }
+}
+
+#endif /* INSTRUMENT */
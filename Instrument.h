@@ -0,0 +1,74 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Counters and timers for hot paths
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef Instrument_h
+#define Instrument_h
+
+#include <stdbool.h>
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+typedef enum {
+  InstrumentCounter_TilesPlotted,
+  InstrumentCounter_PolygonsDrawn,
+  InstrumentCounter_Callbacks,
+  InstrumentCounter_BytesDecompressed,
+  InstrumentCounter_Count
+} InstrumentCounter;
+
+typedef enum {
+  InstrumentTimer_Redraw,
+  InstrumentTimer_MapDraw,
+  InstrumentTimer_ObjectsDraw,
+  InstrumentTimer_ShipsDraw,
+  InstrumentTimer_InfoDraw,
+  InstrumentTimer_Load,
+  InstrumentTimer_Save,
+  InstrumentTimer_Edit,
+  InstrumentTimer_Count
+} InstrumentTimer;
+
+#ifdef INSTRUMENT
+
+void Instrument_count(InstrumentCounter counter, long int n);
+void Instrument_start(InstrumentTimer timer);
+void Instrument_stop(InstrumentTimer timer);
+
+/* Finishes the current frame. Only the most recent frames are kept. */
+void Instrument_end_frame(void);
+
+/* Writes the recorded frames to a text file, oldest first. */
+bool Instrument_dump(char const *path);
+
+/* Arranges for the recorded frames to be written to a text file when the
+   program exits. */
+void Instrument_dump_at_exit(char const *path);
+
+#define INSTRUMENT_COUNT(counter, n) \
+  Instrument_count(InstrumentCounter_##counter, n)
+
+#define INSTRUMENT_START(timer) Instrument_start(InstrumentTimer_##timer)
+
+#define INSTRUMENT_STOP(timer) Instrument_stop(InstrumentTimer_##timer)
+
+#define INSTRUMENT_END_FRAME() Instrument_end_frame()
+
+#else /* INSTRUMENT */
+
+/* Arguments are not evaluated */
+#define INSTRUMENT_COUNT(counter, n) ((void)0)
+
+#define INSTRUMENT_START(timer) ((void)0)
+
+#define INSTRUMENT_STOP(timer) ((void)0)
+
+#define INSTRUMENT_END_FRAME() ((void)0)
+
+#endif /* INSTRUMENT */
+
+#endif
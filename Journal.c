@@ -0,0 +1,500 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Autosave journals for recovery of unsaved changes
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/* A journal starts with a header identifying the saved file that it applies
+   to, followed by any number of batches of page records. Each page record
+   is an offset and a size followed by that many bytes of uncompressed file
+   data. Each batch ends with a commit record (offset -1) giving the total
+   size of the file. Incomplete batches at the end of a journal (e.g. because
+   the machine crashed whilst writing it) are ignored when it is replayed. */
+
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+#include <stdint.h>
+
+#include "kernel.h"
+#include "flex.h"
+
+#include "Err.h"
+#include "msgtrans.h"
+#include "Macros.h"
+#include "Debug.h"
+#include "NoBudge.h"
+#include "DirIter.h"
+#include "DateStamp.h"
+#include "FOpenCount.h"
+#include "Reader.h"
+#include "ReaderRaw.h"
+#include "Writer.h"
+#include "WriterRaw.h"
+#include "WriterFlex.h"
+
+#include "Journal.h"
+#include "DFileUtils.h"
+#include "FilePaths.h"
+#include "Session.h"
+#include "Utils.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+enum {
+  JournalMagic = 0x314a4653, /* "SFJ1" */
+  JournalPageSize = 256, /* must match the granularity of snapshots */
+  CommitOffset = -1,
+  CompactRatio = 2, /* rewrite journals larger than this multiple of a file */
+  MaxPathLen = 1024,
+  PreExpandHeap = 512,
+  PathsMinAlloc = 8, /* journals to recover */
+};
+
+typedef struct {
+  Writer *writer;
+  void **current;
+  long int current_size;
+  long int nbytes;
+} JournalWriteContext;
+
+typedef struct {
+  Reader *reader;
+  long int start; /* offset of the first record */
+  long int end; /* offset after the last commit record */
+} JournalReadContext;
+
+/* ---------------- Private functions ---------------- */
+
+static _Optional char *make_journal_path(char const *const fname)
+{
+  /* Journal names are derived from file paths, which are case-insensitive */
+  unsigned long int hash = 2166136261ul;
+  for (char const *p = fname; *p != '\0'; ++p) {
+    hash ^= (unsigned char)tolower(*p);
+    hash = (hash * 16777619ul) & 0xffffffffu;
+  }
+
+  char leaf[sizeof("FFFFFFFF")];
+  sprintf(leaf, "%08lX", hash);
+  return make_file_path_in_dir(CHOICES_WRITE_PATH JOURNAL_DIR, leaf);
+}
+
+static long int serialise(DFile *const dfile, void **const buffer)
+{
+  long int const min_size = dfile_get_min_size(dfile);
+  if (!flex_alloc(buffer, (int)HIGHEST(min_size, 1))) {
+    *buffer = NULL;
+    return -1;
+  }
+
+  Writer writer;
+  writer_flex_init(&writer, buffer);
+  dfile_write(dfile, &writer);
+  long int const size = writer_destroy(&writer);
+  if (size == -1L) {
+    flex_free(buffer);
+  }
+  return size;
+}
+
+static void write_page(JournalWriteContext *const ctx, long int const offset,
+  long int const size)
+{
+  /* Pages beyond the end of the current data are removed by the commit */
+  if (offset >= ctx->current_size) {
+    return;
+  }
+
+  long int const nbytes = LOWEST(size, ctx->current_size - offset);
+  writer_fwrite_int32((int32_t)offset, ctx->writer);
+  writer_fwrite_int32((int32_t)nbytes, ctx->writer);
+
+  nobudge_register(PreExpandHeap);
+  writer_fwrite((char *)*ctx->current + offset, 1, (size_t)nbytes, ctx->writer);
+  nobudge_deregister();
+
+  ctx->nbytes += (long)(sizeof(int32_t) * 2) + nbytes;
+}
+
+static void page_changed(void *const arg, long int const offset,
+  long int const size)
+{
+  write_page(arg, offset, size);
+}
+
+static void write_commit(JournalWriteContext *const ctx)
+{
+  writer_fwrite_int32(CommitOffset, ctx->writer);
+  writer_fwrite_int32((int32_t)ctx->current_size, ctx->writer);
+  ctx->nbytes += (long)(sizeof(int32_t) * 2);
+}
+
+static void write_header(JournalWriteContext *const ctx,
+  DataType const data_type, int const date[2], char const *const fname)
+{
+  size_t const len = strlen(fname);
+  writer_fwrite_int32(JournalMagic, ctx->writer);
+  writer_fwrite_int32(data_type, ctx->writer);
+  writer_fwrite_int32(date[0], ctx->writer);
+  writer_fwrite_int32(date[1], ctx->writer);
+  writer_fwrite_int32((int32_t)len, ctx->writer);
+  writer_fwrite(fname, 1, len, ctx->writer);
+  ctx->nbytes += (long)(sizeof(int32_t) * 5 + len);
+}
+
+static void write_changes(JournalWriteContext *const ctx,
+  void **const checkpoint, long int const checkpoint_size)
+{
+  /* Only the pages that differ from the last checkpoint are appended */
+  for (long int offset = 0; offset < ctx->current_size;
+       offset += JournalPageSize) {
+    long int const ncurrent = LOWEST(ctx->current_size - offset, JournalPageSize);
+    long int const nold = offset < checkpoint_size ?
+                          LOWEST(checkpoint_size - offset, JournalPageSize) : 0;
+
+    nobudge_register(PreExpandHeap);
+    bool const same = (ncurrent == nold) &&
+                      !memcmp((char *)*ctx->current + offset,
+                              (char *)*checkpoint + offset, (size_t)ncurrent);
+    nobudge_deregister();
+
+    if (!same) {
+      write_page(ctx, offset, ncurrent);
+    }
+  }
+}
+
+static bool write_journal(JournalFile *const journal, DFile *const dfile,
+  DataType const data_type, char *const path, void **const current,
+  long int const current_size, bool const rewrite)
+{
+  if (rewrite && !ensure_path_exists(path)) {
+    return false;
+  }
+
+  _Optional FILE *const f = fopen_inc(path, rewrite ? "wb" : "ab");
+  if (!f) {
+    return false;
+  }
+
+  Writer writer;
+  writer_raw_init(&writer, &*f);
+  JournalWriteContext ctx = {
+    .writer = &writer,
+    .current = current,
+    .current_size = current_size,
+    .nbytes = 0,
+  };
+
+  bool success = true;
+  if (rewrite) {
+    /* Compact the journal by recording all differences from the saved
+       state in a single batch */
+    _Optional char const *const fname = dfile_get_name(dfile);
+    assert(fname);
+    write_header(&ctx, data_type, dfile_get_date(dfile), fname ? &*fname : "");
+    success = compare_with_snapshot(dfile, page_changed, &ctx) >= 0;
+  } else {
+    assert(journal->checkpoint);
+    write_changes(&ctx, &journal->checkpoint, journal->checkpoint_size);
+  }
+
+  if (success) {
+    write_commit(&ctx);
+  }
+
+  if (writer_destroy(&writer) == -1L) {
+    success = false;
+  }
+
+  if (fclose_dec(&*f)) {
+    success = false;
+  }
+
+  if (success) {
+    journal->size = (rewrite ? 0 : journal->size) + ctx.nbytes;
+  } else if (rewrite) {
+    /* Don't leave a journal without a valid header */
+    remove(path);
+  }
+
+  DEBUGF("%s %ld bytes to journal %s\n", rewrite ? "Wrote" : "Appended",
+         ctx.nbytes, path);
+  return success;
+}
+
+static bool find_last_commit(JournalReadContext *const ctx)
+{
+  int32_t offset, nbytes;
+  while (reader_fread_int32(&offset, ctx->reader) &&
+         reader_fread_int32(&nbytes, ctx->reader)) {
+    if (offset == CommitOffset) {
+      ctx->end = reader_ftell(ctx->reader);
+    } else if (offset < 0 || nbytes < 0 ||
+               reader_fseek(ctx->reader, nbytes, SEEK_CUR)) {
+      break;
+    }
+  }
+  return ctx->end > ctx->start;
+}
+
+static bool apply_journal(void *const arg, void **const buffer,
+  long int *const size)
+{
+  JournalReadContext *const ctx = arg;
+  assert(ctx);
+  assert(buffer);
+  assert(size);
+
+  if (reader_fseek(ctx->reader, ctx->start, SEEK_SET)) {
+    return false;
+  }
+
+  while (reader_ftell(ctx->reader) < ctx->end) {
+    int32_t offset, nbytes;
+    if (!reader_fread_int32(&offset, ctx->reader) ||
+        !reader_fread_int32(&nbytes, ctx->reader) || nbytes < 0) {
+      return false;
+    }
+
+    if (offset == CommitOffset) {
+      *size = nbytes;
+      continue;
+    }
+
+    if (offset < 0) {
+      return false;
+    }
+
+    if (offset + nbytes > flex_size(buffer) &&
+        !flex_extend(buffer, offset + nbytes)) {
+      return false;
+    }
+
+    nobudge_register(PreExpandHeap);
+    size_t const n = reader_fread((char *)*buffer + offset, 1, (size_t)nbytes,
+                                  ctx->reader);
+    nobudge_deregister();
+
+    if (n != (size_t)nbytes) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool is_saved_file(char const *const fname, int const date[2])
+{
+  /* A journal is useless if the file has since been modified or deleted */
+  OS_DateAndTime date_stamp;
+  if (!file_exists(fname) || E(get_date_stamp(fname, &date_stamp))) {
+    return false;
+  }
+
+  int tmp[2] = {0};
+  memcpy(tmp, &date_stamp, sizeof(date_stamp));
+  return tmp[0] == date[0] && tmp[1] == date[1];
+}
+
+static void recover_file(char const *const path)
+{
+  DEBUGF("Found journal %s\n", path);
+
+  _Optional FILE *const f = fopen_inc(path, "rb");
+  if (!f) {
+    return;
+  }
+
+  Reader reader;
+  reader_raw_init(&reader, &*f);
+
+  int32_t magic, data_type, date[2], len;
+  _Optional char *fname = NULL;
+  if (reader_fread_int32(&magic, &reader) && magic == JournalMagic &&
+      reader_fread_int32(&data_type, &reader) &&
+      data_type >= DataType_First && data_type < DataType_SessionCount &&
+      reader_fread_int32(&date[0], &reader) &&
+      reader_fread_int32(&date[1], &reader) &&
+      reader_fread_int32(&len, &reader) && len > 0 && len < MaxPathLen) {
+    fname = malloc((size_t)len + 1);
+    if (!fname) {
+      report_error(SFERROR(NoMem), "", "");
+    } else if (reader_fread(&*fname, 1, (size_t)len, &reader) != (size_t)len) {
+      free(fname);
+      fname = NULL;
+    } else {
+      fname[len] = '\0';
+    }
+  }
+
+  if (fname) {
+    JournalReadContext ctx = {
+      .reader = &reader,
+      .start = reader_ftell(&reader),
+      .end = -1,
+    };
+
+    int const saved_date[2] = {date[0], date[1]};
+    if (find_last_commit(&ctx) && is_saved_file(&*fname, saved_date) &&
+        dialogue_confirm(msgs_lookup_subn("Recover", 1, &*fname), "RecBut")) {
+      (void)Session_recover_single_file(&*fname, (DataType)data_type,
+                                        apply_journal, &ctx);
+    }
+    free(fname);
+  }
+
+  reader_destroy(&reader);
+  fclose_dec(&*f);
+
+  /* Whether or not the changes were recovered, they will be journalled
+     again if they are still unsaved */
+  (void)verbose_remove(path);
+}
+
+/* ---------------- Public functions ---------------- */
+
+bool Journal_update(JournalFile *const journal, DFile *const dfile,
+  DataType const data_type)
+{
+  assert(journal);
+  assert(dfile);
+
+  _Optional char const *const fname = dfile_get_name(dfile);
+  if (!fname || !has_snapshot(dfile)) {
+    /* Untitled files have no saved state to apply changes to */
+    Journal_discard(journal);
+    return false;
+  }
+
+  _Optional char *const path = make_journal_path(&*fname);
+  if (!path) {
+    return false;
+  }
+
+  int const *const date = dfile_get_date(dfile);
+  if (journal->path && strcmp(&*journal->path, &*path)) {
+    /* The file was saved under a different name */
+    Journal_discard(journal);
+  }
+
+  void *current = NULL;
+  long int const current_size = serialise(dfile, &current);
+  if (current_size < 0) {
+    free(path);
+    return false;
+  }
+
+  bool const rewrite = !journal->checkpoint ||
+                       journal->size > current_size * CompactRatio ||
+                       journal->date[0] != date[0] ||
+                       journal->date[1] != date[1];
+
+  if (!write_journal(journal, dfile, data_type, &*path, &current,
+                     current_size, rewrite)) {
+    flex_free(&current);
+    free(path);
+    return false;
+  }
+
+  /* The current state becomes the checkpoint for the next update */
+  if (journal->checkpoint) {
+    flex_free(&journal->checkpoint);
+  }
+  flex_reanchor(&journal->checkpoint, &current);
+  journal->checkpoint_size = current_size;
+  journal->date[0] = date[0];
+  journal->date[1] = date[1];
+
+  free(journal->path);
+  journal->path = path;
+  return true;
+}
+
+void Journal_discard(JournalFile *const journal)
+{
+  assert(journal);
+
+  if (journal->path) {
+    DEBUGF("Discarding journal %s\n", &*journal->path);
+    remove(&*journal->path);
+    free(journal->path);
+    journal->path = NULL;
+  }
+
+  if (journal->checkpoint) {
+    flex_free(&journal->checkpoint);
+  }
+  journal->size = 0;
+}
+
+void Journal_recover_all(void)
+{
+  static char const dir[] = CHOICES_WRITE_PATH JOURNAL_DIR;
+  if (!file_exists(dir)) {
+    return;
+  }
+
+  /* Collect the paths before recovering any files because journals are
+     deleted and created whilst recovering them */
+  size_t npaths = 0, max_paths = 0;
+  char **paths = NULL;
+  _Optional DirIterator *iter = NULL;
+  _Optional const _kernel_oserror *e = diriterator_make(&iter, 0, dir, NULL);
+
+  for (; !E(e) && iter && !diriterator_is_empty(&*iter);
+       e = diriterator_advance(&*iter)) {
+    DirIteratorObjectInfo info;
+    if (diriterator_get_object_info(&*iter, &info) != ObjectType_File) {
+      continue;
+    }
+
+    if (npaths == max_paths) {
+      size_t const new_max = HIGHEST(PathsMinAlloc, max_paths * 2);
+      _Optional void *const new_paths = realloc(paths, sizeof(*paths) * new_max);
+      if (!new_paths) {
+        report_error(SFERROR(NoMem), "", "");
+        break;
+      }
+      paths = new_paths;
+      max_paths = new_max;
+    }
+
+    size_t const n = diriterator_get_object_path_name(&*iter, NULL, 0);
+    _Optional char *const path = malloc(n + 1);
+    if (!path) {
+      report_error(SFERROR(NoMem), "", "");
+      break;
+    }
+    (void)diriterator_get_object_path_name(&*iter, &*path, n + 1);
+    paths[npaths++] = &*path;
+  }
+
+  diriterator_destroy(iter);
+
+  for (size_t i = 0; i < npaths; ++i) {
+    recover_file(paths[i]);
+    free(paths[i]);
+  }
+  free(paths);
+}
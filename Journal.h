@@ -0,0 +1,41 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Autosave journals for recovery of unsaved changes
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef Journal_h
+#define Journal_h
+
+#include <stdbool.h>
+
+#include "DFile.h"
+#include "DataType.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+typedef struct {
+  void *checkpoint; /* flex anchor for the state last journalled, or NULL */
+  long int checkpoint_size;
+  long int size; /* no. of bytes written to the journal file */
+  int date[2]; /* date stamp of the saved file that the journal applies to */
+  _Optional char *path; /* journal file path, or NULL if none */
+} JournalFile;
+
+/* Appends any changes made to a file since the last update to its journal,
+   or starts a new journal if there is none or the existing journal has grown
+   too large. Only files that have been saved (and have a snapshot of their
+   saved state) can be journalled. */
+bool Journal_update(JournalFile *journal, DFile *dfile, DataType data_type);
+
+/* Deletes the journal file (e.g. after the changes have been saved) and
+   releases any associated memory. */
+void Journal_discard(JournalFile *journal);
+
+/* Looks for journals left behind by a previous run of the program and offers
+   to reopen each file with its unsaved changes restored. */
+void Journal_recover_all(void);
+
+#endif
@@ -138,19 +138,23 @@ static void make_mini_map(MapSnakes *const snakes_data, int const snake,
   }
 }
 
-static DrawTilesReadResult read_thumbnail(void *const cb_arg, MapPoint const map_pos)
+static void read_thumbnail(void *const cb_arg, MapPoint map_pos,
+  MapPoint const step, size_t const count, MapRef *const tile_refs,
+  bool *const is_selected)
 {
   const MapRef (*const thumb_tiles)[MapSnakesMiniMapHeight][MapSnakesMiniMapWidth] = cb_arg;
   assert(thumb_tiles != NULL);
-  assert(map_pos.x >= 0);
-  assert(map_pos.x < MapSnakesMiniMapWidth);
-  assert(map_pos.y >= 0);
-  assert(map_pos.y < MapSnakesMiniMapHeight);
 
-  return (DrawTilesReadResult){
-    .tile_ref = (*thumb_tiles)[map_pos.y][map_pos.x],
-    .is_selected = false,
-  };
+  for (size_t i = 0; i < count; ++i) {
+    assert(map_pos.x >= 0);
+    assert(map_pos.x < MapSnakesMiniMapWidth);
+    assert(map_pos.y >= 0);
+    assert(map_pos.y < MapSnakesMiniMapHeight);
+
+    tile_refs[i] = (*thumb_tiles)[map_pos.y][map_pos.x];
+    is_selected[i] = false;
+    map_pos = MapPoint_add(map_pos, step);
+  }
 }
 
 static bool make_thumbnails(MapSnakes *const snakes_data,
@@ -181,12 +185,14 @@ static bool make_thumbnails(MapSnakes *const snakes_data,
     MapRef thumb_tiles[MapSnakesMiniMapHeight][MapSnakesMiniMapWidth];
     make_mini_map(snakes_data, snake, &thumb_tiles);
 
-    bool const needs_mask = DrawTiles_to_sprite(
+    bool needs_mask = false;
+    if (!DrawTiles_to_sprite(
       textures, &snakes_data->thumbnail_sprites, sprite_name, MapAngle_North, &scr_area,
       read_thumbnail, &thumb_tiles,
       0, /* plot at 1:1 */
-      NULL /* no colour translation */
-    );
+      NULL, /* no colour translation */
+      &needs_mask))
+      return false;
 
     /* Create thumbnail mask (with all pixels solid) */
     if (needs_mask &&
@@ -314,7 +320,9 @@ void MapSnakes_load(MapSnakes *const snakes_data,
   SFError err = SFERROR(OK);
 
   hourglass_on();
-  if (file_exists(&*full_path)) {
+  if (file_exists(&*full_path) &&
+      !Snakes_load_compiled(&snakes_data->super, TILESNAKES_DIR, tiles_set,
+                            &*full_path, ntiles)) {
     _Optional FILE *const file = fopen(&*full_path, "r");
     if (file == NULL) {
       err = SFERROR(OpenInFail);
@@ -322,6 +330,11 @@ void MapSnakes_load(MapSnakes *const snakes_data,
       err = Snakes_load(&*file, &snakes_data->super, ntiles, err_buf);
       fclose(&*file);
     }
+
+    if (!SFError_fail(err)) {
+      Snakes_save_compiled(&snakes_data->super, TILESNAKES_DIR, tiles_set,
+                           &*full_path, ntiles);
+    }
   }
   hourglass_off();
 
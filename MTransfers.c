@@ -68,6 +68,7 @@
 #include "Map.h"
 #include "CoarseCoord.h"
 #include "StrDict.h"
+#include "PreComp.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -75,6 +76,10 @@
 
 #define TRANSFER_TAG "STMP"
 
+/* Change the version number if CacheEntry changes */
+#define CACHE_FORMAT "MTr1"
+#define CACHE_DIR "MapTransfers"
+
 enum
 {
   PREALLOC_SIZE = 4096,
@@ -82,8 +87,11 @@ enum
   TransferFormatWithAnims = 1,
   TransferFormatWithSizeMinus1 = 2,
   TransferFormatWithCompactAnims = 3,
+  TransferFormatWithRowRuns = 4,
   TransferFormatVersion = TransferFormatWithCompactAnims,
+  TransferFormatMaxReadable = TransferFormatWithRowRuns,
   TransferHasAnimations = 1,
+  TransferHasRowRuns = 2,
   PreAnimPadding = 12,
   MapOffsetDivider = 4,
 };
@@ -94,7 +102,10 @@ struct MapTransfer
   struct DFile dfile;
   CoarsePoint2d  size_minus_one;
   void          *tiles, *anims; /* flex anchor */
-  int         anim_count, anim_alloc;
+  void          *areas; /* flex anchor for non-mask areas, or NULL */
+  int         anim_count, anim_alloc, area_count;
+  bool        body_failed; /* failed to load tiles on demand */
+  bool        has_thumbnail; /* only used whilst making thumbnails */
 };
 
 typedef struct
@@ -103,6 +114,15 @@ typedef struct
   MapAnimParam param;
 } MapTransferAnim;
 
+/* Header of a transfer as recorded in the cache of thumbnails */
+typedef struct
+{
+  Filename name;
+  int date[2]; /* of the transfer file */
+  CoarsePoint2d size_minus_one;
+  int anim_count;
+} CacheEntry;
+
 /* ---------------- Private functions ---------------- */
 
 static inline int uchar_offset(MapTransfer *const transfer,
@@ -125,9 +145,63 @@ static inline int calc_map_size(CoarsePoint2d const size_minus_one)
   return (size_minus_one.x + 1) * (size_minus_one.y + 1);
 }
 
-static DrawTilesReadResult read_transfer_tile(void *const cb_arg, MapPoint const trans_pos)
+static void destroy_all(MapTransfer *const transfer)
+{
+  assert(transfer);
+
+  if (transfer->tiles)
+  {
+    flex_free(&transfer->tiles);
+  }
+
+  if (transfer->anims)
+  {
+    flex_free(&transfer->anims);
+  }
+  transfer->anim_count = transfer->anim_alloc = 0;
+
+  if (transfer->areas)
+  {
+    flex_free(&transfer->areas);
+  }
+  transfer->area_count = 0;
+}
+
+static bool ensure_body(MapTransfer *const transfer)
+{
+  /* Transfers whose header was found in the cache aren't decompressed
+     until their contents are needed */
+  assert(transfer != NULL);
+  if (transfer->tiles) {
+    return true;
+  }
+
+  if (transfer->body_failed) {
+    return false;
+  }
+
+  _Optional char const *const filename = dfile_get_name(&transfer->dfile);
+  assert(filename);
+  if (!filename) {
+    return false;
+  }
+
+  DEBUGF("Loading transfer '%s' on demand\n", &*filename);
+  hourglass_on();
+  SFError const err = load_compressed(&transfer->dfile, &*filename);
+  hourglass_off();
+
+  if (report_error(err, &*filename, "")) {
+    /* Don't keep retrying (and reporting errors) */
+    destroy_all(transfer);
+    transfer->body_failed = true;
+    return false;
+  }
+  return true;
+}
+
+static MapRef read_transfer_tile(MapTransfer *const transfer, MapPoint const trans_pos)
 {
-  MapTransfer *const transfer = cb_arg;
   assert(transfer != NULL);
 
   DEBUG_VERBOSEF("Read %" PRIMapCoord ",%" PRIMapCoord
@@ -135,10 +209,34 @@ static DrawTilesReadResult read_transfer_tile(void *const cb_arg, MapPoint const
     trans_pos.x, trans_pos.y,
     MapTransfers_get_dims(transfer).x, MapTransfers_get_dims(transfer).y);
 
-  return (DrawTilesReadResult){
-    .tile_ref = map_ref_from_num(((unsigned char *)transfer->tiles)[uchar_offset(transfer, trans_pos)]),
-    .is_selected = false,
-  };
+  return map_ref_from_num(((unsigned char *)transfer->tiles)[uchar_offset(transfer, trans_pos)]);
+}
+
+static void read_transfer_tiles(void *const cb_arg, MapPoint const trans_pos,
+  MapPoint const step, size_t const count, MapRef *const tile_refs,
+  bool *const is_selected)
+{
+  MapTransfer *const transfer = cb_arg;
+  assert(transfer != NULL);
+  assert(count > 0);
+
+  DEBUG_VERBOSEF("Read %zu from %" PRIMapCoord ",%" PRIMapCoord
+                 " in transfer %" PRIMapCoord ",%" PRIMapCoord "\n",
+    count, trans_pos.x, trans_pos.y,
+    MapTransfers_get_dims(transfer).x, MapTransfers_get_dims(transfer).y);
+
+  /* Transfers don't wrap, so the whole span must lie within the transfer */
+  int const stride = (int)step.x + ((int)step.y * ((int)transfer->size_minus_one.x + 1));
+  int offset = uchar_offset(transfer, trans_pos);
+  assert(uchar_offset(transfer, MapPoint_add(trans_pos,
+           MapPoint_mul(step, (MapPoint){(MapCoord)count - 1, (MapCoord)count - 1}))) ==
+         offset + (stride * ((int)count - 1)));
+
+  unsigned char const *const tiles = transfer->tiles;
+  for (size_t i = 0; i < count; ++i, offset += stride) {
+    tile_refs[i] = map_ref_from_num(tiles[offset]);
+    is_selected[i] = false;
+  }
 }
 
 static void write_transfer_tile(MapTransfer *const transfer,
@@ -208,6 +306,10 @@ static bool make_transfer_thumbnail(MapTransfers *const transfers_data,
 
   DEBUG("About to create thumbnail for transfer '%s'", dfile_get_name(&transfer->dfile));
 
+  if (!ensure_body(transfer)) {
+    return false;
+  }
+
   /* Create a thumbnail sprite for a new transfer */
   MapPoint const size_in_tiles = MapTransfers_get_dims(transfer);
 
@@ -228,15 +330,21 @@ static bool make_transfer_thumbnail(MapTransfers *const transfers_data,
   MapArea const scr_area = {{0,0}, {size_in_tiles.x-1, size_in_tiles.y-1}};
 
   /* Paint to thumbnail sprite */
-  bool const needs_mask = DrawTiles_to_sprite(
+  bool needs_mask = false;
+  if (!DrawTiles_to_sprite(
     textures,
     &transfers_data->thumbnail_sprites,
     spr_name,
     MapAngle_North, &scr_area,
-    read_transfer_tile,
+    read_transfer_tiles,
     transfer,
     thumb_zoom,
-    NULL /* no colour translation */);
+    NULL, /* no colour translation */
+    &needs_mask))
+  {
+    DEBUG("Failed to draw thumbnail");
+    return false;
+  }
 
   if (needs_mask) {
     /* Create thumbnail mask (with all pixels solid) */
@@ -245,7 +353,7 @@ static bool make_transfer_thumbnail(MapTransfers *const transfers_data,
 
     /* Paint to thumbnail mask */
     DrawTiles_to_mask(&transfers_data->thumbnail_sprites,
-                      spr_name, MapAngle_North, &scr_area, read_transfer_tile,
+                      spr_name, MapAngle_North, &scr_area, read_transfer_tiles,
                       transfer, thumb_zoom);
   }
 
@@ -253,14 +361,16 @@ static bool make_transfer_thumbnail(MapTransfers *const transfers_data,
 }
 
 static bool make_thumbnails(MapTransfers *const transfers_data,
-  MapTexBitmaps *const textures)
+  MapTexBitmaps *const textures, int *const num_made)
 {
   assert(transfers_data);
   assert(textures);
+  assert(num_made);
 
   hourglass_on();
   int count = 0;
   bool success = true;
+  *num_made = 0;
 
   StrDictVIter iter;
   for (_Optional MapTransfer *transfer = strdictviter_all_init(&iter, &transfers_data->dict);
@@ -272,11 +382,17 @@ static bool make_thumbnails(MapTransfers *const transfers_data,
     }
     ++count;
 
+    if (transfer->has_thumbnail)
+    {
+      continue; /* got it from the cache */
+    }
+
     if (!make_transfer_thumbnail(transfers_data, &*transfer, textures))
     {
       success = false;
       break;
     }
+    ++*num_made;
   }
   hourglass_off();
 
@@ -292,6 +408,167 @@ static bool make_thumbnails(MapTransfers *const transfers_data,
   return success;
 }
 
+static _Optional FILE *open_cache(MapTransfers const *const transfers_data)
+{
+  /* The cache is only valid for the tile graphics used to make it */
+  assert(transfers_data);
+  if (!transfers_data->directory || !transfers_data->tiles_path) {
+    return NULL;
+  }
+
+  return PreComp_open(CACHE_DIR, pathtail(&*transfers_data->directory, 1),
+                      &*transfers_data->tiles_path, CACHE_FORMAT,
+                      DrawTilesModeNumber);
+}
+
+static _Optional CacheEntry *read_cache_entries(FILE *const file,
+  int *const count)
+{
+  assert(file);
+  assert(count);
+
+  int n;
+  if (fread(&n, sizeof(n), 1, file) != 1 || n <= 0 ||
+      (size_t)n > SIZE_MAX / sizeof(CacheEntry)) {
+    return NULL;
+  }
+
+  _Optional CacheEntry *const entries = malloc(sizeof(*entries) * (size_t)n);
+  if (!entries) {
+    return NULL;
+  }
+
+  if (fread(&*entries, sizeof(*entries), (size_t)n, file) != (size_t)n) {
+    free(entries);
+    return NULL;
+  }
+
+  for (int i = 0; i < n; ++i) {
+    entries[i].name[sizeof(entries[i].name) - 1] = '\0';
+  }
+
+  DEBUGF("Read %d cached transfer headers\n", n);
+  *count = n;
+  return entries;
+}
+
+static _Optional CacheEntry const *find_cache_entry(
+  CacheEntry const *const entries, int const count, int *const hint,
+  char const *const name, int const date[2])
+{
+  assert(entries);
+  assert(count > 0);
+  assert(hint);
+  assert(*hint >= 0);
+  assert(*hint < count);
+  assert(name);
+
+  /* Entries are likely to be found in the same order as they were written,
+     so start searching after the last one found */
+  for (int i = 0; i < count; ++i) {
+    int const index = (*hint + i) % count;
+    CacheEntry const *const entry = &entries[index];
+
+    if (stricmp(entry->name, name) == 0) {
+      if (memcmp(entry->date, date, sizeof(entry->date)) != 0 ||
+          entry->anim_count < 0 || entry->anim_count > AnimsMax) {
+        return NULL;
+      }
+      *hint = (index + 1) % count;
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static int discard_stale_thumbnails(MapTransfers *const transfers_data,
+  CacheEntry const *const entries, int const count)
+{
+  assert(transfers_data);
+  assert(entries);
+
+  StrDictVIter iter;
+  for (_Optional MapTransfer *transfer = strdictviter_all_init(&iter, &transfers_data->dict);
+       transfer != NULL;
+       transfer = strdictviter_advance(&iter)) {
+    transfer->has_thumbnail = false;
+  }
+
+  /* Keep only those thumbnails that match a transfer's current name, date
+     and dimensions */
+  int num_deleted = 0;
+  for (int i = 0; i < count; ++i) {
+    CacheEntry const *const entry = &entries[i];
+    _Optional MapTransfer *const transfer = strdict_find_value(
+                                  &transfers_data->dict, entry->name, NULL);
+
+    if (transfer &&
+        memcmp(entry->date, dfile_get_date(&transfer->dfile), sizeof(entry->date)) == 0 &&
+        entry->size_minus_one.x == transfer->size_minus_one.x &&
+        entry->size_minus_one.y == transfer->size_minus_one.y) {
+      transfer->has_thumbnail = true;
+    } else {
+      DEBUGF("Discarding cached thumbnail '%s'\n", entry->name);
+      SprMem_delete(&transfers_data->thumbnail_sprites, entry->name);
+      ++num_deleted;
+    }
+  }
+  return num_deleted;
+}
+
+static bool read_cached_thumbnails(MapTransfers *const transfers_data,
+  int *const num_deleted)
+{
+  assert(transfers_data);
+  assert(num_deleted);
+
+  bool success = false;
+  _Optional FILE *const file = open_cache(transfers_data);
+  if (file) {
+    int count = 0;
+    _Optional CacheEntry *const entries = read_cache_entries(&*file, &count);
+    if (entries) {
+      success = SprMem_read(&transfers_data->thumbnail_sprites, &*file);
+      if (success) {
+        *num_deleted = discard_stale_thumbnails(transfers_data, &*entries, count);
+      }
+      free(entries);
+    }
+    fclose(&*file);
+  }
+  return success;
+}
+
+static bool write_cache_cb(FILE *const file, void *const arg)
+{
+  MapTransfers *const transfers_data = arg;
+  assert(transfers_data);
+  assert(transfers_data->have_thumbnails);
+
+  int const count = transfers_data->count;
+  if (fwrite(&count, sizeof(count), 1, file) != 1) {
+    return false;
+  }
+
+  StrDictVIter iter;
+  for (_Optional MapTransfer *transfer = strdictviter_all_init(&iter, &transfers_data->dict);
+       transfer != NULL;
+       transfer = strdictviter_advance(&iter)) {
+    CacheEntry entry;
+    memset(&entry, 0, sizeof(entry)); /* don't write uninitialised padding */
+    STRCPY_SAFE(entry.name, get_leaf_name(&transfer->dfile));
+    memcpy(entry.date, dfile_get_date(&transfer->dfile), sizeof(entry.date));
+    entry.size_minus_one = transfer->size_minus_one;
+    entry.anim_count = transfer->anim_count;
+
+    if (fwrite(&entry, sizeof(entry), 1, file) != 1) {
+      return false;
+    }
+  }
+
+  return SprMem_write(&transfers_data->thumbnail_sprites, file);
+}
+
 static bool add_to_list(MapTransfers *const transfers_data,
   MapTransfer *const transfer, _Optional int *const index)
 {
@@ -407,19 +684,49 @@ static void write_anims(MapTransfer const *const transfer,
   }
 }
 
-static void destroy_all(MapTransfer *const transfer)
+static SFError read_row_runs(MapTransfer *const transfer,
+  Reader *const reader)
 {
   assert(transfer);
+  int const width = transfer->size_minus_one.x + 1;
+  int const height = transfer->size_minus_one.y + 1;
+  unsigned char const mask = map_ref_to_num(map_ref_mask());
+  SFError err = SFERROR(OK);
 
-  if (transfer->tiles)
+  nobudge_register(PREALLOC_SIZE);
+  for (int y = 0; y < height && !SFError_fail(err); ++y)
   {
-    flex_free(&transfer->tiles);
-  }
+    unsigned char *const row = (unsigned char *)transfer->tiles + (y * width);
+    for (int x = 0; x < width; )
+    {
+      int const skip = reader_fgetc(reader);
+      int const count = reader_fgetc(reader);
+      if (skip == EOF || count == EOF)
+      {
+        err = SFERROR(ReadFail);
+        break;
+      }
 
-  if (transfer->anims)
-  {
-    flex_free(&transfer->anims);
+      if ((skip == 0 && count == 0) || x + skip + count > width)
+      {
+        err = SFERROR(TransferSize);
+        break;
+      }
+
+      memset(row + x, mask, (size_t)skip);
+      x += skip;
+
+      if (count > 0 && !reader_fread(row + x, (size_t)count, 1, reader))
+      {
+        err = SFERROR(ReadFail);
+        break;
+      }
+      x += count;
+    }
   }
+  nobudge_deregister();
+
+  return err;
 }
 
 static bool alloc_transfer(MapTransfer *const transfer,
@@ -632,7 +939,7 @@ static SFError MapTransfer_read_cb(DFile const *const dfile,
     return SFERROR(ReadFail);
   }
 
-  if (version > TransferFormatVersion)
+  if (version > TransferFormatMaxReadable)
   {
     return SFERROR(TransferVer);
   }
@@ -655,7 +962,11 @@ static SFError MapTransfer_read_cb(DFile const *const dfile,
     DEBUG("Clearing flags byte");
   }
 
-  if (TEST_BITS(flags, ~TransferHasAnimations))
+  int const known_flags = version < TransferFormatWithRowRuns ?
+                          TransferHasAnimations :
+                          TransferHasAnimations | TransferHasRowRuns;
+
+  if (TEST_BITS(flags, ~known_flags))
   {
     return SFERROR(TransferFla);
   }
@@ -681,12 +992,19 @@ static SFError MapTransfer_read_cb(DFile const *const dfile,
 
   SFError err = SFERROR(OK);
 
-  nobudge_register(PREALLOC_SIZE);
-  if (!reader_fread(transfer->tiles, flex_size(&transfer->tiles), 1, reader))
+  if (TEST_BITS(flags, TransferHasRowRuns))
   {
-    err = SFERROR(ReadFail);
+    err = read_row_runs(transfer, reader);
+  }
+  else
+  {
+    nobudge_register(PREALLOC_SIZE);
+    if (!reader_fread(transfer->tiles, flex_size(&transfer->tiles), 1, reader))
+    {
+      err = SFERROR(ReadFail);
+    }
+    nobudge_deregister();
   }
-  nobudge_deregister();
 
   if (!SFError_fail(err) && TEST_BITS(flags, TransferHasAnimations))
   {
@@ -702,10 +1020,18 @@ static void MapTransfer_write_cb(DFile const *const dfile,
   assert(dfile);
   MapTransfer *const transfer = CONTAINER_OF(dfile, MapTransfer, dfile);
 
+  if (!ensure_body(transfer)) {
+    return;
+  }
+
+  /* Row runs are only read, so that files saved by this version remain
+     readable by older versions */
+  int const flags = transfer->anim_count > 0 ? TransferHasAnimations : 0;
+
   writer_fwrite(TRANSFER_TAG, sizeof(TRANSFER_TAG)-1, 1, writer);
   writer_fputc(TransferFormatVersion, writer);
   CoarsePoint2d_write(transfer->size_minus_one, writer);
-  writer_fputc(transfer->anim_count > 0 ? TransferHasAnimations : 0, writer);
+  writer_fputc(flags, writer);
 
   nobudge_register(PREALLOC_SIZE);
   writer_fwrite(transfer->tiles, flex_size(&transfer->tiles), 1, writer);
@@ -800,13 +1126,14 @@ void MapTransfers_init(MapTransfers *const transfers_data)
     .count = 0,
     .have_thumbnails = false,
     .directory = NULL,
+    .tiles_path = NULL,
   };
 
   strdict_init(&transfers_data->dict);
 }
 
 void MapTransfers_load_all(MapTransfers *const transfers_data,
-  char const *const tiles_set)
+  char const *const tiles_set, _Optional char const *const tiles_path)
 {
   DEBUG("Loading transfers for tiles set '%s'...", tiles_set);
   _Optional char *const dir = make_file_path_in_dir(Config_get_transfers_dir(), tiles_set);
@@ -818,12 +1145,25 @@ void MapTransfers_load_all(MapTransfers *const transfers_data,
   MapTransfers_init(transfers_data);
   transfers_data->directory = &*dir;
 
+  if (tiles_path) {
+    transfers_data->tiles_path = strdup(&*tiles_path);
+  }
+
   if (!file_exists(&*dir)) {
     return;
   }
 
   hourglass_on();
 
+  /* Avoid decompressing transfers merely to find their dimensions */
+  int cache_count = 0, cache_hint = 0;
+  _Optional CacheEntry *cache_entries = NULL;
+  _Optional FILE *const cache = open_cache(transfers_data);
+  if (cache) {
+    cache_entries = read_cache_entries(&*cache, &cache_count);
+    fclose(&*cache);
+  }
+
   _Optional DirIterator *iter = NULL;
   _Optional const _kernel_oserror *e = diriterator_make(&iter, 0, &*dir, NULL);
   int const expected_ftype = data_type_to_file_type(DataType_MapTransfer);
@@ -864,15 +1204,22 @@ void MapTransfers_load_all(MapTransfers *const transfers_data,
         break;
       }
 
-      if (report_error(load_compressed(&transfer->dfile, &*full_path), &*full_path, "")) {
+      int tmp[2] = {0};
+      memcpy(tmp, &info.date_stamp, sizeof(info.date_stamp));
+
+      _Optional CacheEntry const *const entry = cache_entries ?
+        find_cache_entry(&*cache_entries, cache_count, &cache_hint, filename, tmp) : NULL;
+
+      if (entry) {
+        /* The body will be loaded on first use */
+        transfer->size_minus_one = entry->size_minus_one;
+        transfer->anim_count = entry->anim_count;
+      } else if (report_error(load_compressed(&transfer->dfile, &*full_path), &*full_path, "")) {
         dfile_release(&transfer->dfile);
         free(full_path);
         break;
       }
 
-      int tmp[2] = {0};
-      memcpy(tmp, &info.date_stamp, sizeof(info.date_stamp));
-
       if (!dfile_set_saved(&transfer->dfile, &*full_path, tmp)) {
         report_error(SFERROR(NoMem), "", "");
         dfile_release(&transfer->dfile);
@@ -890,6 +1237,7 @@ void MapTransfers_load_all(MapTransfers *const transfers_data,
   }
 
   DEBUG("Number of transfers in list is %d", transfers_data->count);
+  free(cache_entries);
   diriterator_destroy(iter);
   hourglass_off();
 }
@@ -912,6 +1260,7 @@ void MapTransfers_free(MapTransfers *const transfers_data)
   strdict_destroy(&transfers_data->dict, free_all_cb, transfers_data);
 
   FREE_SAFE(transfers_data->directory);
+  FREE_SAFE(transfers_data->tiles_path);
 
   if (transfers_data->have_thumbnails) {
     SprMem_destroy(&transfers_data->thumbnail_sprites);
@@ -933,15 +1282,33 @@ bool MapTransfers_ensure_thumbnails(MapTransfers *const transfers_data,
   }
 
   DEBUG("Creating thumbnails of transfers for tile set %p", (void *)transfers_data);
-  if (!SprMem_init(&transfers_data->thumbnail_sprites, 0)) {
-    return false;
+  int num_deleted = 0;
+  if (!read_cached_thumbnails(transfers_data, &num_deleted)) {
+    StrDictVIter iter;
+    for (_Optional MapTransfer *transfer = strdictviter_all_init(&iter, &transfers_data->dict);
+         transfer != NULL;
+         transfer = strdictviter_advance(&iter)) {
+      transfer->has_thumbnail = false;
+    }
+
+    if (!SprMem_init(&transfers_data->thumbnail_sprites, 0)) {
+      return false;
+    }
   }
 
-  bool const success = make_thumbnails(transfers_data, textures);
+  int num_made = 0;
+  bool const success = make_thumbnails(transfers_data, textures, &num_made);
   if (!success) {
     SprMem_destroy(&transfers_data->thumbnail_sprites);
   } else {
     transfers_data->have_thumbnails = true;
+
+    if ((num_made > 0 || num_deleted > 0) && transfers_data->directory &&
+        transfers_data->tiles_path) {
+      PreComp_save(CACHE_DIR, pathtail(&*transfers_data->directory, 1),
+                   &*transfers_data->tiles_path, CACHE_FORMAT,
+                   DrawTilesModeNumber, write_cache_cb, transfers_data);
+    }
   }
 
   return success;
@@ -975,18 +1342,23 @@ _Optional MapTransfer *MapTransfers_grab_selection(const MapEditContext *const m
     return NULL;
   }
 
-  /* Copy selected tiles to transfer. It's tempting to use
-     MapEditSelection_for_each but we'd have to store the mask separately. */
-  MapAreaIter iter;
-  for (MapPoint p = MapAreaIter_get_first(&iter, &bounds);
-       !MapAreaIter_done(&iter);
-       p = MapAreaIter_get_next(&iter))
+  /* Mask the whole transfer and then copy only the selected tiles to it,
+     which is much faster for big sparse selections */
+  nobudge_register(PREALLOC_SIZE);
+  memset(transfer->tiles, map_ref_to_num(map_ref_mask()),
+         (size_t)flex_size(&transfer->tiles));
+  nobudge_deregister();
+
+  MapEditSelIter iter;
+  for (MapPoint p = MapEditSelIter_get_first(&iter, selected);
+       !MapEditSelIter_done(&iter);
+       p = MapEditSelIter_get_next(&iter))
   {
-    MapRef tile = map_ref_mask();
-    if (MapEditSelection_is_selected(selected, p)) {
-      tile = MapEdit_read_tile(map, p);
-    }
-    write_transfer_tile(&*transfer, MapPoint_sub(p, bounds.min), tile);
+    /* The selection's wrapped bounding box may contain the coordinates of
+       a tile even though those coordinates appear far outside it. */
+    write_transfer_tile(&*transfer,
+                        MapPoint_sub(map_coords_in_area(p, &bounds), bounds.min),
+                        MapEdit_read_tile(map, p));
   }
 
   int sel_count = 0;
@@ -1033,7 +1405,7 @@ _Optional MapTransfer *MapTransfers_grab_selection(const MapEditContext *const m
   return transfer;
 }
 
-static void for_each_area(MapTransfer *const transfer,
+static void find_areas(MapTransfer *const transfer,
   void (*callback)(void *, MapArea const *), void *cb_arg)
 {
   MapPoint const t_dims = MapTransfers_get_dims(transfer);
@@ -1053,7 +1425,7 @@ static void for_each_area(MapTransfer *const transfer,
 
     for (trans_pos.x = 0; trans_pos.x <= t_dims.x; trans_pos.x++) {
       MapRef const tile_ref = trans_pos.x < t_dims.x ?
-        read_transfer_tile(transfer, trans_pos).tile_ref : map_ref_mask();
+        read_transfer_tile(transfer, trans_pos) : map_ref_mask();
 
       if (map_ref_is_mask(tile_ref)) {
         if (start_x >= 0) {
@@ -1125,18 +1497,61 @@ static void for_each_area(MapTransfer *const transfer,
   }
 }
 
-typedef struct {
-  MapTransfer *transfer;
-  MapPoint offset;
-} ReadOffsetData;
+static void count_area_cb(void *const cb_arg, MapArea const *const t_subregion)
+{
+  NOT_USED(t_subregion);
+  int *const count = cb_arg;
+  ++*count;
+}
 
-static MapRef read_offset_transfer_tile(void *const cb_arg, MapPoint const trans_pos)
+static void store_area_cb(void *const cb_arg, MapArea const *const t_subregion)
 {
-  const ReadOffsetData *const data = cb_arg;
-  assert(data != NULL);
-  DrawTilesReadResult const value = read_transfer_tile(data->transfer, MapPoint_add(trans_pos, data->offset));
-  assert(!map_ref_is_mask(value.tile_ref));
-  return value.tile_ref;
+  MapTransfer *const transfer = cb_arg;
+  assert(transfer != NULL);
+  assert(transfer->area_count < flex_size(&transfer->areas) / (int)sizeof(MapArea));
+  ((MapArea *)transfer->areas)[transfer->area_count++] = *t_subregion;
+}
+
+static bool ensure_areas(MapTransfer *const transfer)
+{
+  /* The decomposition of a transfer into rectangles of non-mask tiles
+     is found once and reused every time the transfer is plotted */
+  if (!ensure_body(transfer)) {
+    return false;
+  }
+
+  if (transfer->areas) {
+    return true;
+  }
+
+  int count = 0;
+  find_areas(transfer, count_area_cb, &count);
+  DEBUGF("Transfer %p has %d areas\n", (void *)transfer, count);
+
+  if (!flex_alloc(&transfer->areas, (int)sizeof(MapArea) * HIGHEST(count, 1))) {
+    transfer->areas = NULL;
+    report_error(SFERROR(NoMem), "", "");
+    return false;
+  }
+
+  transfer->area_count = 0;
+  find_areas(transfer, store_area_cb, transfer);
+  assert(transfer->area_count == count);
+  return true;
+}
+
+static void for_each_area(MapTransfer *const transfer,
+  void (*callback)(void *, MapArea const *), void *cb_arg)
+{
+  if (!ensure_areas(transfer)) {
+    return;
+  }
+
+  for (int i = 0; i < transfer->area_count; ++i) {
+    /* Copy the area because the callback may move flex blocks */
+    MapArea const area = ((MapArea *)transfer->areas)[i];
+    callback(cb_arg, &area);
+  }
 }
 
 typedef struct {
@@ -1156,9 +1571,11 @@ static void plot_to_map_cb(void *const cb_arg, MapArea const *const t_subregion)
   MapArea map_area;
   MapArea_translate(t_subregion, data->t_pos_on_map, &map_area);
 
-  ReadOffsetData read_data = {data->transfer, t_subregion->min};
-  MapEdit_copy_to_area(data->map, &map_area, read_offset_transfer_tile,
-    &read_data, data->change_info);
+  /* Copy whole rows of the transfer instead of reading it tile by tile */
+  MapTransfer *const transfer = data->transfer;
+  MapEdit_copy_rows_to_area(data->map, &map_area, &transfer->tiles,
+    (size_t)uchar_offset(transfer, t_subregion->min),
+    (size_t)transfer->size_minus_one.x + 1, data->change_info);
 
   if (data->selection) {
     MapEditSelection_select_area(&*data->selection, &map_area);
@@ -1175,6 +1592,10 @@ bool MapTransfers_plot_to_map(const MapEditContext *const map,
   DEBUG("About to paste transfer %p at %" PRIMapCoord ",%" PRIMapCoord,
         (void *)transfer, bl.x, bl.y);
 
+  if (!ensure_body(transfer)) {
+    return false;
+  }
+
   // FIXME: check beforehand whether we can add the animations
   PlotToMapData data = {map, bl, transfer, selection, change_info};
   for_each_area(transfer, plot_to_map_cb, &data);
@@ -1275,6 +1696,10 @@ MapRef MapTransfers_read_ref(MapTransfer *const transfer, MapPoint const trans_p
     trans_pos.x, trans_pos.y,
     MapTransfers_get_dims(transfer).x, MapTransfers_get_dims(transfer).y);
 
+  if (!ensure_body(transfer)) {
+    return map_ref_mask();
+  }
+
   return map_ref_from_num(((unsigned char *)transfer->tiles)[uchar_offset(transfer, trans_pos)]);
 }
 
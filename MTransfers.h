@@ -40,8 +40,10 @@ int MapTransfers_get_count(
 bool MapTransfers_ensure_thumbnails(MapTransfers *transfers_data,
   MapTexBitmaps *textures);
 
+/* Thumbnails and dimensions of transfers are cached for the tile graphics
+   file at tiles_path (if any) */
 void MapTransfers_load_all(MapTransfers *transfers_data,
-  const char *tiles_set);
+  const char *tiles_set, _Optional const char *tiles_path);
 
 void MapTransfers_open_dir(MapTransfers const *transfers_data);
 
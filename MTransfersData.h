@@ -23,6 +23,7 @@ struct MapTransfers
   SprMem            thumbnail_sprites; /* flex anchor for sprite area */
   bool              have_thumbnails;
   _Optional char *directory;
+  _Optional char *tiles_path; /* identifies the tile graphics for caching */
 };
 
 #endif
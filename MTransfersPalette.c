@@ -206,7 +206,8 @@ static void reload(Editor *const editor)
   FilenamesData const *const filenames = Session_get_filenames(session);
   MapTex *const textures = Session_get_textures(session);
 
-  MapTransfers_load_all(&textures->transfers, filenames_get(filenames, DataType_MapTextures));
+  MapTransfers_load_all(&textures->transfers, filenames_get(filenames, DataType_MapTextures),
+                        dfile_get_name(&textures->dfile));
   Session_all_textures_changed(textures, EDITOR_CHANGE_TEX_TRANSFERS_RELOADED, &(EditorChangeParams){0});
 }
 
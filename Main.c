@@ -31,6 +31,7 @@
 
 #include "ParseArgs.h"
 #include "SFInit.h"
+#include "Journal.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -103,6 +104,9 @@ int main(int argc, char *argv[])
 
   parse_arguments(argc, argv);
 
+  /* Offer to restore changes that were not saved before a crash */
+  Journal_recover_all();
+
   /*
    * poll loop
    */
@@ -77,6 +77,27 @@ static inline size_t map_coords_to_index(MapPoint const pos)
   return (Map_Size * (size_t)map_wrap_coord(pos.y)) + (size_t)map_wrap_coord(pos.x);
 }
 
+static inline size_t map_span_before_wrap(MapPoint const pos,
+  MapPoint const step, size_t const count)
+{
+  /* How many cells (up to count) can be visited from pos by a unit step
+     along either axis before wrapping at a map edge */
+  assert((step.x == 0) != (step.y == 0));
+  MapPoint const wrapped = map_wrap_coords(pos);
+  MapCoord limit;
+  if (step.x != 0) {
+    limit = step.x > 0 ? Map_Size - wrapped.x : wrapped.x + 1;
+  } else {
+    limit = step.y > 0 ? Map_Size - wrapped.y : wrapped.y + 1;
+  }
+  return count < (size_t)limit ? count : (size_t)limit;
+}
+
+static inline long int map_index_stride(MapPoint const step)
+{
+  return step.x + (step.y * Map_Size);
+}
+
 static inline IntDictKey map_coords_to_key(MapPoint const pos)
 {
   size_t const index = map_coords_to_index(pos);
@@ -126,11 +147,12 @@ static inline bool map_ref_is_equal(MapRef const a, MapRef const b)
   return a.index == b.index;
 }
 
-static inline MapRef map_get_tile(MapData const *const map,
-  MapPoint const pos)
+static inline MapRef map_get_tile_at(MapData const *const map,
+  size_t const index)
 {
   assert(map);
-  unsigned char const value = ((unsigned char *)map->flex)[map_coords_to_index(pos)];
+  assert(index < Map_Size * Map_Size);
+  unsigned char const value = ((unsigned char *)map->flex)[index];
   /* If you're thinking of converting values here, don't! It's more
      efficient to do so when reading/writing the file. */
   MapRef const tile = map_ref_from_num(value);
@@ -138,6 +160,12 @@ static inline MapRef map_get_tile(MapData const *const map,
   return tile;
 }
 
+static inline MapRef map_get_tile(MapData const *const map,
+  MapPoint const pos)
+{
+  return map_get_tile_at(map, map_coords_to_index(pos));
+}
+
 static inline void map_set_tile(MapData const *const map,
   MapPoint const pos, MapRef const tile)
 {
@@ -25,16 +25,19 @@
 #include <limits.h>
 #include "stdlib.h"
 #include <math.h>
+#include <string.h>
 
 #include "Macros.h"
 #include "Debug.h"
 #include "Err.h"
 #include "Hourglass.h"
 #include "msgtrans.h"
+#include "NoBudge.h"
 
 #include "Utils.h"
 #include "MapEdit.h"
 #include "MapAnims.h"
+#include "MapAreaCol.h"
 #include "MapCoord.h"
 #include "MapEditChg.h"
 #include "MapEditSel.h"
@@ -42,11 +45,17 @@
 #include "MapEditCtx.h"
 #include "Smooth.h"
 #include "Map.h"
+#include "MapFlat.h"
+#include "Instrument.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
 #endif
 
+enum {
+  PreExpandHeap = 512,
+};
+
 /* ---------------- Private functions ---------------- */
 
 static _Optional MapData *get_write_map(MapEditContext const *const map)
@@ -71,6 +80,10 @@ static MapRef read_overlay_core(MapEditContext const *const map,
 static MapRef read_tile_core(MapEditContext const *const map,
   MapPoint const pos)
 {
+  if (map->flat) {
+    return MapFlat_read_tile(&*map->flat, map, pos);
+  }
+
   MapRef tile = read_overlay_core(map, pos);
   if (map_ref_is_mask(tile) && map->base != NULL) {
     tile = map_get_tile(&*map->base, pos); /* read from base map */
@@ -79,20 +92,89 @@ static MapRef read_tile_core(MapEditContext const *const map,
   return tile;
 }
 
-static void write_tile_core(MapData *const map, MapPoint const pos,
-  MapRef const tile_num, _Optional MapEditChanges *const change_info,
-  MapArea *const redraw_area)
+static void read_span_core(MapData const *const map, MapPoint const pos,
+  MapPoint const step, size_t const count, MapRef *const tiles,
+  bool const masked_only)
+{
+  assert(map);
+  assert(tiles);
+
+  long int const stride = map_index_stride(step);
+  MapPoint span_pos = pos;
+
+  /* Split the span where it wraps at the map edge */
+  for (size_t done = 0; done < count; ) {
+    size_t const n = map_span_before_wrap(span_pos, step, count - done);
+    unsigned char const *src = (unsigned char *)map->flex + map_coords_to_index(span_pos);
+
+    for (size_t i = done; i < done + n; ++i, src += stride) {
+      if (!masked_only || map_ref_is_mask(tiles[i])) {
+        tiles[i] = map_ref_from_num(*src);
+        assert(map_ref_is_valid(map, tiles[i]));
+      }
+    }
+    done += n;
+    span_pos = MapPoint_add(span_pos, MapPoint_mul(step, (MapPoint){(MapCoord)n, (MapCoord)n}));
+  }
+}
+
+static void write_tile_core(MapEditContext const *const map,
+  MapData *const gmap, MapPoint const pos, MapRef const tile_num,
+  _Optional MapEditChanges *const change_info, MapArea *const redraw_area)
 {
   assert(map_coords_in_range(pos));
 
-  if (map_ref_is_equal(map_update_tile(map, pos, tile_num), tile_num)) {
+  if (map_ref_is_equal(map_update_tile(gmap, pos, tile_num), tile_num)) {
     return;
   }
 
+  if (map->flat) {
+    MapFlat_update(&*map->flat, map, &(MapArea){pos, pos});
+  }
+
   MapArea_expand(redraw_area, pos);
   MapEditChanges_change_tile(change_info);
 }
 
+static void copy_row_core(MapEditContext const *const map,
+  MapData *const gmap, MapPoint const pos, unsigned char const *const src,
+  MapCoord const n, _Optional MapEditChanges *const change_info,
+  MapArea *const redraw_area)
+{
+  /* The row must not wrap around the edge of the map */
+  assert(map_coords_in_range(pos));
+  assert(n > 0);
+  assert(pos.x + n <= Map_Size);
+
+  unsigned char *const dst = (unsigned char *)gmap->flex + map_coords_to_index(pos);
+  if (!memcmp(dst, src, (size_t)n)) {
+    return;
+  }
+
+  MapCoord first = -1, last = -1;
+  unsigned long int nchanged = 0;
+  for (MapCoord x = 0; x < n; ++x) {
+    if (dst[x] != src[x]) {
+      assert(map_ref_is_valid(gmap, map_ref_from_num(src[x])));
+      if (first < 0) {
+        first = x;
+      }
+      last = x;
+      ++nchanged;
+    }
+  }
+  memcpy(dst, src, (size_t)n);
+
+  MapArea const changed = {{pos.x + first, pos.y}, {pos.x + last, pos.y}};
+  if (map->flat) {
+    MapFlat_update(&*map->flat, map, &changed);
+  }
+
+  MapArea_expand(redraw_area, changed.min);
+  MapArea_expand(redraw_area, changed.max);
+  MapEditChanges_change_tiles(change_info, nchanged);
+}
+
 static void reverse_anim(MapAnimParam *const param)
 {
   /* Reverse the order of frames within animation */
@@ -187,11 +269,21 @@ static void fill_core(MapEditContext const *const map,
        !MapAreaIter_done(&iter);
        p = MapAreaIter_get_next(&iter))
   {
-    write_tile_core(&*gmap, map_wrap_coords(p), tile_num, change_info,
+    write_tile_core(map, &*gmap, map_wrap_coords(p), tile_num, change_info,
                     redraw_area);
   }
 }
 
+static bool update_flat_cb(MapArea const *const area, void *const arg)
+{
+  MapEditContext const *const map = arg;
+  assert(map);
+  assert(map->flat);
+
+  MapFlat_update(&*map->flat, map, area);
+  return false; /* continue */
+}
+
 static void do_redraw(MapEditContext const *const map, MapArea const *const redraw_area)
 {
   assert(map);
@@ -285,6 +377,7 @@ void MapEdit_fill_selection(MapEditContext const *const map,
     return;
   }
 
+  INSTRUMENT_START(Edit);
   MapArea redraw_area = MapArea_make_invalid();
 
   MapEditSelIter iter;
@@ -293,11 +386,12 @@ void MapEdit_fill_selection(MapEditContext const *const map,
        p = MapEditSelIter_get_next(&iter))
   {
     wipe_anim(map, p, change_info);
-    write_tile_core(&*gmap, map_wrap_coords(p), tile,
+    write_tile_core(map, &*gmap, map_wrap_coords(p), tile,
       change_info, &redraw_area);
   }
 
   do_redraw(map, &redraw_area);
+  INSTRUMENT_STOP(Edit);
 }
 
 void MapEdit_smooth_selection(MapEditContext const *const map,
@@ -305,6 +399,7 @@ void MapEdit_smooth_selection(MapEditContext const *const map,
                               MapTexGroups *const groups_data,
                               _Optional MapEditChanges *const change_info)
 {
+  INSTRUMENT_START(Edit);
   MapEditSelIter iter;
   for (MapPoint p = MapEditSelIter_get_first(&iter, selected);
        !MapEditSelIter_done(&iter);
@@ -312,6 +407,7 @@ void MapEdit_smooth_selection(MapEditContext const *const map,
   {
     MapTexGroups_smooth(map, groups_data, p, change_info);
   }
+  INSTRUMENT_STOP(Edit);
 }
 
 void MapEdit_crop_overlay(MapEditContext const *const map,
@@ -343,6 +439,7 @@ void MapEdit_crop_overlay(MapEditContext const *const map,
       DEBUG("Cropping overlay location at %" PRIMapCoord ",%" PRIMapCoord,
         p.x, p.y);
 
+      /* The flattened map is unchanged because the same tile shows through */
       map_set_tile(&*map->overlay, p, map_ref_mask());
       MapArea_expand(&redraw_area, p);
       MapEditChanges_change_tile(change_info);
@@ -439,6 +536,22 @@ void MapEdit_plot_line(MapEditContext const *const map, MapPoint const start,
   do_redraw(map, &context.redraw_area);
 }
 
+void MapEdit_plot_stroke(MapEditContext const *const map,
+                         ShapesStroke *const stroke, MapPoint const start,
+                         MapPoint const end, MapRef const tile,
+                         MapCoord const thickness,
+                         _Optional MapEditChanges *const change_info)
+{
+  WriteShapeContext context = {
+    .map = map,
+    .tile_num = tile,
+    .change_info = change_info,
+    .redraw_area = MapArea_make_invalid(),
+  };
+  Shapes_stroke(stroke, plot_shape, &context, start, end, thickness);
+  do_redraw(map, &context.redraw_area);
+}
+
 void MapEdit_global_replace(MapEditContext const *const map,
                             MapRef const find, MapRef const replace,
                             _Optional MapEditChanges *const change_info)
@@ -461,6 +574,8 @@ void MapEdit_global_replace(MapEditContext const *const map,
     return;
   }
 
+  INSTRUMENT_START(Edit);
+
   MapAreaIter iter;
   for (MapPoint p = map_get_first(&iter);
        !MapAreaIter_done(&iter);
@@ -468,7 +583,7 @@ void MapEdit_global_replace(MapEditContext const *const map,
   {
     MapRef const tile = read_tile_core(map, p);
     if (map_ref_is_equal(tile, find)) {
-      write_tile_core(&*write_map, p, replace, change_info, &redraw_area);
+      write_tile_core(map, &*write_map, p, replace, change_info, &redraw_area);
     }
   }
 
@@ -490,6 +605,7 @@ void MapEdit_global_replace(MapEditContext const *const map,
   }
 
   do_redraw(map, &redraw_area);
+  INSTRUMENT_STOP(Edit);
 }
 
 void MapEdit_flood_fill(MapEditContext const *const map,
@@ -511,12 +627,14 @@ void MapEdit_flood_fill(MapEditContext const *const map,
     .redraw_area = MapArea_make_invalid(),
   };
 
+  INSTRUMENT_START(Edit);
   hourglass_on();
   bool const success = Shapes_flood(read_shape, plot_shape, &context,
                                     map_ref_to_num(find), pos, Map_Size);
   hourglass_off();
 
   do_redraw(map, &context.redraw_area);
+  INSTRUMENT_STOP(Edit);
 
   if (!success)
   {
@@ -564,13 +682,64 @@ void MapEdit_copy_to_area(MapEditContext const *const map,
        p = MapAreaIter_get_next(&iter))
   {
     MapRef const tile = read(cb_arg, MapPoint_sub(p, area->min));
+    INSTRUMENT_COUNT(Callbacks, 1);
     assert(map->overlay || !map_ref_is_mask(tile));
-    write_tile_core(&*gmap, map_wrap_coords(p), tile, change_info, &redraw_area);
+    write_tile_core(map, &*gmap, map_wrap_coords(p), tile, change_info, &redraw_area);
   }
 
   do_redraw(map, &redraw_area);
 }
 
+void MapEdit_copy_rows_to_area(MapEditContext const *const map,
+                               MapArea const *const area, void **const src,
+                               size_t const offset, size_t const stride,
+                               _Optional MapEditChanges *const change_info)
+{
+  assert(map != NULL);
+  assert(MapArea_is_valid(area));
+  assert(src);
+
+  MapCoord const width = area->max.x - area->min.x + 1;
+  assert(width <= Map_Size);
+  assert((size_t)width <= stride);
+
+  if (map->prechange_cb) {
+    map->prechange_cb(area, map->session);
+  }
+
+  wipe_anims(map, area, change_info);
+
+  _Optional MapData *const gmap = get_write_map(map);
+  assert(gmap);
+  if (!gmap) {
+    return;
+  }
+
+  MapArea redraw_area = MapArea_make_invalid();
+
+  /* Rows that cross the edge of the map are split in two */
+  MapCoord const start_x = map_wrap_coord(area->min.x);
+  MapCoord const first_width = LOWEST(width, Map_Size - start_x);
+
+  nobudge_register(PreExpandHeap);
+  for (MapCoord y = area->min.y; y <= area->max.y; ++y) {
+    unsigned char const *const row = (unsigned char *)*src + offset +
+                                     ((size_t)(y - area->min.y) * stride);
+    MapCoord const wrapped_y = map_wrap_coord(y);
+
+    copy_row_core(map, &*gmap, (MapPoint){start_x, wrapped_y}, row,
+                  first_width, change_info, &redraw_area);
+
+    if (first_width < width) {
+      copy_row_core(map, &*gmap, (MapPoint){0, wrapped_y}, row + first_width,
+                    width - first_width, change_info, &redraw_area);
+    }
+  }
+  nobudge_deregister();
+
+  do_redraw(map, &redraw_area);
+}
+
 void MapEdit_write_tile(MapEditContext const *const map, MapPoint const pos,
                         MapRef const tile_num,
                         _Optional MapEditChanges *const change_info)
@@ -594,7 +763,7 @@ void MapEdit_write_tile(MapEditContext const *const map, MapPoint const pos,
     return;
   }
 
-  write_tile_core(&*gmap, map_wrap_coords(pos), tile_num,
+  write_tile_core(map, &*gmap, map_wrap_coords(pos), tile_num,
     change_info, &redraw_area);
 
   do_redraw(map, &redraw_area);
@@ -616,6 +785,36 @@ MapRef MapEdit_read_overlay(MapEditContext const *const map, MapPoint const pos)
   return read_overlay_core(map, map_wrap_coords(pos));
 }
 
+void MapEdit_read_tiles(MapEditContext const *const map, MapPoint const pos,
+  MapPoint const step, size_t const count, MapRef *const tiles)
+{
+  assert(map != NULL);
+  if (map->flat) {
+    MapFlat_read_tiles(&*map->flat, map, pos, step, count, tiles);
+    return;
+  }
+
+  MapEdit_read_overlays(map, pos, step, count, tiles);
+  if (map->base != NULL) {
+    read_span_core(&*map->base, pos, step, count, tiles, map->overlay != NULL);
+  }
+}
+
+void MapEdit_read_overlays(MapEditContext const *const map, MapPoint const pos,
+  MapPoint const step, size_t const count, MapRef *const tiles)
+{
+  assert(map != NULL);
+  assert(tiles);
+
+  if (map->overlay != NULL) {
+    read_span_core(&*map->overlay, pos, step, count, tiles, false);
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      tiles[i] = map_ref_mask();
+    }
+  }
+}
+
 bool MapEdit_write_anim(MapEditContext const *const map,
                         MapPoint const map_pos, MapAnimParam const param,
                         _Optional MapEditChanges *const change_info)
@@ -662,7 +861,7 @@ void MapEdit_anims_to_map(MapEditContext const *const map,
     MapRef const tile_num = MapAnimsIter_get_current(&iter);
     if (!map_ref_is_mask(tile_num) &&
         !map_ref_is_equal(tile_num, read_tile_core(map, p))) {
-      write_tile_core(&*gmap, p, tile_num, change_info, &redraw_area);
+      write_tile_core(map, &*gmap, p, tile_num, change_info, &redraw_area);
     }
   }
 
@@ -695,7 +894,25 @@ SchedulerTime MapEdit_update_anims(MapEditContext const *const map,
     return SchedulerTime_Max;
   }
 
-  return MapAnims_update(&*anims, &*write_map, steps_to_advance, redraw_map);
+  SchedulerTime const next = MapAnims_update(&*anims, &*write_map,
+                                             steps_to_advance, redraw_map);
+
+  /* Animations write straight to the map, so the flattened map can only
+     be kept up to date if we are told which locations were changed */
+  if (map->flat) {
+    if (redraw_map) {
+      MapAreaColIter iter;
+      for (_Optional MapArea const *area = MapAreaColIter_get_first(&iter, &*redraw_map);
+           area != NULL;
+           area = MapAreaColIter_get_next(&iter)) {
+        (void)map_split_area(&*area, update_flat_cb, (void *)map);
+      }
+    } else {
+      MapFlat_invalidate(&*map->flat);
+    }
+  }
+
+  return next;
 }
 
 size_t MapEdit_count_anims(MapEditContext const *const map)
@@ -25,6 +25,7 @@ struct MapEditSelection;
 struct MapEditChanges;
 struct MapTexGroups;
 struct MapAreaColData;
+struct ShapesStroke;
 
 void MapEdit_reverse_selected(MapEditContext const *map,
                               struct MapEditSelection *selected,
@@ -67,10 +68,23 @@ void MapEdit_plot_line(MapEditContext const *map, MapPoint start,
                        MapPoint end, MapRef tile, MapCoord thickness,
                        _Optional struct MapEditChanges *change_info);
 
+void MapEdit_plot_stroke(MapEditContext const *map, struct ShapesStroke *stroke,
+                         MapPoint start, MapPoint end, MapRef tile,
+                         MapCoord thickness,
+                         _Optional struct MapEditChanges *change_info);
+
 MapRef MapEdit_read_tile(MapEditContext const *map, MapPoint map_pos);
 
 MapRef MapEdit_read_overlay(MapEditContext const *map, MapPoint map_pos);
 
+/* Read count tiles starting at map_pos, moving by a unit step along
+   either axis (wrapping at the map edges) between tiles. */
+void MapEdit_read_tiles(MapEditContext const *map, MapPoint map_pos,
+  MapPoint step, size_t count, MapRef *tiles);
+
+void MapEdit_read_overlays(MapEditContext const *map, MapPoint map_pos,
+  MapPoint step, size_t count, MapRef *tiles);
+
 void MapEdit_write_tile(MapEditContext const *map, MapPoint map_pos,
   MapRef tile_num, _Optional struct MapEditChanges *change_info);
 
@@ -103,6 +117,14 @@ void MapEdit_copy_to_area(MapEditContext const *map,
                           MapEditReadFn *read, void *cb_arg,
                           _Optional struct MapEditChanges *change_info);
 
+/* Copies rows of tile numbers from a flex block to an area of the map.
+   The first row starts at the given offset and each row is 'stride' bytes
+   long. The area may wrap around the edges of the map. */
+void MapEdit_copy_rows_to_area(MapEditContext const *map,
+                               MapArea const *area, void **src,
+                               size_t offset, size_t stride,
+                               _Optional struct MapEditChanges *change_info);
+
 bool MapEdit_check_tile_range(MapEditContext const *map,
   size_t num_tiles);
 
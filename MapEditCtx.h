@@ -13,6 +13,7 @@
 
 struct EditSession;
 struct MapArea;
+struct MapFlat;
 
 typedef void MapEditPreChangeFn(struct MapArea const *, struct EditSession *),
              MapEditRedrawFn(struct MapArea const *, struct EditSession *);
@@ -24,6 +25,7 @@ struct MapEditContext
   _Optional struct ConvAnimations *anims; /* (Mission only) */
   _Optional MapEditPreChangeFn *prechange_cb;
   _Optional MapEditRedrawFn *redraw_cb;
+  _Optional struct MapFlat *flat; /* maintained on write, if any */
   struct EditSession *session;
 };
 
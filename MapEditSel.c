@@ -542,6 +542,37 @@ bool MapEditSelection_is_selected(MapEditSelection const *const selection,
   return is_selected(selection, map_wrap_coords(pos));
 }
 
+void MapEditSelection_read_span(MapEditSelection const *const selection,
+  MapPoint const pos, MapPoint const step, size_t const count,
+  bool *const is_selected)
+{
+  assert(selection);
+  assert(is_selected);
+
+  if (MapEditSelection_is_none(selection)) {
+    for (size_t i = 0; i < count; ++i) {
+      is_selected[i] = false;
+    }
+    return;
+  }
+
+  unsigned char const *const flags = selection->flex;
+  long int const stride = map_index_stride(step);
+  MapPoint span_pos = pos;
+
+  /* Split the span where it wraps at the map edge */
+  for (size_t done = 0; done < count; ) {
+    size_t const n = map_span_before_wrap(span_pos, step, count - done);
+    size_t index = map_coords_to_index(span_pos);
+
+    for (size_t i = done; i < done + n; ++i, index += (size_t)stride) {
+      is_selected[i] = flags[index / CHAR_BIT] & (1u << (index % CHAR_BIT));
+    }
+    done += n;
+    span_pos = MapPoint_add(span_pos, MapPoint_mul(step, (MapPoint){(MapCoord)n, (MapCoord)n}));
+  }
+}
+
 void MapEditSelection_clear(MapEditSelection *const selection)
 {
   validate_selection(selection);
@@ -70,6 +70,9 @@ void MapEditSelection_invert_area(MapEditSelection *selection,
 bool MapEditSelection_is_selected(
   MapEditSelection const *selection, MapPoint pos);
 
+void MapEditSelection_read_span(MapEditSelection const *selection,
+  MapPoint pos, MapPoint step, size_t count, bool *is_selected);
+
 static inline bool MapEditSelection_is_none(
   MapEditSelection const *const selection)
 {
@@ -0,0 +1,156 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Ground map with the overlay flattened onto the base map
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "stdlib.h"
+
+#include "Macros.h"
+#include "Debug.h"
+
+#include "MapCoord.h"
+#include "Map.h"
+#include "MapEdit.h"
+#include "MapEditCtx.h"
+#include "MapFlat.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+struct MapFlat {
+  bool is_valid;
+  unsigned char tiles[Map_Area]; /* tile number shown at each location */
+};
+
+/* ---------------- Private functions ---------------- */
+
+static unsigned char resolve(MapEditContext const *const map, size_t const index)
+{
+  MapRef tile = map_ref_mask();
+  if (map->overlay) {
+    tile = map_get_tile_at(&*map->overlay, index);
+  }
+  if (map_ref_is_mask(tile) && map->base) {
+    tile = map_get_tile_at(&*map->base, index);
+  }
+  return map_ref_to_num(tile);
+}
+
+static void rebuild(MapFlat *const flat, MapEditContext const *const map)
+{
+  DEBUG("Rebuilding flattened ground map");
+
+  if (!map->overlay && map->base) {
+    MapData const *const base = &*map->base;
+    memcpy(flat->tiles, base->flex, sizeof(flat->tiles));
+  } else {
+    for (size_t index = 0; index < ARRAY_SIZE(flat->tiles); ++index) {
+      flat->tiles[index] = resolve(map, index);
+    }
+  }
+
+  flat->is_valid = true;
+}
+
+static void ensure_valid(MapFlat *const flat, MapEditContext const *const map)
+{
+  assert(flat);
+  assert(map);
+
+  if (!flat->is_valid) {
+    rebuild(flat, map);
+  }
+}
+
+/* ---------------- Public functions ---------------- */
+
+_Optional MapFlat *MapFlat_create(void)
+{
+  _Optional MapFlat *const flat = malloc(sizeof(*flat));
+  if (flat) {
+    flat->is_valid = false;
+  }
+  return flat;
+}
+
+void MapFlat_destroy(_Optional MapFlat *const flat)
+{
+  free(flat);
+}
+
+void MapFlat_invalidate(MapFlat *const flat)
+{
+  assert(flat);
+  flat->is_valid = false;
+}
+
+void MapFlat_update(MapFlat *const flat, MapEditContext const *const map,
+  MapArea const *const area)
+{
+  assert(flat);
+  assert(map);
+  assert(MapArea_is_valid(area));
+  assert(map_coords_in_range(area->min));
+  assert(map_coords_in_range(area->max));
+
+  if (!flat->is_valid) {
+    return; /* will be rebuilt on next use */
+  }
+
+  for (MapCoord y = area->min.y; y <= area->max.y; ++y) {
+    for (MapCoord x = area->min.x; x <= area->max.x; ++x) {
+      size_t const index = map_coords_to_index((MapPoint){x, y});
+      flat->tiles[index] = resolve(map, index);
+    }
+  }
+}
+
+MapRef MapFlat_read_tile(MapFlat *const flat, MapEditContext const *const map,
+  MapPoint const map_pos)
+{
+  ensure_valid(flat, map);
+  return map_ref_from_num(flat->tiles[map_coords_to_index(map_pos)]);
+}
+
+void MapFlat_read_tiles(MapFlat *const flat, MapEditContext const *const map,
+  MapPoint const map_pos, MapPoint const step, size_t const count,
+  MapRef *const tiles)
+{
+  assert(tiles);
+  ensure_valid(flat, map);
+
+  long int const stride = map_index_stride(step);
+  MapPoint span_pos = map_pos;
+
+  /* Split the span where it wraps at the map edge */
+  for (size_t done = 0; done < count; ) {
+    size_t const n = map_span_before_wrap(span_pos, step, count - done);
+    unsigned char const *src = flat->tiles + map_coords_to_index(span_pos);
+
+    for (size_t i = done; i < done + n; ++i, src += stride) {
+      tiles[i] = map_ref_from_num(*src);
+    }
+    done += n;
+    span_pos = MapPoint_add(span_pos, MapPoint_mul(step, (MapPoint){(MapCoord)n, (MapCoord)n}));
+  }
+}
@@ -0,0 +1,44 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Ground map with the overlay flattened onto the base map
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef MapFlat_h
+#define MapFlat_h
+
+#include <stddef.h>
+
+#include "MapCoord.h"
+#include "Map.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+struct MapEditContext;
+
+typedef struct MapFlat MapFlat;
+
+/* The tile shown at each location of the ground map: the overlay tile
+   unless it is masked, otherwise the base tile. It is built on first use,
+   updated by writes through the owning editing context and must be
+   invalidated whenever either layer is replaced. */
+_Optional MapFlat *MapFlat_create(void);
+void MapFlat_destroy(_Optional MapFlat *flat);
+
+void MapFlat_invalidate(MapFlat *flat);
+
+/* Recalculates an area that does not wrap around the edges of the map. */
+void MapFlat_update(MapFlat *flat, struct MapEditContext const *map,
+  MapArea const *area);
+
+MapRef MapFlat_read_tile(MapFlat *flat, struct MapEditContext const *map,
+  MapPoint map_pos);
+
+/* Read count tiles starting at map_pos, moving by a unit step along
+   either axis (wrapping at the map edges) between tiles. */
+void MapFlat_read_tiles(MapFlat *flat, struct MapEditContext const *map,
+  MapPoint map_pos, MapPoint step, size_t count, MapRef *tiles);
+
+#endif
@@ -85,6 +85,24 @@ MapPoint MapLayout_derotate_scr_coords_to_map(MapAngle const angle, MapPoint con
   return pos;
 }
 
+MapPoint MapLayout_derotate_scr_row_step(MapAngle const angle)
+{
+  /* Change in map coordinates for each step along a row of screen
+     coordinates, to avoid derotating the coordinates of every cell */
+  switch (angle) {
+  case MapAngle_Count:
+  case MapAngle_North:
+    break;
+  case MapAngle_East:
+    return (MapPoint){0, -1};
+  case MapAngle_South:
+    return (MapPoint){-1, 0};
+  case MapAngle_West:
+    return (MapPoint){0, 1};
+  }
+  return (MapPoint){1, 0};
+}
+
 static MapArea swap_area_limits_for_rot(MapAngle const angle, MapArea const *const area)
 {
   /* Just ensure the correct order of minimum and maximum coordinates. */
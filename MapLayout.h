@@ -21,6 +21,7 @@ MapArea MapLayout_map_area_to_centre(struct View const *view, MapArea const *are
 
 /* Screen coordinates to map coordinates */
 MapPoint MapLayout_derotate_scr_coords_to_map(MapAngle angle, MapPoint pos);
+MapPoint MapLayout_derotate_scr_row_step(MapAngle angle);
 MapPoint MapLayout_map_coords_from_fine(struct View const *view, MapPoint pos);
 MapPoint MapLayout_map_coords_up_from_fine(struct View const *view, MapPoint pos);
 MapPoint MapLayout_scr_coords_from_fine(struct View const *view, MapPoint pos);
@@ -87,6 +87,7 @@
 #include "DFileUtils.h"
 #include "IntDict.h"
 #include "MapLayout.h"
+#include "MapOverview.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -118,9 +119,11 @@ typedef struct
   MapEditChanges change_info; /* for accumulation */
   PendingShape pending_shape;
   _Optional MapTransfer *pending_transfer, *pending_paste, *pending_drop, *dragged;
-  bool uk_drop_pending:1, lock_selection:1;
+  bool uk_drop_pending:1, lock_selection:1,
+       pending_is_solid:1, drop_is_solid:1; /* transfer has no masked locations */
   MapSnakesContext snake_ctx;
   MapPropDboxes prop_dboxes;
+  ShapesStroke stroke; /* cells already painted by the brush */
 }
 MapModeData;
 
@@ -393,8 +396,9 @@ static void draw_chequered(Editor *const editor, MapAngle const angle,
     .min_os = Vertex_add(min_os, draw_min),
   };
 
-  DrawTiles_to_bbox(angle, scr_area, draw_chequered_read, &data, draw_chequered_bbox,
-    &data, tile_size);
+  DrawTilesCellReader reader = {draw_chequered_read, &data};
+  DrawTiles_to_bbox(angle, scr_area, DrawTiles_read_cells, &reader,
+    draw_chequered_bbox, &data, tile_size);
 }
 
 static _Optional MapEditSelection *get_selection(Editor *const editor)
@@ -505,23 +509,56 @@ typedef struct {
   _Optional MapEditSelection *selection;
 } RedrawToSpriteData;
 
-static DrawTilesReadResult read_map(void *const cb_arg, MapPoint const map_pos)
+static void read_selection(RedrawToSpriteData const *const data,
+  MapPoint const map_pos, MapPoint const step, size_t const count,
+  bool *const is_selected)
+{
+  if (data->selection) {
+    MapEditSelection_read_span(&*data->selection, map_pos, step, count, is_selected);
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      is_selected[i] = false;
+    }
+  }
+}
+
+static void read_map(void *const cb_arg, MapPoint const map_pos,
+  MapPoint const step, size_t const count, MapRef *const tile_refs,
+  bool *const is_selected)
 {
   assert(cb_arg);
   RedrawToSpriteData const *const data = cb_arg;
-  return (DrawTilesReadResult){
-    MapEdit_read_tile(&data->read_map_data, map_pos),
-    data->selection ? MapEditSelection_is_selected(&*data->selection, map_pos) : false,
-  };
+  MapEdit_read_tiles(&data->read_map_data, map_pos, step, count, tile_refs);
+  read_selection(data, map_pos, step, count, is_selected);
 }
 
-static DrawTilesReadResult read_overlay(void *const cb_arg, MapPoint const map_pos)
+static void read_overlay(void *const cb_arg, MapPoint const map_pos,
+  MapPoint const step, size_t const count, MapRef *const tile_refs,
+  bool *const is_selected)
 {
   assert(cb_arg);
   RedrawToSpriteData const *const data = cb_arg;
-  return (DrawTilesReadResult){
-    MapEdit_read_overlay(&data->read_map_data, map_pos),
-    data->selection ? MapEditSelection_is_selected(&*data->selection, map_pos) : false};
+  MapEdit_read_overlays(&data->read_map_data, map_pos, step, count, tile_refs);
+  read_selection(data, map_pos, step, count, is_selected);
+}
+
+static _Optional MapOverview *get_overview(Editor *const editor,
+  int const zoom, MapEditContext const *const read_map_data)
+{
+  /* The overview can only stand in for the tiles if there is one pixel
+     per tile and everything in it would also be drawn */
+  if (zoom < MapTexSizeLog2) {
+    return NULL;
+  }
+
+  EditSession *const session = Editor_get_session(editor);
+  MapEditContext const *const map = Session_get_map(session);
+  if (!read_map_data->base || read_map_data->base != map->base ||
+      read_map_data->overlay != map->overlay) {
+    return NULL;
+  }
+
+  return Session_get_overview(session);
 }
 
 static bool draw_to_sprite(Editor *const editor,
@@ -534,12 +571,22 @@ static bool draw_to_sprite(Editor *const editor,
   if (!SprMem_create_sprite(sm, "RenderBuffer", false, sprite_dims, DrawTilesModeNumber))
     return false;
 
+  _Optional MapOverview *const overview = get_overview(editor, zoom, &data->read_map_data);
+  if (overview) {
+    /* No mask is needed because there is a base map */
+    DEBUG("Copying render buffer from map overview");
+    return MapOverview_to_sprite(&*overview, sm, "RenderBuffer", angle, rot_area, 0,
+                                 data->selection, EditWin_get_sel_colours(edit_win));
+  }
+
   EditSession *const session = Editor_get_session(editor);
   MapTex *const textures = Session_get_textures(session);
 
-  bool const needs_mask = DrawTiles_to_sprite(&textures->tiles, sm, "RenderBuffer",
-    angle, rot_area, data->read_map_data.base ? read_map : read_overlay, data,
-    zoom, EditWin_get_sel_colours(edit_win));
+  bool needs_mask = false;
+  if (!DrawTiles_to_sprite(&textures->tiles, sm, "RenderBuffer",
+        angle, rot_area, data->read_map_data.base ? read_map : read_overlay, data,
+        zoom, EditWin_get_sel_colours(edit_win), &needs_mask))
+    return false;
 
   if (needs_mask) {
     DEBUG("Creating render buffer mask");
@@ -677,15 +724,57 @@ static void MapMode_wipe_ghost(Editor *const editor)
   mode_data->pending_transfer = NULL;
 }
 
+#if !PENDING_IS_SELECTED
+static void move_ghost(Editor *const editor, MapArea const *const ghost_bbox)
+{
+  /* Only for ghosts that look the same at every location they cover:
+     redraws only the locations that the ghost entered or left */
+  MapModeData *const mode_data = get_mode_data(editor);
+  if (!MapArea_compare(&mode_data->ghost_bbox, ghost_bbox)) {
+    mode_data->ghost_bbox = *ghost_bbox;
+    Editor_move_ghost_map_bbox(editor, &mode_data->ghost_bbox);
+  }
+}
+#endif
+
+static bool transfer_is_solid(MapTransfer *const transfer)
+{
+  /* The ghost of a transfer without masked locations looks the same at every
+     location it covers, so moving it only requires redrawing its edges. */
+  MapPoint const t_dims = MapTransfers_get_dims(transfer);
+
+  for (MapPoint pos = {.y = 0}; pos.y < t_dims.y; ++pos.y) {
+    for (pos.x = 0; pos.x < t_dims.x; ++pos.x) {
+      if (map_ref_is_mask(MapTransfers_read_ref(transfer, pos))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 static void update_transfer_ghost(Editor *const editor,
   MapTransfer *const transfer, MapPoint const map_pos)
 {
   MapModeData *const mode_data = get_mode_data(editor);
-  MapMode_wipe_ghost(editor);
+  bool const is_moving = mode_data->pending_shape == Pending_Transfer &&
+                         mode_data->pending_transfer == transfer;
+  bool const is_solid = is_moving ? mode_data->pending_is_solid :
+                                    transfer_is_solid(transfer);
 
   MapPoint const t_dims = MapTransfers_get_dims(transfer);
   MapPoint const t_pos_on_map = MapPoint_sub(map_pos, MapPoint_div_log2(t_dims, 1));
-  mode_data->ghost_bbox = MapTransfers_get_bbox(t_pos_on_map, transfer);
+  MapArea const ghost_bbox = MapTransfers_get_bbox(t_pos_on_map, transfer);
+
+#if !PENDING_IS_SELECTED
+  if (is_moving && is_solid) {
+    move_ghost(editor, &ghost_bbox);
+    return;
+  }
+#endif
+
+  MapMode_wipe_ghost(editor);
+  mode_data->ghost_bbox = ghost_bbox;
 
 #if PENDING_IS_SELECTED
   MapTransfers_select(&mode_data->selection, t_pos_on_map, transfer);
@@ -695,6 +784,7 @@ static void update_transfer_ghost(Editor *const editor,
 
   mode_data->pending_shape = Pending_Transfer;
   mode_data->pending_transfer = transfer;
+  mode_data->pending_is_solid = is_solid;
 }
 
 static bool paste_generic(Editor *const editor,
@@ -823,8 +913,9 @@ static void MapMode_start_brush(Editor *const editor, int const brush_size,
   EditSession *const session = Editor_get_session(editor);
   MapEditContext const *const map = Session_get_map(session);
 
-  MapEdit_plot_circ(map, map_pos, brush_size,
-    tile, &mode_data->change_info);
+  Shapes_stroke_init(&mode_data->stroke, Map_SizeLog2);
+  MapEdit_plot_stroke(map, &mode_data->stroke, map_pos, map_pos,
+    tile, brush_size, &mode_data->change_info);
 
   changed_with_msg(editor);
 }
@@ -862,8 +953,8 @@ static void MapMode_draw_brush(Editor *const editor, int const brush_size,
 
   MapRef const tile = get_selected_tile(editor);
 
-  MapEdit_plot_line(map, last_map_pos, map_pos, tile,
-    brush_size, &mode_data->change_info);
+  MapEdit_plot_stroke(map, &mode_data->stroke, last_map_pos, map_pos,
+    tile, brush_size, &mode_data->change_info);
 
   changed_with_msg(editor);
 }
@@ -1125,6 +1216,14 @@ static void MapMode_pending_point(Editor *const editor, MapPoint const map_pos)
 {
   MapModeData *const mode_data = get_mode_data(editor);
 
+#if !PENDING_IS_SELECTED
+  if (mode_data->pending_shape == Pending_Point) {
+    mode_data->pending_vert[0] = map_pos;
+    move_ghost(editor, &(MapArea){map_pos, map_pos});
+    return;
+  }
+#endif
+
   MapMode_wipe_ghost(editor);
 
   mode_data->pending_vert[0] = map_pos;
@@ -1226,15 +1325,23 @@ static void MapMode_pending_rect(Editor *const editor, MapPoint const a, MapPoin
   MapModeData *const mode_data = get_mode_data(editor);
   assert(Editor_get_tool(editor) == EDITORTOOL_PLOTSHAPES);
 
-  MapMode_wipe_ghost(editor);
-
 #if PENDING_IS_SELECTED
+  MapMode_wipe_ghost(editor);
   MapEditSelection_select_rect(&mode_data->selection, a, b);
 #else
+  MapArea ghost_bbox;
+  MapArea_from_points(&ghost_bbox, a, b);
+
+  if (mode_data->pending_shape == Pending_Rectangle) {
+    /* A filled rectangle looks the same at every location it covers */
+    move_ghost(editor, &ghost_bbox);
+  } else {
+    MapMode_wipe_ghost(editor);
+    mode_data->ghost_bbox = ghost_bbox;
+    Editor_set_ghost_map_bbox(editor, &mode_data->ghost_bbox);
+  }
   mode_data->pending_vert[0] = a;
   mode_data->pending_vert[1] = b;
-  MapArea_from_points(&mode_data->ghost_bbox, a, b);
-  Editor_set_ghost_map_bbox(editor, &mode_data->ghost_bbox);
 #endif
   mode_data->pending_shape = Pending_Rectangle;
 }
@@ -1989,17 +2096,19 @@ static void MapMode_draw_numbers(Editor *const editor,
   MapAngle const angle = EditWin_get_angle(edit_win);
   int const tile_count = MapTexBitmaps_get_count(&textures->tiles);
 
+  MapPoint const row_step = MapLayout_derotate_scr_row_step(angle);
+
   for (MapPoint scr_pos = {.y = scr_area.min.y};
        scr_pos.y <= scr_area.max.y;
        scr_pos.y++, coord.y += grid_size.y)
   {
     coord.x = scr_orig.x + (scr_area.min.x * grid_size.x) + (grid_size.x / 2l);
+    scr_pos.x = scr_area.min.x;
+    MapPoint map_pos = MapLayout_derotate_scr_coords_to_map(angle, scr_pos);
 
-    for (scr_pos.x = scr_area.min.x;
-         scr_pos.x <= scr_area.max.x;
-         scr_pos.x++, coord.x += grid_size.x)
+    for (; scr_pos.x <= scr_area.max.x;
+         scr_pos.x++, coord.x += grid_size.x, map_pos = MapPoint_add(map_pos, row_step))
     {
-      MapPoint const map_pos = MapLayout_derotate_scr_coords_to_map(angle, scr_pos);
       PaletteEntry font_fg_colour, font_bg_colour;
       MapRef tile_no = MapEdit_read_tile(read_map_data, map_pos);
 
@@ -2137,6 +2246,8 @@ typedef struct {
   MapTransfer *transfer;
   MapArea transfer_area;
   Vertex min_os;
+  int anchor_y;
+  bool is_solid;
 } DrawTransferShadow;
 
 static DrawTilesReadResult ghost_paste_read(void *const cb_arg, MapPoint map_pos)
@@ -2151,6 +2262,14 @@ static DrawTilesReadResult ghost_paste_read(void *const cb_arg, MapPoint map_pos
     };
   }
 
+  if (args->is_solid) {
+    /* No need to read the transfer to know that it isn't masked */
+    return (DrawTilesReadResult){
+      .tile_ref = map_ref_from_num(0),
+      .is_selected = false,
+    };
+  }
+
   map_pos = map_wrap_coords(map_pos);
   MapPoint const min = map_wrap_coords(args->transfer_area.min);
 
@@ -2174,14 +2293,24 @@ static DrawTilesReadResult ghost_paste_read(void *const cb_arg, MapPoint map_pos
   };
 }
 
-static void write_ghost(BBox const *const bbox, Vertex const min_os)
+static void write_ghost(BBox const *const bbox, Vertex const min_os,
+  int const anchor_y)
 {
   // Just draw horizontal lines instead of trying to represent individual tiles
   BBox trans_bbox;
   BBox_translate(bbox, min_os, &trans_bbox);
 
+  /* Keep lines at the same height relative to the window origin, regardless
+     of where the ghost is, so that moving a ghost doesn't change how it looks
+     where the old and new positions overlap. */
   int const step = 2 << Desktop_get_eigen_factors().y;
-  for (int y = trans_bbox.ymin; y < trans_bbox.ymax; y += step) {
+  int phase = (trans_bbox.ymin - anchor_y) % step;
+  if (phase < 0) {
+    phase += step;
+  }
+
+  int const first_y = trans_bbox.ymin + (phase ? step - phase : 0);
+  for (int y = first_y; y < trans_bbox.ymax; y += step) {
     assert(step > 0);
     plot_move((Vertex){trans_bbox.xmin, y});
     plot_fg_line_ex_end((Vertex){trans_bbox.xmax, y});
@@ -2214,7 +2343,7 @@ static void draw_shape_ghost(MapArea const *const bbox, void *const cb_arg)
     (scr_area.max.x + 1) * args->tile_size.x,
     (scr_area.max.y + 1) * args->tile_size.y,
   };
-  write_ghost(&screen_bbox, args->min_os);
+  write_ghost(&screen_bbox, args->min_os, args->min_os.y);
 }
 
 static void ghost_paste_bbox(void *const cb_arg, BBox const *const bbox, MapRef const value)
@@ -2224,11 +2353,11 @@ static void ghost_paste_bbox(void *const cb_arg, BBox const *const bbox, MapRef
          bbox->xmin, bbox->ymin, bbox->xmax, bbox->ymax);
 
   if (!map_ref_is_mask(value)) {
-    write_ghost(bbox, args->min_os);
+    write_ghost(bbox, args->min_os, args->anchor_y);
   }
 }
 
-static void draw_ghost_paste(MapTransfer *const transfer,
+static void draw_ghost_paste(MapTransfer *const transfer, bool const is_solid,
   MapPoint const bl, EditWin const *const edit_win, Vertex const scr_orig,
   MapArea const *const grid_area)
 {
@@ -2254,10 +2383,13 @@ static void draw_ghost_paste(MapTransfer *const transfer,
       .max = MapPoint_add(bl, MapPoint_sub(transfer_dims, (MapPoint){1,1}))
     },
     .min_os = Vertex_add(scr_orig, draw_min),
+    .anchor_y = scr_orig.y,
+    .is_solid = is_solid,
   };
 
-  DrawTiles_to_bbox(angle, &scr_area, ghost_paste_read, &data, ghost_paste_bbox,
-    &data, tile_size);
+  DrawTilesCellReader reader = {ghost_paste_read, &data};
+  DrawTiles_to_bbox(angle, &scr_area, DrawTiles_read_cells, &reader,
+    ghost_paste_bbox, &data, tile_size);
 }
 
 static void draw_pending(MapModeData const *const mode_data, Vertex const scr_orig,
@@ -2307,7 +2439,7 @@ static void draw_pending(MapModeData const *const mode_data, Vertex const scr_or
 
     case Pending_Transfer:
       if (mode_data->pending_transfer) {
-        draw_ghost_paste(&*mode_data->pending_transfer,
+        draw_ghost_paste(&*mode_data->pending_transfer, mode_data->pending_is_solid,
                          mode_data->ghost_bbox.min, edit_win,
                          scr_orig, grid_area);
       }
@@ -2390,7 +2522,7 @@ void MapMode_draw(Editor *const editor, Vertex const scr_orig,
     map_overlap(&grid_area, &mode_data->drop_bbox))
   {
     plot_set_col(EditWin_get_ghost_colour(edit_win));
-    draw_ghost_paste(&*mode_data->pending_drop,
+    draw_ghost_paste(&*mode_data->pending_drop, mode_data->drop_is_solid,
                      mode_data->drop_bbox.min, edit_win, scr_orig, &grid_area);
   }
 
@@ -2539,6 +2671,10 @@ static bool MapMode_show_ghost_drop(Editor *const editor,
     assert(origin_data->dragged);
     assert(!mode_data->uk_drop_pending);
 
+    bool const is_solid = mode_data->pending_drop == origin_data->dragged ?
+                          mode_data->drop_is_solid :
+                          transfer_is_solid(&*origin_data->dragged);
+
     if (mode_data->pending_drop) {
       if (MapArea_compare(&mode_data->drop_bbox, bbox) &&
           mode_data->pending_drop == origin_data->dragged) {
@@ -2546,6 +2682,15 @@ static bool MapMode_show_ghost_drop(Editor *const editor,
         return hide_origin_bbox;
       }
 
+#if !PENDING_IS_SELECTED
+      if (mode_data->pending_drop == origin_data->dragged && is_solid) {
+        /* Only redraw the locations that the ghost entered or left */
+        Editor_move_ghost_map_bbox(editor, bbox);
+        mode_data->drop_bbox = *bbox;
+        return hide_origin_bbox;
+      }
+#endif
+
 #if PENDING_IS_SELECTED
       MapEditSelection_clear(&mode_data->selection);
 #else
@@ -2561,6 +2706,7 @@ static bool MapMode_show_ghost_drop(Editor *const editor,
 #endif
 
     mode_data->pending_drop = origin_data->dragged;
+    mode_data->drop_is_solid = is_solid;
     dfile_claim(MapTransfer_get_dfile(&*origin_data->dragged));
 
   } else {
@@ -2575,7 +2721,11 @@ static bool MapMode_show_ghost_drop(Editor *const editor,
 #if PENDING_IS_SELECTED
       MapEditSelection_clear(&mode_data->selection);
 #else
-      Editor_redraw_ghost(editor); // undraw
+      /* The ghost is a plain rectangle, so only redraw the locations that
+         it entered or left */
+      Editor_move_ghost_map_bbox(editor, bbox);
+      mode_data->drop_bbox = *bbox;
+      return hide_origin_bbox;
 #endif
     }
 
@@ -0,0 +1,321 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Image pyramid of the whole ground map
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "stdlib.h"
+
+#include "PalEntry.h"
+#include "SprFormats.h"
+
+#include "Macros.h"
+#include "Debug.h"
+
+#include "SFInit.h"
+#include "Map.h"
+#include "MapCoord.h"
+#include "MapEdit.h"
+#include "MapEditCtx.h"
+#include "MapEditSel.h"
+#include "MapLayout.h"
+#include "MapTexBitm.h"
+#include "SprMem.h"
+#include "MapOverview.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+enum {
+  BlockSizeLog2 = 4, /* locations per side of an invalidated block */
+  BlockCountLog2 = Map_SizeLog2 - BlockSizeLog2,
+  BlockCount = 1 << BlockCountLog2, /* blocks per side */
+  PixelCount = ((Map_Area << 2) - 1) / 3, /* sum of the areas of all levels */
+  SpanLength = 64, /* max. no. of selection states read at once */
+};
+
+struct MapOverview {
+  bool any_stale;
+  bool stale[BlockCount * BlockCount];
+  unsigned char pixels[PixelCount]; /* all levels, largest first */
+};
+
+/* ---------------- Private functions ---------------- */
+
+static size_t level_offset(int const level)
+{
+  assert(level >= 0);
+  assert(level < MapOverview_LevelCount);
+
+  size_t offset = 0;
+  for (int l = 0; l < level; ++l) {
+    offset += (size_t)1 << (2 * (Map_SizeLog2 - l));
+  }
+  return offset;
+}
+
+static unsigned char get_colour(MapTexBitmaps const *const tiles,
+  int const tile_count, MapRef tile)
+{
+  if (map_ref_is_mask(tile) || tile_count == 0) {
+    return 0;
+  }
+  if (map_ref_to_num(tile) >= tile_count) {
+    tile = map_ref_from_num(0); /* FIXME: substitute a placeholder colour? */
+  }
+  int const colour = MapTexBitmaps_get_average_colour(tiles, tile);
+  assert((unsigned char)colour == colour);
+  return (unsigned char)colour;
+}
+
+static void downsample(MapOverview *const overview, int const level,
+  MapArea const *const area)
+{
+  /* Each pixel is the average colour of four pixels of the level below */
+  assert(level > 0);
+  int const size_log2 = Map_SizeLog2 - level;
+  unsigned char const *const src = overview->pixels + level_offset(level - 1);
+  unsigned char *const dst = overview->pixels + level_offset(level);
+
+  for (MapCoord y = area->min.y; y <= area->max.y; ++y) {
+    for (MapCoord x = area->min.x; x <= area->max.x; ++x) {
+      size_t const s = ((size_t)y << (2 + size_log2)) + ((size_t)x << 1);
+      size_t const src_stride = (size_t)1 << (size_log2 + 1);
+      int const pix[] = {src[s], src[s + 1], src[s + src_stride], src[s + src_stride + 1]};
+
+      unsigned char nearest = (unsigned char)pix[0];
+      if (pix[1] != pix[0] || pix[2] != pix[0] || pix[3] != pix[0]) {
+        int red_total = 0, green_total = 0, blue_total = 0;
+        for (size_t i = 0; i < ARRAY_SIZE(pix); ++i) {
+          PaletteEntry const palette_entry = (*palette)[pix[i]];
+          red_total += PALETTE_GET_RED(palette_entry);
+          green_total += PALETTE_GET_GREEN(palette_entry);
+          blue_total += PALETTE_GET_BLUE(palette_entry);
+        }
+
+        int const colour = nearest_palette_entry_rgb(
+          *palette, ARRAY_SIZE(*palette),
+          red_total / (int)ARRAY_SIZE(pix), green_total / (int)ARRAY_SIZE(pix),
+          blue_total / (int)ARRAY_SIZE(pix));
+
+        assert((unsigned char)colour == colour);
+        nearest = (unsigned char)colour;
+      }
+      dst[((size_t)y << size_log2) + (size_t)x] = nearest;
+    }
+  }
+}
+
+static void update_block(MapOverview *const overview,
+  MapEditContext const *const map, MapTexBitmaps const *const tiles,
+  int const tile_count, MapPoint const block)
+{
+  MapArea area = {
+    .min = MapPoint_mul_log2(block, BlockSizeLog2),
+    .max = MapPoint_add(MapPoint_mul_log2(block, BlockSizeLog2),
+                        (MapPoint){(1 << BlockSizeLog2) - 1, (1 << BlockSizeLog2) - 1}),
+  };
+
+  for (MapCoord y = area.min.y; y <= area.max.y; ++y) {
+    MapRef row[1 << BlockSizeLog2];
+    MapEdit_read_tiles(map, (MapPoint){area.min.x, y}, (MapPoint){1, 0},
+                       ARRAY_SIZE(row), row);
+
+    unsigned char *const dst = overview->pixels + map_coords_to_index((MapPoint){area.min.x, y});
+    for (size_t x = 0; x < ARRAY_SIZE(row); ++x) {
+      dst[x] = get_colour(tiles, tile_count, row[x]);
+    }
+  }
+
+  /* Levels up to the one at which the block is a single pixel */
+  for (int level = 1; level <= BlockSizeLog2; ++level) {
+    area.min = MapPoint_div_log2(area.min, 1);
+    area.max = MapPoint_div_log2(area.max, 1);
+    downsample(overview, level, &area);
+  }
+}
+
+static bool invalidate_cb(MapArea const *const piece, void *const arg)
+{
+  MapOverview *const overview = arg;
+  assert(overview);
+
+  MapArea const blocks = {
+    .min = MapPoint_div_log2(piece->min, BlockSizeLog2),
+    .max = MapPoint_div_log2(piece->max, BlockSizeLog2),
+  };
+
+  for (MapCoord y = blocks.min.y; y <= blocks.max.y; ++y) {
+    for (MapCoord x = blocks.min.x; x <= blocks.max.x; ++x) {
+      overview->stale[((size_t)y << BlockCountLog2) + (size_t)x] = true;
+    }
+  }
+  return false; /* continue */
+}
+
+static void recolour_selected(unsigned char *const row, MapCoord const width,
+  MapPoint const map_pos, MapPoint const step,
+  MapEditSelection const *const selection,
+  unsigned char const (*const sel_colours)[NumColours])
+{
+  bool is_selected[SpanLength];
+
+  for (MapCoord x = 0; x < width; x += SpanLength) {
+    size_t const count = (size_t)LOWEST(width - x, SpanLength);
+    MapEditSelection_read_span(selection,
+      MapPoint_add(map_pos, MapPoint_mul(step, (MapPoint){x, x})),
+      step, count, is_selected);
+
+    for (size_t i = 0; i < count; ++i) {
+      if (is_selected[i]) {
+        row[(size_t)x + i] = (*sel_colours)[row[(size_t)x + i]];
+      }
+    }
+  }
+}
+
+/* ---------------- Public functions ---------------- */
+
+_Optional MapOverview *MapOverview_create(void)
+{
+  _Optional MapOverview *const overview = malloc(sizeof(*overview));
+  if (overview) {
+    MapOverview_invalidate_all(&*overview);
+  }
+  return overview;
+}
+
+void MapOverview_destroy(_Optional MapOverview *const overview)
+{
+  free(overview);
+}
+
+void MapOverview_invalidate(MapOverview *const overview, MapArea const *const area)
+{
+  assert(overview);
+  assert(MapArea_is_valid(area));
+
+  (void)map_split_area(area, invalidate_cb, overview);
+  overview->any_stale = true;
+}
+
+void MapOverview_invalidate_all(MapOverview *const overview)
+{
+  assert(overview);
+
+  for (size_t i = 0; i < ARRAY_SIZE(overview->stale); ++i) {
+    overview->stale[i] = true;
+  }
+  overview->any_stale = true;
+}
+
+void MapOverview_update(MapOverview *const overview,
+  MapEditContext const *const map, MapTexBitmaps *const tiles)
+{
+  assert(overview);
+  assert(map);
+  assert(tiles);
+
+  if (!overview->any_stale) {
+    return;
+  }
+
+  int const tile_count = MapTexBitmaps_get_count(tiles);
+  size_t nstale = 0;
+
+  for (MapPoint block = {.y = 0}; block.y < BlockCount; ++block.y) {
+    for (block.x = 0; block.x < BlockCount; ++block.x) {
+      bool *const stale = &overview->stale[((size_t)block.y << BlockCountLog2) + (size_t)block.x];
+      if (*stale) {
+        update_block(overview, map, tiles, tile_count, block);
+        *stale = false;
+        ++nstale;
+      }
+    }
+  }
+  DEBUGF("Updated %zu blocks of map overview\n", nstale);
+
+  /* The smallest levels are cheap enough to recalculate in full */
+  for (int level = BlockSizeLog2 + 1; level < MapOverview_LevelCount; ++level) {
+    MapCoord const max = (1 << (Map_SizeLog2 - level)) - 1;
+    downsample(overview, level, &(MapArea){{0, 0}, {max, max}});
+  }
+
+  overview->any_stale = false;
+}
+
+bool MapOverview_to_sprite(MapOverview const *const overview,
+  SprMem *const sm, char const *const name, MapAngle const angle,
+  MapArea const *const scr_area, int const level,
+  _Optional MapEditSelection const *const selection,
+  _Optional unsigned char const (*const sel_colours)[NumColours])
+{
+  assert(overview);
+  assert(!overview->any_stale);
+  assert(MapArea_is_valid(scr_area));
+  assert(level >= 0);
+  assert(level < MapOverview_LevelCount);
+  assert(!selection || level == 0);
+
+  _Optional SpriteHeader *const sprite = SprMem_get_sprite_address(sm, name);
+  if (!sprite) {
+    return false;
+  }
+
+  int const size_log2 = Map_SizeLog2 - level;
+  unsigned long const mask = (1ul << size_log2) - 1;
+  unsigned char const *const src = overview->pixels + level_offset(level);
+  MapPoint const step = MapLayout_derotate_scr_row_step(angle);
+  MapPoint const dims = MapArea_size(scr_area);
+  size_t const stride = WORD_ALIGN_SZ((size_t)dims.x);
+
+  bool const show_sel = selection && sel_colours &&
+                        !MapEditSelection_is_none(&*selection);
+
+  /* The bottom row of the sprite is at the minimum y coordinate */
+  uint8_t *row = (uint8_t *)sprite + sprite->image + (stride * (size_t)(dims.y - 1));
+
+  for (MapPoint scr_pos = {scr_area->min.x, scr_area->min.y};
+       scr_pos.y <= scr_area->max.y;
+       ++scr_pos.y, row -= stride) {
+    /* Any location covered by a pixel derotates to a location covered
+       by the same pixel, so full-size coordinates work at any level */
+    MapPoint const row_start = MapPoint_div_log2(
+      MapLayout_derotate_scr_coords_to_map(angle, MapPoint_mul_log2(scr_pos, level)),
+      level);
+
+    MapPoint map_pos = row_start;
+    for (MapCoord x = 0; x < dims.x; ++x) {
+      row[x] = src[(((unsigned long)map_pos.y & mask) << size_log2) +
+                   ((unsigned long)map_pos.x & mask)];
+      map_pos = MapPoint_add(map_pos, step);
+    }
+
+    if (show_sel) {
+      recolour_selected(row, dims.x, row_start, step, &*selection, &*sel_colours);
+    }
+  }
+
+  SprMem_put_sprite_address(sm, &*sprite);
+  return true;
+}
@@ -0,0 +1,53 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Image pyramid of the whole ground map
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef MapOverview_h
+#define MapOverview_h
+
+#include <stdbool.h>
+
+#include "MapCoord.h"
+#include "SFInit.h"
+#include "Map.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+enum {
+  MapOverview_LevelCount = Map_SizeLog2 + 1, /* down to one pixel for the whole map */
+};
+
+struct MapEditContext;
+struct MapTexBitmaps;
+struct MapEditSelection;
+struct SprMem;
+
+typedef struct MapOverview MapOverview;
+
+/* An image of the ground map (with any overlay on top) at one pixel per
+   location, and successively halved copies of it. Locations without any
+   tile are black. Parts of it are recalculated on first use after they
+   have been invalidated. */
+_Optional MapOverview *MapOverview_create(void);
+void MapOverview_destroy(_Optional MapOverview *overview);
+
+void MapOverview_invalidate(MapOverview *overview, MapArea const *area);
+void MapOverview_invalidate_all(MapOverview *overview);
+
+void MapOverview_update(MapOverview *overview, struct MapEditContext const *map,
+  struct MapTexBitmaps *tiles);
+
+/* Copies part of one level of the pyramid to an 8bpp sprite of the same
+   size as the given area (in rotated screen coordinates at that level).
+   Selected locations are recoloured, which is only possible at level 0. */
+bool MapOverview_to_sprite(MapOverview const *overview,
+  struct SprMem *sm, char const *name, MapAngle angle,
+  MapArea const *scr_area, int level,
+  _Optional struct MapEditSelection const *selection,
+  _Optional unsigned char const (*sel_colours)[NumColours]);
+
+#endif
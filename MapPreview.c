@@ -0,0 +1,400 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Preview images of whole ground maps
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "stdio.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "Macros.h"
+#include "Debug.h"
+
+#include "MapPreview.h"
+#include "Utils.h"
+#include "DFileUtils.h"
+#include "Map.h"
+#include "MapTex.h"
+#include "MapTexData.h"
+#include "MapTexBitm.h"
+#include "Obj.h"
+#include "ObjectsEdit.h"
+#include "ObjEditCtx.h"
+#include "ObjGfx.h"
+#include "ObjGfxData.h"
+#include "ObjGfxMesh.h"
+#include "ObjLayout.h"
+#include "PolyCol.h"
+#include "HillCol.h"
+#include "Hill.h"
+#include "CloudsData.h"
+#include "Mission.h"
+#include "Infos.h"
+#include "DrawTiles.h"
+#include "DrawObjs.h"
+#include "DrawInfos.h"
+#include "SprMem.h"
+#include "Vertex.h"
+#include "View.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+#define SPRITE_NAME "preview"
+
+enum {
+  MaxDrawObjZoom = 3, /* same limits as an editing window */
+  MaxDrawInfoZoom = 2,
+};
+
+typedef struct {
+  MapData const *base;
+  _Optional MapData const *overlay;
+  ObjEditContext objects;
+  _Optional ObjGfx *graphics;
+  _Optional PolyColData const *poly_colours;
+  _Optional HillColData const *hill_colours;
+  CloudColData const *clouds;
+  _Optional TargetInfosData const *infos;
+  _Optional HillsData const *hills;
+  size_t next_info;
+} MapPreviewData;
+
+/* Cloud colours if no mission is given */
+static CloudColData const no_clouds;
+
+static _Optional ObjEditContext const *hill_objects;
+
+/* ---------------- Private functions ---------------- */
+
+static void read_tiles(void *const cb_arg, MapPoint const map_pos,
+  MapPoint const step, size_t const count, MapRef *const tile_refs,
+  bool *const is_selected)
+{
+  MapPreviewData const *const data = cb_arg;
+  assert(data);
+
+  long int const stride = map_index_stride(step);
+  MapPoint span_pos = map_pos;
+
+  /* Split the span where it wraps at the map edge */
+  for (size_t done = 0; done < count; ) {
+    size_t const n = map_span_before_wrap(span_pos, step, count - done);
+    size_t index = map_coords_to_index(span_pos);
+
+    for (size_t i = done; i < done + n; ++i, index += (size_t)stride) {
+      MapRef tile_ref = map_ref_mask();
+      if (data->overlay) {
+        tile_ref = map_get_tile_at(&*data->overlay, index);
+      }
+      if (map_ref_is_mask(tile_ref)) {
+        tile_ref = map_get_tile_at(data->base, index);
+      }
+      tile_refs[i] = tile_ref;
+      is_selected[i] = false;
+    }
+    done += n;
+    span_pos = MapPoint_add(span_pos, MapPoint_mul(step, (MapPoint){(MapCoord)n, (MapCoord)n}));
+  }
+}
+
+static bool load_file(DFile *const dfile, char const *const path)
+{
+  SFError const err = load_compressed(dfile, path);
+  if (SFError_fail(err)) {
+    if (err.type != SFErrorType_AlreadyReported) {
+      printf("%s\n", get_error_text(err, path, ""));
+    }
+    return false;
+  }
+  return true;
+}
+
+static bool is_hill(struct EditWin const *const edit_win, MapPoint const pos)
+{
+  /* There is no editing window from which to read objects */
+  NOT_USED(edit_win);
+  assert(hill_objects);
+  return hill_objects &&
+         objects_ref_is_hill(ObjectsEdit_read_ref(&*hill_objects, pos));
+}
+
+static ObjRef read_obj(void *const cb_arg, MapPoint const map_pos)
+{
+  MapPreviewData const *const data = cb_arg;
+  assert(data);
+  return ObjectsEdit_read_ref(&data->objects, map_pos);
+}
+
+static HillType read_hill(void *const cb_arg, MapPoint const map_pos,
+  unsigned char (*const colours)[Hill_MaxPolygons],
+  unsigned char (*const heights)[HillCorner_Count])
+{
+  MapPreviewData const *const data = cb_arg;
+  assert(data);
+  return data->hills ? hills_read(&*data->hills, map_pos, colours, heights) : HillType_None;
+}
+
+static size_t read_info(void *const cb_arg, MapPoint *const map_pos, int *const id)
+{
+  assert(map_pos);
+  assert(id);
+  MapPreviewData *const data = cb_arg;
+  assert(data);
+  assert(data->infos);
+
+  if (data->next_info >= target_infos_get_count(&*data->infos)) {
+    return SIZE_MAX;
+  }
+  size_t const index = data->next_info++;
+  _Optional TargetInfo const *const info = target_info_from_index(&*data->infos, index);
+  assert(info);
+  if (!info) {
+    return SIZE_MAX;
+  }
+  *map_pos = target_info_get_pos(&*info);
+  *id = target_info_get_id(&*info);
+  return index;
+}
+
+static void init_view(View *const view, int const zoom, MapAngle const angle)
+{
+  /* Projects objects in the same way as an editing window */
+  int const size = ((MapTexSize << TexelToOSCoordLog2) * Map_Size) >> zoom;
+  *view = (View){
+    .config = {.zoom_factor = zoom, .angle = angle},
+    .map_units_per_os_unit_log2 =
+      MAP_COORDS_LIMIT_LOG2 - TexelToOSCoordLog2 - Map_SizeLog2 - MapTexSizeLog2 + zoom,
+    .map_size_in_os_units = {size, size},
+  };
+  int const map_scaler = SIGNED_R_SHIFT(256 << TexelToOSCoordLog2, zoom);
+  ObjGfxMeshes_set_direction(&view->plot_ctx,
+    (ObjGfxDirection){ObjGfxAngle_from_map(angle), {-OBJGFXMESH_ANGLE_QUART}, {0}},
+    map_scaler);
+}
+
+static bool draw_objects(MapPreviewData *const data, View const *const view)
+{
+  /* Objects are drawn over the whole grid, with hills only if they can be coloured */
+  assert(data);
+  assert(data->graphics);
+
+  HillsData hills;
+  if (data->hill_colours) {
+    hill_objects = &data->objects;
+    SFError const err = hills_init(&hills, is_hill, NULL, NULL);
+    if (SFError_fail(err)) {
+      printf("%s\n", get_error_text(err, "", ""));
+      hill_objects = NULL;
+      return false;
+    }
+    hills_make(&hills);
+    data->hills = &hills;
+  }
+
+  MapArea const scr_area = ObjLayout_rotate_map_area_to_scr(view->config.angle,
+                             &(MapArea){{0, 0}, {Obj_Size - 1, Obj_Size - 1}});
+
+  DrawObjs_to_screen(data->poly_colours, data->hill_colours, data->clouds,
+                     &data->graphics->meshes, view, &scr_area, read_obj,
+                     read_hill, data, NULL, data->objects.triggers, NULL,
+                     (Vertex){0, 0}, false, NULL);
+
+  if (data->hills) {
+    data->hills = NULL;
+    hills_destroy(&hills);
+    hill_objects = NULL;
+  }
+  return true;
+}
+
+static bool draw_layers(MapPreviewData *const data, SprMem *const sm,
+  int const zoom, MapAngle const angle)
+{
+  /* Objects, hills and information are drawn over the ground */
+  assert(data);
+  bool const draw_objs = data->graphics && zoom <= MaxDrawObjZoom &&
+                         (data->objects.base || data->objects.overlay);
+  bool const draw_infos = data->infos && zoom <= MaxDrawInfoZoom;
+  if (!draw_objs && !draw_infos) {
+    return true;
+  }
+
+  View view;
+  init_view(&view, zoom, angle);
+
+  bool success = SprMem_output_to_sprite(sm, SPRITE_NAME);
+  if (success) {
+    if (draw_objs) {
+      success = draw_objects(data, &view);
+    }
+    if (success && draw_infos) {
+      data->next_info = 0;
+      DrawInfos_to_screen(&view, read_info, data, NULL, (Vertex){0, 0}, false, NULL);
+    }
+    SprMem_restore_output(sm);
+  }
+  return success;
+}
+
+static bool render(MapTex *const textures, MapPreviewData *const data,
+  char *const sprite_path, int const zoom, MapAngle const angle)
+{
+  int const size = (Map_Size * MapTexSize) >> zoom;
+
+  SprMem sm;
+  if (!SprMem_init(&sm, 0)) {
+    return false;
+  }
+
+  bool success = SprMem_create_sprite(&sm, SPRITE_NAME, false,
+                   (Vertex){size, size}, DrawTilesModeNumber);
+  if (success) {
+    MapArea const scr_area = {{0, 0}, {Map_Size - 1, Map_Size - 1}};
+    bool needs_mask = false;
+
+    success = DrawTiles_to_sprite(&textures->tiles, &sm, SPRITE_NAME, angle,
+                                  &scr_area, read_tiles, data, zoom, NULL,
+                                  &needs_mask);
+    if (!success) {
+      /* Scaled or rotated copies of the tiles could not be made */
+      printf("%s\n", get_error_text(SFERROR(NoMem), "", ""));
+    } else if (needs_mask) {
+      /* Areas where the base map is masked should be transparent */
+      success = SprMem_create_mask(&sm, SPRITE_NAME);
+      if (success) {
+        DrawTiles_to_mask(&sm, SPRITE_NAME, angle, &scr_area, read_tiles,
+                          data, zoom);
+      }
+    }
+  }
+
+  if (success) {
+    success = draw_layers(data, &sm, zoom, angle);
+  }
+
+  if (success) {
+    success = SprMem_save(&sm, sprite_path);
+  }
+
+  SprMem_destroy(&sm);
+  return success;
+}
+
+/* ---------------- Public functions ---------------- */
+
+bool MapPreview_save(MapPreviewFiles const *const files,
+  char *const sprite_path, int const zoom, MapAngle const angle)
+{
+  assert(files);
+  assert(files->base_map);
+  assert(files->tiles);
+  assert(sprite_path);
+  assert(zoom >= 0);
+  assert(zoom <= MapTexSizeLog2);
+  assert(angle >= MapAngle_First);
+  assert(angle < MapAngle_Count);
+
+  DEBUGF("Making preview of %s%s%s at zoom %d in %s\n", files->base_map,
+         files->overlay_map ? " with " : "",
+         files->overlay_map ? &*files->overlay_map : "", zoom, sprite_path);
+
+  bool success = false;
+  _Optional MapData *const base = map_create_base();
+  _Optional MapData *const overlay = files->overlay_map ? map_create_overlay() : NULL;
+  _Optional MapTex *const textures = MapTex_create();
+  _Optional ObjectsData *const base_objects =
+    files->base_objects ? objects_create_base() : NULL;
+  _Optional ObjectsData *const overlay_objects =
+    files->overlay_objects ? objects_create_overlay() : NULL;
+  _Optional ObjGfx *const graphics = files->graphics ? ObjGfx_create() : NULL;
+  _Optional PolyColData *const poly_colours =
+    files->poly_colours ? polycol_create() : NULL;
+  _Optional HillColData *const hill_colours =
+    files->hill_colours ? hillcol_create() : NULL;
+  _Optional MissionData *const mission = files->mission ? mission_create() : NULL;
+
+  if (!base || !textures || (files->overlay_map && !overlay) ||
+      (files->base_objects && !base_objects) ||
+      (files->overlay_objects && !overlay_objects) ||
+      (files->graphics && !graphics) ||
+      (files->poly_colours && !poly_colours) ||
+      (files->hill_colours && !hill_colours) ||
+      (files->mission && !mission)) {
+    printf("%s\n", get_error_text(SFERROR(NoMem), "", ""));
+  } else if (load_file(map_get_dfile(&*base), files->base_map) &&
+             (!overlay || load_file(map_get_dfile(&*overlay), &*files->overlay_map)) &&
+             load_file(MapTex_get_dfile(&*textures), files->tiles) &&
+             (!base_objects ||
+              load_file(objects_get_dfile(&*base_objects), &*files->base_objects)) &&
+             (!overlay_objects ||
+              load_file(objects_get_dfile(&*overlay_objects), &*files->overlay_objects)) &&
+             (!graphics || load_file(ObjGfx_get_dfile(&*graphics), &*files->graphics)) &&
+             (!poly_colours ||
+              load_file(polycol_get_dfile(&*poly_colours), &*files->poly_colours)) &&
+             (!hill_colours ||
+              load_file(hillcol_get_dfile(&*hill_colours), &*files->hill_colours)) &&
+             (!mission || load_file(mission_get_dfile(&*mission), &*files->mission))) {
+    MapPreviewData data = {
+      .base = &*base,
+      .overlay = overlay,
+      .objects = {
+        .base = base_objects,
+        .overlay = overlay_objects,
+        .triggers = mission ? mission_get_triggers(&*mission) : NULL,
+      },
+      .graphics = graphics,
+      .poly_colours = poly_colours,
+      .hill_colours = hill_colours,
+      .clouds = mission ? mission_get_cloud_colours(&*mission) : &no_clouds,
+      .infos = mission ? mission_get_target_infos(&*mission) : NULL,
+    };
+    success = render(&*textures, &data, sprite_path, zoom, angle);
+  }
+
+  if (mission) {
+    dfile_release(mission_get_dfile(&*mission));
+  }
+  if (hill_colours) {
+    dfile_release(hillcol_get_dfile(&*hill_colours));
+  }
+  if (poly_colours) {
+    dfile_release(polycol_get_dfile(&*poly_colours));
+  }
+  if (graphics) {
+    dfile_release(ObjGfx_get_dfile(&*graphics));
+  }
+  if (overlay_objects) {
+    dfile_release(objects_get_dfile(&*overlay_objects));
+  }
+  if (base_objects) {
+    dfile_release(objects_get_dfile(&*base_objects));
+  }
+  if (textures) {
+    dfile_release(MapTex_get_dfile(&*textures));
+  }
+  if (overlay) {
+    dfile_release(map_get_dfile(&*overlay));
+  }
+  if (base) {
+    dfile_release(map_get_dfile(&*base));
+  }
+  return success;
+}
@@ -0,0 +1,39 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Preview images of whole ground maps
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef MapPreview_h
+#define MapPreview_h
+
+#include <stdbool.h>
+#include "MapCoord.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+typedef struct {
+  char const *base_map, *tiles;
+  _Optional char const *overlay_map;
+  _Optional char const *base_objects, *overlay_objects, *graphics;
+  _Optional char const *poly_colours, *hill_colours;
+  _Optional char const *mission;
+} MapPreviewFiles;
+
+/* Renders the whole of a base map (with an optional overlay map on top)
+   using the given map textures and saves it as a sprite file. Each tile is
+   MapTexSize pixels across at zoom level 0, halving at each level up to
+   MapTexSizeLog2. Errors are written to the standard output stream instead
+   of being reported in the desktop.
+   If objects grids are given then their objects and hills are drawn over
+   the ground using the given graphics (which are required) and colours;
+   hills are only drawn if hill colours are given. A mission adds triggers,
+   cloud colours and strategic target information. As in an editing window,
+   only the ground is drawn at zoom level 4 and only hills are added at
+   zoom level 3. */
+bool MapPreview_save(MapPreviewFiles const *files, char *sprite_path,
+  int zoom, MapAngle angle);
+
+#endif
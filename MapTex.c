@@ -136,7 +136,7 @@ void MapTex_load_metadata(MapTex *const textures)
 
   char *const leaf_name = pathtail(&*filename, 1);
 
-  MapTransfers_load_all(&textures->transfers, leaf_name);
+  MapTransfers_load_all(&textures->transfers, leaf_name, &*filename);
 
   MapTexGroups_load(&textures->groups, leaf_name,
                     MapTexBitmaps_get_count(&textures->tiles));
@@ -0,0 +1,456 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Overview of the whole map with the visible part of an editing window
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "stdlib.h"
+#include <stdbool.h>
+#include <assert.h>
+
+#include "toolbox.h"
+#include "window.h"
+#include "event.h"
+#include "wimp.h"
+#include "wimplib.h"
+
+#include "Err.h"
+#include "Macros.h"
+#include "scheduler.h"
+#include "EventExtra.h"
+#include "Debug.h"
+#include "SprFormats.h"
+
+#include "Navigator.h"
+#include "EditWin.h"
+#include "Editor.h"
+#include "Session.h"
+#include "DataType.h"
+#include "Desktop.h"
+#include "DrawTiles.h"
+#include "Map.h"
+#include "MapCoord.h"
+#include "MapLayout.h"
+#include "MapOverview.h"
+#include "Plot.h"
+#include "SprMem.h"
+#include "Vertex.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+#undef CancelDrag /* definition in "wimplib.h" is wrong! */
+#define CancelDrag ((WimpDragBox *)-1)
+
+enum {
+  NavigatorSize = Map_Size, /* in OS units, i.e. one per map location */
+  ScaleFactorNumerator = 1024,
+  FREQUENCY = 5,
+  PRIORITY = SchedulerPriority_Min,
+};
+
+/* ---------------- Private functions ---------------- */
+
+static int get_level(void)
+{
+  /* Choose the level of the overview with one pixel per screen pixel */
+  Vertex const eigen_factors = Desktop_get_eigen_factors();
+  int const level = LOWEST(eigen_factors.x, eigen_factors.y);
+  return HIGHEST(0, LOWEST(level, MapOverview_LevelCount - 1));
+}
+
+static Vertex calc_map_origin(BBox const *const visible_area,
+  int const xscroll, int const yscroll)
+{
+  /* Bottom-left corner of the map in screen coordinates */
+  return (Vertex){visible_area->xmin - xscroll,
+                  visible_area->ymax - yscroll - NavigatorSize};
+}
+
+static bool get_map_origin(NavigatorData const *const nav, Vertex *const origin)
+{
+  WimpGetWindowStateBlock window_state;
+  if (E(window_get_wimp_handle(0, nav->my_object, &window_state.window_handle)) ||
+      E(wimp_get_window_state(&window_state))) {
+    return false;
+  }
+
+  *origin = calc_map_origin(&window_state.visible_area,
+                            window_state.xscroll, window_state.yscroll);
+  return true;
+}
+
+static void centre_on(NavigatorData const *const nav, Vertex const pointer)
+{
+  Vertex origin;
+  if (!get_map_origin(nav, &origin)) {
+    return;
+  }
+
+  EditWin *const edit_win = nav->edit_win;
+  Vertex const rel = Vertex_min((Vertex){NavigatorSize - 1, NavigatorSize - 1},
+                       Vertex_max((Vertex){0, 0}, Vertex_sub(pointer, origin)));
+
+  MapPoint const map_pos = MapLayout_derotate_scr_coords_to_map(
+                             EditWin_get_angle(edit_win), MapPoint_from_vertex(rel));
+
+  MapPoint const fine_pos = MapLayout_map_coords_to_centre(EditWin_get_view(edit_win), map_pos);
+
+  EditWin_set_scroll_pos(edit_win, Editor_map_to_grid_coords(
+                           EditWin_get_editor(edit_win), fine_pos, edit_win));
+}
+
+static bool make_sprite(NavigatorData const *const nav, SprMem *const sm,
+  int const level)
+{
+  EditWin *const edit_win = nav->edit_win;
+  EditSession *const session = EditWin_get_session(edit_win);
+
+  if (!Session_has_data(session, DataType_BaseMap) &&
+      !Session_has_data(session, DataType_OverlayMap)) {
+    return false;
+  }
+
+  _Optional MapOverview *const overview = Session_get_overview(session);
+  if (!overview) {
+    return false;
+  }
+
+  MapCoord const size = Map_Size >> level;
+  MapArea const scr_area = {{0, 0}, {size - 1, size - 1}};
+
+  if (!SprMem_init(sm, 0)) {
+    return false;
+  }
+
+  if (SprMem_create_sprite(sm, "Overview", false, MapPoint_to_vertex(MapArea_size(&scr_area)),
+                           DrawTilesModeNumber) &&
+      MapOverview_to_sprite(&*overview, sm, "Overview", EditWin_get_angle(edit_win),
+                            &scr_area, level, NULL, NULL)) {
+    return true;
+  }
+
+  SprMem_destroy(sm);
+  return false;
+}
+
+static void draw_viewport(NavigatorData const *const nav, Vertex const origin)
+{
+  EditWin *const edit_win = nav->edit_win;
+  MapArea fine_area;
+  if (!EditWin_get_visible_area(edit_win, &fine_area)) {
+    return;
+  }
+
+  MapArea const scr_area = MapLayout_scr_area_from_fine(EditWin_get_view(edit_win), &fine_area);
+
+  plot_set_col(PAL_WHITE);
+  plot_fg_ol_rect_2v(Vertex_add(origin, MapPoint_to_vertex(scr_area.min)),
+                     Vertex_add(origin, MapPoint_to_vertex(scr_area.max)));
+}
+
+static int redraw_window(int const event_code, WimpPollBlock *const event,
+  IdBlock *const id_block, void *const handle)
+{
+  NOT_USED(event_code);
+  NOT_USED(id_block);
+  NavigatorData const *const nav = handle;
+  assert(nav);
+
+  WimpRedrawWindowBlock block = {
+    .window_handle = event->redraw_window_request.window_handle,
+  };
+  int more;
+  if (E(wimp_redraw_window(&block, &more)) || !more) {
+    return 1; /* claim event */
+  }
+
+  /* The whole map is drawn as one sprite, scaled for the screen mode */
+  int const level = get_level();
+  Vertex const eigen_factors = Desktop_get_eigen_factors();
+  ScaleFactors scale_factors = {
+    .xmul = SIGNED_L_SHIFT(ScaleFactorNumerator, level),
+    .ymul = SIGNED_L_SHIFT(ScaleFactorNumerator, level),
+    .xdiv = SIGNED_L_SHIFT(ScaleFactorNumerator, eigen_factors.x),
+    .ydiv = SIGNED_L_SHIFT(ScaleFactorNumerator, eigen_factors.y),
+  };
+
+  SprMem sm;
+  bool const has_sprite = make_sprite(nav, &sm, level);
+  void *const transtable = Desktop_get_trans_table();
+
+  do {
+    Vertex const origin = calc_map_origin(&block.visible_area, block.xscroll, block.yscroll);
+
+    if (has_sprite) {
+      SprMem_plot_scaled_sprite(&sm, "Overview", origin,
+        SPRITE_ACTION_OVERWRITE, &scale_factors, transtable);
+    } else {
+      plot_set_col(EditWin_get_bg_colour(nav->edit_win));
+      plot_fg_rect_2v(origin, Vertex_add(origin, (Vertex){NavigatorSize - 1, NavigatorSize - 1}));
+    }
+
+    draw_viewport(nav, origin);
+
+    if (E(wimp_get_rectangle(&block, &more))) {
+      break;
+    }
+  } while (more);
+
+  Desktop_put_trans_table(transtable);
+  if (has_sprite) {
+    SprMem_destroy(&sm);
+  }
+
+  return 1; /* claim event */
+}
+
+static SchedulerTime track_drag(void *const handle, SchedulerTime const new_time,
+  const volatile bool *const time_up)
+{
+  /* Null event handler for following the pointer during a drag */
+  NOT_USED(time_up);
+  NavigatorData const *const nav = handle;
+  assert(nav);
+
+  WimpGetPointerInfoBlock ptr_info;
+  if (!E(wimp_get_pointer_info(&ptr_info))) {
+    centre_on(nav, (Vertex){ptr_info.x, ptr_info.y});
+  }
+
+  return new_time + FREQUENCY;
+}
+
+static int drag_complete(int event_code, WimpPollBlock *event,
+  IdBlock *id_block, void *handle);
+
+static void stop_drag(NavigatorData *const nav)
+{
+  assert(nav);
+  if (nav->dragging) {
+    scheduler_deregister(track_drag, nav);
+    E(event_deregister_wimp_handler(-1, Wimp_EUserDrag, drag_complete, nav));
+    nav->dragging = false;
+  }
+}
+
+static int drag_complete(int const event_code, WimpPollBlock *const event,
+  IdBlock *const id_block, void *const handle)
+{
+  /* Called when a Wimp_DragBox operation is terminated by the user */
+  NOT_USED(event_code);
+  NOT_USED(id_block);
+  NavigatorData *const nav = handle;
+  assert(nav);
+
+  if (!nav->dragging) {
+    return 0; /* unaware of drag - assume belongs to another navigator */
+  }
+
+  WimpUserDragBoxEvent const *const wudbe = &event->user_drag_box;
+  stop_drag(nav);
+  centre_on(nav, (Vertex){wudbe->bbox.xmin, wudbe->bbox.ymin});
+
+  return 1; /* claim event */
+}
+
+static void start_drag(NavigatorData *const nav, Vertex const pointer)
+{
+  assert(nav);
+  assert(!nav->dragging);
+
+  WimpGetWindowStateBlock window_state;
+  if (E(window_get_wimp_handle(0, nav->my_object, &window_state.window_handle)) ||
+      E(wimp_get_window_state(&window_state))) {
+    return;
+  }
+
+  /* Invisible drag, restricted to the window */
+  WimpDragBox drag_box = {
+    .drag_type = Wimp_DragBox_DragPoint,
+    .dragging_box = {pointer.x, pointer.y, pointer.x, pointer.y},
+    .parent_box = window_state.visible_area,
+  };
+
+  if (E(wimp_drag_box(&drag_box))) {
+    return;
+  }
+
+  if (E(event_register_wimp_handler(-1, Wimp_EUserDrag, drag_complete, nav))) {
+    E(wimp_drag_box(CancelDrag));
+    return;
+  }
+
+  if (E(scheduler_register_delay(track_drag, nav, 0, PRIORITY))) {
+    E(wimp_drag_box(CancelDrag));
+    E(event_deregister_wimp_handler(-1, Wimp_EUserDrag, drag_complete, nav));
+    return;
+  }
+
+  nav->dragging = true;
+}
+
+static int mouse_click(int const event_code, WimpPollBlock *const event,
+  IdBlock *const id_block, void *const handle)
+{
+  /* Centre the editing window on the location clicked */
+  NOT_USED(event_code);
+  NOT_USED(id_block);
+  NavigatorData *const nav = handle;
+  assert(nav);
+  WimpMouseClickEvent const *const mouse_click = &event->mouse_click;
+  Vertex const pointer = {mouse_click->mouse_x, mouse_click->mouse_y};
+
+  if (TEST_BITS(mouse_click->buttons, BUTTONS_DRAG(Wimp_MouseButtonSelect))) {
+    if (!nav->dragging) {
+      start_drag(nav, pointer);
+    }
+  } else if (TEST_BITS(mouse_click->buttons, BUTTONS_CLICK(Wimp_MouseButtonSelect))) {
+    centre_on(nav, pointer);
+  } else {
+    return 0; /* not interested in this type of click */
+  }
+
+  return 1; /* claim event */
+}
+
+static bool register_wimp_handlers(NavigatorData *const nav)
+{
+  assert(nav != NULL);
+  static const struct {
+    int event_code;
+    WimpEventHandler *handler;
+  } wimp_handlers[] = {
+    { Wimp_ERedrawWindow, redraw_window },
+    { Wimp_EMouseClick, mouse_click },
+  };
+
+  for (size_t i = 0; i < ARRAY_SIZE(wimp_handlers); ++i) {
+    if (E(event_register_wimp_handler(nav->my_object,
+                                      wimp_handlers[i].event_code,
+                                      wimp_handlers[i].handler,
+                                      nav)))
+      return false;
+  }
+  return true;
+}
+
+static bool create(NavigatorData *const nav)
+{
+  assert(nav != NULL);
+  assert(nav->my_object == NULL_ObjectId);
+
+  if (E(toolbox_create_object(0, "Navigator", &nav->my_object))) {
+    nav->my_object = NULL_ObjectId;
+    return false;
+  }
+
+  DEBUG("Navigator object id is 0x%x", nav->my_object);
+
+  BBox const extent = {0, -NavigatorSize, NavigatorSize, 0};
+  if (register_wimp_handlers(nav) &&
+      !E(window_set_extent(0, nav->my_object, &extent))) {
+    return true;
+  }
+
+  (void)remove_event_handlers_delete(nav->my_object);
+  nav->my_object = NULL_ObjectId;
+  return false;
+}
+
+/* ---------------- Public functions ---------------- */
+
+void Navigator_init(NavigatorData *const nav, EditWin *const edit_win)
+{
+  assert(nav != NULL);
+  assert(edit_win != NULL);
+
+  *nav = (NavigatorData){
+    .my_object = NULL_ObjectId,
+    .edit_win = edit_win,
+    .dragging = false,
+  };
+}
+
+void Navigator_destroy(NavigatorData *const nav)
+{
+  assert(nav != NULL);
+
+  if (nav->dragging) {
+    E(wimp_drag_box(CancelDrag));
+    stop_drag(nav);
+  }
+
+  if (nav->my_object != NULL_ObjectId) {
+    E(remove_event_handlers_delete(nav->my_object));
+    nav->my_object = NULL_ObjectId;
+  }
+}
+
+void Navigator_show(NavigatorData *const nav)
+{
+  assert(nav != NULL);
+
+  if (nav->my_object == NULL_ObjectId && !create(nav)) {
+    return;
+  }
+
+  EditWin_show_window_aligned_right(nav->edit_win, nav->my_object, NavigatorSize);
+}
+
+void Navigator_redraw_map(NavigatorData const *const nav, MapArea const *const area)
+{
+  assert(nav != NULL);
+  assert(MapArea_is_valid(area));
+
+  if (nav->my_object == NULL_ObjectId) {
+    return;
+  }
+
+  if (!map_coords_in_range(area->min) || !map_coords_in_range(area->max)) {
+    Navigator_viewport_changed(nav); /* area wraps around the map edges */
+    return;
+  }
+
+  /* Round outwards to whole pixels of the overview */
+  int const level = get_level();
+  MapArea const scr_area = MapLayout_rotate_map_area_to_scr(
+                             EditWin_get_angle(nav->edit_win), area);
+
+  MapCoord const pix_mask = (1 << level) - 1;
+  BBox const bbox = {
+    .xmin = (int)(scr_area.min.x & ~pix_mask),
+    .ymin = (int)(scr_area.min.y & ~pix_mask) - NavigatorSize,
+    .xmax = (int)((scr_area.max.x | pix_mask) + 1),
+    .ymax = (int)((scr_area.max.y | pix_mask) + 1) - NavigatorSize,
+  };
+
+  E(window_force_redraw(0, nav->my_object, &bbox));
+}
+
+void Navigator_viewport_changed(NavigatorData const *const nav)
+{
+  assert(nav != NULL);
+
+  if (nav->my_object == NULL_ObjectId) {
+    return;
+  }
+
+  BBox const extent = {0, -NavigatorSize, NavigatorSize, 0};
+  E(window_force_redraw(0, nav->my_object, &extent));
+}
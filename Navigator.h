@@ -0,0 +1,34 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Overview of the whole map with the visible part of an editing window
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef Navigator_h
+#define Navigator_h
+
+#include <stdbool.h>
+
+#include "toolbox.h"
+#include "MapCoord.h"
+
+struct EditWin;
+
+typedef struct {
+  ObjectId my_object; /* NULL_ObjectId until first shown */
+  struct EditWin *edit_win;
+  bool dragging;
+} NavigatorData;
+
+void Navigator_init(NavigatorData *nav, struct EditWin *edit_win);
+void Navigator_destroy(NavigatorData *nav);
+void Navigator_show(NavigatorData *nav);
+
+/* Redraws part of the map shown in the navigator. */
+void Navigator_redraw_map(NavigatorData const *nav, MapArea const *area);
+
+/* Redraws the navigator after the editing window was scrolled, resized,
+   zoomed or rotated. */
+void Navigator_viewport_changed(NavigatorData const *nav);
+
+#endif
@@ -0,0 +1,337 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Pre-rendered images of numbers painted in an outline font
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include "stdlib.h"
+#include "stdio.h"
+
+#include "Macros.h"
+#include "Debug.h"
+#include "PalEntry.h"
+
+#include "Plot.h"
+#include "SprMem.h"
+#include "Desktop.h"
+#include "Vertex.h"
+#include "NumGlyphs.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+enum {
+  NumNumbers = UCHAR_MAX + 1,
+  NumColumns = 16,
+  NumRows = (NumNumbers + NumColumns - 1) / NumColumns,
+  NumVariants = 4, /* e.g. selected or not, underlined or not */
+  MaxImagePixels = 1 << 17, /* beyond this, paint numbers directly */
+};
+
+typedef struct {
+  bool is_created;
+  bool is_valid;
+  bool underline;
+  PaletteEntry bg_colour, fg_colour;
+} NumGlyphsVariant;
+
+struct NumGlyphs {
+  bool has_layout; /* key below is valid */
+  bool is_usable; /* layout fits within size limit and rendering succeeded */
+  bool has_sprites; /* sm is initialised */
+  int handle, mode, rubout_margin;
+  Vertex font_size, eigen_factors, pixel_size;
+  Vertex cell_size; /* in OS units */
+  BBox window; /* graphics window to restore after each plot */
+  SprMem sm;
+  size_t next_variant; /* next to be replaced */
+  NumGlyphsVariant variants[NumVariants];
+  Vertex font_offsets[NumNumbers]; /* from centre to font origin */
+  BBox rubouts[2][NumNumbers]; /* inclusive, relative to font origin */
+};
+
+/* ---------------- Private functions ---------------- */
+
+static void get_strings(unsigned char const number, char (*const string)[4],
+  char (*const underline)[4])
+{
+  sprintf(*string, "%d", number);
+  size_t const ulen = strlen(*string);
+  memset(*underline, '_', ulen);
+  (*underline)[ulen] = '\0';
+}
+
+static void variant_name(size_t const variant, char (*const name)[12])
+{
+  sprintf(*name, "num%zu", variant);
+}
+
+static Vertex cell_min(NumGlyphs const *const glyphs, unsigned char const number)
+{
+  /* Sprite rows are numbered from the bottom upwards */
+  return Vertex_mul((Vertex){number % NumColumns, number / NumColumns},
+                    glyphs->cell_size);
+}
+
+static void discard_sprites(NumGlyphs *const glyphs)
+{
+  assert(glyphs);
+  if (glyphs->has_sprites) {
+    SprMem_destroy(&glyphs->sm);
+    glyphs->has_sprites = false;
+  }
+
+  for (size_t v = 0; v < ARRAY_SIZE(glyphs->variants); ++v) {
+    glyphs->variants[v].is_created = false;
+    glyphs->variants[v].is_valid = false;
+  }
+  glyphs->next_variant = 0;
+}
+
+static bool calc_layout(NumGlyphs *const glyphs)
+{
+  /* Measure each number exactly as it would be painted with a rub-out box
+     (see ObjectsMode_draw_numbers) and find the biggest. */
+  assert(glyphs);
+  Vertex const pix = {1 << glyphs->eigen_factors.x, 1 << glyphs->eigen_factors.y};
+  Vertex max_size = {0, 0};
+  int const margin = glyphs->rubout_margin;
+
+  for (int number = 0; number < NumNumbers; ++number) {
+    char string[4], underline[4];
+    get_strings((unsigned char)number, &string, &underline);
+
+    BBox text_bbox, underline_bbox;
+    plot_get_string_bbox(glyphs->handle, string, &text_bbox);
+    plot_get_string_bbox(glyphs->handle, underline, &underline_bbox);
+
+    glyphs->font_offsets[number] = (Vertex){-(text_bbox.xmax / 2),
+                                            -(text_bbox.ymax / 2)};
+
+    for (int u = 0; u < 2; ++u) {
+      BBox combined_bbox = text_bbox;
+      if (u) {
+        BBox_expand_for_area(&combined_bbox, &underline_bbox);
+      }
+
+      BBox *const rubout = &glyphs->rubouts[u][number];
+      *rubout = (BBox){
+        combined_bbox.xmin - margin,
+        combined_bbox.ymin - margin,
+        combined_bbox.xmax - pix.x + margin,
+        combined_bbox.ymax - pix.y + margin,
+      };
+
+      max_size.x = HIGHEST(max_size.x, rubout->xmax - rubout->xmin + pix.x);
+      max_size.y = HIGHEST(max_size.y, rubout->ymax - rubout->ymin + pix.y);
+    }
+  }
+
+  glyphs->cell_size = max_size;
+  glyphs->pixel_size = (Vertex){
+    ((max_size.x * NumColumns) + pix.x - 1) >> glyphs->eigen_factors.x,
+    ((max_size.y * NumRows) + pix.y - 1) >> glyphs->eigen_factors.y,
+  };
+
+  DEBUG("Number images need %d,%d pixels", glyphs->pixel_size.x,
+        glyphs->pixel_size.y);
+
+  return glyphs->pixel_size.x > 0 && glyphs->pixel_size.y > 0 &&
+         glyphs->pixel_size.x * glyphs->pixel_size.y <= MaxImagePixels;
+}
+
+static bool render_variant(NumGlyphs *const glyphs, size_t const v)
+{
+  assert(glyphs);
+  assert(v < ARRAY_SIZE(glyphs->variants));
+  NumGlyphsVariant *const variant = &glyphs->variants[v];
+
+  char name[12];
+  variant_name(v, &name);
+  DEBUG("Rendering number images '%s'", name);
+
+  if (!glyphs->has_sprites) {
+    if (!SprMem_init(&glyphs->sm, 0)) {
+      return false;
+    }
+    glyphs->has_sprites = true;
+  }
+
+  if (!variant->is_created) {
+    if (!SprMem_create_sprite(&glyphs->sm, name, false, glyphs->pixel_size,
+                              glyphs->mode)) {
+      return false;
+    }
+    variant->is_created = true;
+  }
+
+  if (!SprMem_output_to_sprite(&glyphs->sm, name)) {
+    return false;
+  }
+
+  plot_set_bg_col(variant->bg_colour);
+  plot_clear_window();
+  plot_set_font_col(glyphs->handle, variant->bg_colour, variant->fg_colour);
+
+  for (int number = 0; number < NumNumbers; ++number) {
+    char string[4], underline[4];
+    get_strings((unsigned char)number, &string, &underline);
+
+    /* Put the bottom left of the rub-out box at the bottom left of the cell */
+    BBox const *const rel_rubout = &glyphs->rubouts[variant->underline][number];
+    Vertex const font_coord = Vertex_sub(cell_min(glyphs, (unsigned char)number),
+                                         BBox_get_min(rel_rubout));
+    BBox rubout;
+    BBox_translate(rel_rubout, font_coord, &rubout);
+
+    plot_font(glyphs->handle, string, &rubout, font_coord, false);
+    if (variant->underline) {
+      plot_font(glyphs->handle, underline, NULL, font_coord, false);
+    }
+  }
+
+  SprMem_restore_output(&glyphs->sm);
+  variant->is_valid = true;
+  return true;
+}
+
+static _Optional NumGlyphsVariant *find_variant(NumGlyphs *const glyphs,
+  bool const underline, PaletteEntry const bg_colour,
+  PaletteEntry const fg_colour, size_t *const v_out)
+{
+  assert(glyphs);
+  assert(v_out);
+
+  for (size_t v = 0; v < ARRAY_SIZE(glyphs->variants); ++v) {
+    NumGlyphsVariant *const variant = &glyphs->variants[v];
+    if (variant->is_valid && variant->underline == underline &&
+        variant->bg_colour == bg_colour && variant->fg_colour == fg_colour) {
+      *v_out = v;
+      return variant;
+    }
+  }
+
+  /* Replace the least recently rendered variant */
+  size_t const v = glyphs->next_variant;
+  glyphs->next_variant = (v + 1) % ARRAY_SIZE(glyphs->variants);
+
+  NumGlyphsVariant *const variant = &glyphs->variants[v];
+  variant->is_valid = false;
+  variant->underline = underline;
+  variant->bg_colour = bg_colour;
+  variant->fg_colour = fg_colour;
+
+  if (!render_variant(glyphs, v)) {
+    return NULL;
+  }
+
+  *v_out = v;
+  return variant;
+}
+
+/* ---------------- Public functions ---------------- */
+
+_Optional NumGlyphs *NumGlyphs_create(void)
+{
+  _Optional NumGlyphs *const glyphs = malloc(sizeof(*glyphs));
+  if (glyphs) {
+    glyphs->has_layout = false;
+    glyphs->is_usable = false;
+    glyphs->has_sprites = false;
+    discard_sprites(&*glyphs);
+  }
+  return glyphs;
+}
+
+void NumGlyphs_destroy(_Optional NumGlyphs *const glyphs)
+{
+  if (glyphs) {
+    discard_sprites(&*glyphs);
+    free(glyphs);
+  }
+}
+
+bool NumGlyphs_prepare(NumGlyphs *const glyphs, int const handle,
+  Vertex const font_size, int const rubout_margin)
+{
+  assert(glyphs);
+  int const mode = Desktop_get_screen_mode();
+  Vertex const eigen_factors = Desktop_get_eigen_factors();
+
+  if (!glyphs->has_layout ||
+      !Vertex_compare(glyphs->font_size, font_size) ||
+      !Vertex_compare(glyphs->eigen_factors, eigen_factors) ||
+      glyphs->mode != mode ||
+      glyphs->rubout_margin != rubout_margin)
+  {
+    discard_sprites(glyphs);
+    glyphs->font_size = font_size;
+    glyphs->eigen_factors = eigen_factors;
+    glyphs->mode = mode;
+    glyphs->rubout_margin = rubout_margin;
+    glyphs->handle = handle;
+    glyphs->has_layout = true;
+    glyphs->is_usable = calc_layout(glyphs);
+  }
+
+  /* The same font may have been given a different handle */
+  glyphs->handle = handle;
+  plot_get_window(&glyphs->window);
+
+  return glyphs->is_usable;
+}
+
+bool NumGlyphs_plot(NumGlyphs *const glyphs, unsigned char const number,
+  bool const underline, PaletteEntry const bg_colour,
+  PaletteEntry const fg_colour, Vertex const centre)
+{
+  assert(glyphs);
+  if (!glyphs->is_usable) {
+    return false;
+  }
+
+  size_t v;
+  if (!find_variant(glyphs, underline, bg_colour, fg_colour, &v)) {
+    glyphs->is_usable = false; /* don't try again for every location */
+    return false;
+  }
+
+  char name[12];
+  variant_name(v, &name);
+
+  Vertex const font_coord = Vertex_add(centre, glyphs->font_offsets[number]);
+  BBox rubout;
+  BBox_translate(&glyphs->rubouts[underline][number], font_coord, &rubout);
+
+  BBox clip;
+  BBox_intersection(&glyphs->window, &rubout, &clip);
+  if (BBox_is_valid(&clip)) {
+    /* Only the cell for this number is inside the graphics window */
+    plot_set_window(&clip);
+    SprMem_plot_sprite(&glyphs->sm, name,
+      Vertex_sub(BBox_get_min(&rubout), cell_min(glyphs, number)),
+      SPRITE_ACTION_OVERWRITE);
+    plot_set_window(&glyphs->window);
+  }
+
+  return true;
+}
@@ -0,0 +1,40 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Pre-rendered images of numbers painted in an outline font
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef NumGlyphs_h
+#define NumGlyphs_h
+
+#include <stdbool.h>
+
+#include "PalEntry.h"
+#include "Vertex.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+typedef struct NumGlyphs NumGlyphs;
+
+/* Images of the numbers 0-255 (each with a rub-out box and optionally
+   underlined) so that labelling many grid locations costs one sprite plot per
+   location instead of one call to the font manager. They are rendered on
+   first use for each combination of colours. */
+_Optional NumGlyphs *NumGlyphs_create(void);
+void NumGlyphs_destroy(_Optional NumGlyphs *glyphs);
+
+/* Must be called before plotting with a font handle found for the given size.
+   Returns false if the images would be too big (in which case the caller
+   should paint numbers using the font manager instead). */
+bool NumGlyphs_prepare(NumGlyphs *glyphs, int handle, Vertex font_size,
+  int rubout_margin);
+
+/* Plots a number centred at the given screen coordinates. Returns false if
+   it could not be plotted, in which case the font colours may have been
+   changed. */
+bool NumGlyphs_plot(NumGlyphs *glyphs, unsigned char number, bool underline,
+  PaletteEntry bg_colour, PaletteEntry fg_colour, Vertex centre);
+
+#endif
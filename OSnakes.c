@@ -184,7 +184,9 @@ void ObjSnakes_load(ObjSnakes *const snakes_data,
   SFError err = SFERROR(OK);
 
   hourglass_on();
-  if (file_exists(&*full_path)) {
+  if (file_exists(&*full_path) &&
+      !Snakes_load_compiled(&snakes_data->super, OBJSNAKES_DIR, tiles_set,
+                            &*full_path, nobj)) {
     _Optional FILE *const file = fopen(&*full_path, "r");
     if (file == NULL) {
       err = SFERROR(OpenInFail);
@@ -192,6 +194,11 @@ void ObjSnakes_load(ObjSnakes *const snakes_data,
       err = Snakes_load(&*file, &snakes_data->super, nobj, err_buf);
       fclose(&*file);
     }
+
+    if (!SFError_fail(err)) {
+      Snakes_save_compiled(&snakes_data->super, OBJSNAKES_DIR, tiles_set,
+                           &*full_path, nobj);
+    }
   }
   hourglass_off();
 
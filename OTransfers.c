@@ -88,7 +88,8 @@ struct ObjTransfer
   struct DFile dfile;
   CoarsePoint2d  size_minus_one;
   void *refs, *triggers; /* flex anchor */
-  size_t trigger_count, trigger_alloc;
+  void *areas; /* flex anchor for non-mask areas, or NULL */
+  size_t trigger_count, trigger_alloc, area_count;
 };
 
 /* ---------------- Private functions ---------------- */
@@ -281,6 +282,12 @@ static void destroy_all(ObjTransfer *const transfer)
   {
     flex_free(&transfer->triggers);
   }
+
+  if (transfer->areas)
+  {
+    flex_free(&transfer->areas);
+  }
+  transfer->area_count = 0;
 }
 
 static bool alloc_transfer(ObjTransfer *const transfer,
@@ -862,7 +869,7 @@ _Optional ObjTransfer *ObjTransfers_grab_selection(ObjEditContext const *const o
   return transfer;
 }
 
-static bool for_each_area(ObjTransfer *const transfer,
+static bool find_areas(ObjTransfer *const transfer,
   bool (*callback)(void *, MapArea const *), void *cb_arg)
 {
   MapPoint const t_dims = ObjTransfers_get_dims(transfer);
@@ -965,6 +972,64 @@ static bool for_each_area(ObjTransfer *const transfer,
   return true;
 }
 
+static bool count_area_cb(void *const cb_arg, MapArea const *const t_subregion)
+{
+  NOT_USED(t_subregion);
+  size_t *const count = cb_arg;
+  ++*count;
+  return true;
+}
+
+static bool store_area_cb(void *const cb_arg, MapArea const *const t_subregion)
+{
+  ObjTransfer *const transfer = cb_arg;
+  assert(transfer != NULL);
+  assert(transfer->area_count < (size_t)flex_size(&transfer->areas) / sizeof(MapArea));
+  ((MapArea *)transfer->areas)[transfer->area_count++] = *t_subregion;
+  return true;
+}
+
+static bool ensure_areas(ObjTransfer *const transfer)
+{
+  /* The decomposition of a transfer into rectangles of non-mask refs
+     is found once and reused every time the transfer is plotted */
+  if (transfer->areas) {
+    return true;
+  }
+
+  size_t count = 0;
+  (void)find_areas(transfer, count_area_cb, &count);
+  DEBUGF("Transfer %p has %zu areas\n", (void *)transfer, count);
+
+  if (!flex_alloc(&transfer->areas, (int)(sizeof(MapArea) * HIGHEST(count, 1)))) {
+    transfer->areas = NULL;
+    report_error(SFERROR(NoMem), "", "");
+    return false;
+  }
+
+  transfer->area_count = 0;
+  (void)find_areas(transfer, store_area_cb, transfer);
+  assert(transfer->area_count == count);
+  return true;
+}
+
+static bool for_each_area(ObjTransfer *const transfer,
+  bool (*callback)(void *, MapArea const *), void *cb_arg)
+{
+  if (!ensure_areas(transfer)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < transfer->area_count; ++i) {
+    /* Copy the area because the callback may move flex blocks */
+    MapArea const area = ((MapArea *)transfer->areas)[i];
+    if (!callback(cb_arg, &area)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 typedef struct {
   ObjTransfer *transfer;
   MapPoint offset_in_trans; /* of plot area within transfer */
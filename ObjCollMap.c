@@ -0,0 +1,211 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Map of grid locations covered by object collision boxes
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "stdlib.h"
+
+#include "Macros.h"
+#include "Debug.h"
+
+#include "MapCoord.h"
+#include "Obj.h"
+#include "ObjEditCtx.h"
+#include "ObjectsEdit.h"
+#include "ObjGfxMesh.h"
+#include "ObjCollMap.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+struct ObjCollMap {
+  bool is_valid;
+  ObjGfxMeshes *meshes; /* from which collision sizes were read */
+  unsigned char refs[Obj_Area]; /* object type counted at each grid location */
+  unsigned short counts[Obj_Area]; /* number of collision boxes covering each location */
+};
+
+typedef struct {
+  ObjCollMap *map;
+  int delta;
+} ObjCollMapAddOp;
+
+typedef struct {
+  ObjCollMap const *map;
+  int max_count;
+} ObjCollMapTestOp;
+
+/* ---------------- Private functions ---------------- */
+
+static bool is_counted(ObjRef const obj_ref)
+{
+  return !objects_ref_is_none(obj_ref) && !objects_ref_is_mask(obj_ref);
+}
+
+static MapPoint get_coll_size(ObjGfxMeshes *const meshes, ObjRef const obj_ref)
+{
+  if (!objects_ref_is_object(obj_ref) ||
+      objects_ref_to_num(obj_ref) >= ObjGfxMeshes_get_ground_count(meshes)) {
+    return (MapPoint){0,0};
+  }
+  return ObjGfxMeshes_get_collision_size(meshes, obj_ref);
+}
+
+static bool add_cb(MapArea const *const piece, void *const arg)
+{
+  ObjCollMapAddOp const *const op = arg;
+  assert(op);
+
+  for (MapCoord y = piece->min.y; y <= piece->max.y; ++y) {
+    unsigned short *const row = &op->map->counts[objects_coords_to_index((MapPoint){0, y})];
+    for (MapCoord x = piece->min.x; x <= piece->max.x; ++x) {
+      assert(op->delta > 0 || row[x] > 0);
+      row[x] += op->delta;
+    }
+  }
+  return false; /* continue */
+}
+
+static void add_coll_box(ObjCollMap *const map, MapPoint const grid_pos,
+  ObjRef const obj_ref, int const delta)
+{
+  /* A collision box may straddle the edge of the map, in which case
+     each part of it is counted separately. */
+  MapPoint const coll_size = get_coll_size(map->meshes, obj_ref);
+  MapArea const obj_area = {MapPoint_sub(grid_pos, coll_size),
+                            MapPoint_add(grid_pos, coll_size)};
+
+  ObjCollMapAddOp op = {.map = map, .delta = delta};
+  (void)objects_split_area(&obj_area, add_cb, &op);
+}
+
+static bool test_cb(MapArea const *const piece, void *const arg)
+{
+  ObjCollMapTestOp const *const op = arg;
+  assert(op);
+
+  /* No early exit within a row, so that the inner loop can be vectorised */
+  for (MapCoord y = piece->min.y; y <= piece->max.y; ++y) {
+    unsigned short const *const row = &op->map->counts[objects_coords_to_index((MapPoint){0, y})];
+    bool excess = false;
+    for (MapCoord x = piece->min.x; x <= piece->max.x; ++x) {
+      excess |= row[x] > op->max_count;
+    }
+    if (excess) {
+      return true; /* stop */
+    }
+  }
+  return false; /* continue */
+}
+
+static void rebuild(ObjCollMap *const map, ObjGfxMeshes *const meshes,
+  ObjEditContext const *const objects)
+{
+  DEBUG("Rebuilding object collision map");
+
+  memset(map->counts, 0, sizeof(map->counts));
+  map->meshes = meshes;
+
+  MapAreaIter iter;
+  for (MapPoint p = objects_get_first(&iter);
+       !MapAreaIter_done(&iter);
+       p = MapAreaIter_get_next(&iter))
+  {
+    ObjRef const obj_ref = ObjectsEdit_read_ref(objects, p);
+    map->refs[objects_coords_to_index(p)] = objects_ref_to_num(obj_ref);
+
+    if (is_counted(obj_ref)) {
+      add_coll_box(map, p, obj_ref, 1);
+    }
+  }
+
+  map->is_valid = true;
+}
+
+/* ---------------- Public functions ---------------- */
+
+_Optional ObjCollMap *ObjCollMap_create(void)
+{
+  _Optional ObjCollMap *const map = malloc(sizeof(*map));
+  if (map) {
+    map->is_valid = false;
+  }
+  return map;
+}
+
+void ObjCollMap_destroy(_Optional ObjCollMap *const map)
+{
+  free(map);
+}
+
+void ObjCollMap_invalidate(ObjCollMap *const map)
+{
+  assert(map);
+  map->is_valid = false;
+}
+
+void ObjCollMap_update(ObjCollMap *const map, ObjEditContext const *const objects,
+  MapPoint const grid_pos)
+{
+  assert(map);
+
+  if (!map->is_valid) {
+    return; /* will be rebuilt on next use */
+  }
+
+  MapPoint const wrapped_pos = objects_wrap_coords(grid_pos);
+  size_t const entry = objects_coords_to_index(wrapped_pos);
+  ObjRef const old_ref = objects_ref_from_num(map->refs[entry]);
+  ObjRef const new_ref = ObjectsEdit_read_ref(objects, wrapped_pos);
+
+  if (old_ref.index == new_ref.index) {
+    return;
+  }
+
+  if (is_counted(old_ref)) {
+    add_coll_box(map, wrapped_pos, old_ref, -1);
+  }
+
+  map->refs[entry] = objects_ref_to_num(new_ref);
+
+  if (is_counted(new_ref)) {
+    add_coll_box(map, wrapped_pos, new_ref, 1);
+  }
+}
+
+bool ObjCollMap_is_vacant(ObjCollMap *const map, ObjGfxMeshes *const meshes,
+  ObjEditContext const *const objects, MapArea const *const area,
+  int const max_count)
+{
+  assert(map);
+  assert(meshes);
+  assert(MapArea_is_valid(area));
+  assert(max_count >= 0);
+
+  if (!map->is_valid || map->meshes != meshes) {
+    rebuild(map, meshes, objects);
+  }
+
+  ObjCollMapTestOp op = {.map = map, .max_count = max_count};
+  return !objects_split_area(area, test_cb, &op);
+}
@@ -0,0 +1,40 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Map of grid locations covered by object collision boxes
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef ObjCollMap_h
+#define ObjCollMap_h
+
+#include <stdbool.h>
+
+#include "MapCoord.h"
+#include "Obj.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+struct ObjGfxMeshes;
+struct ObjEditContext;
+
+typedef struct ObjCollMap ObjCollMap;
+
+/* A count of the collision boxes covering each location of the objects
+   grid. It is built on first use and must be invalidated whenever the
+   objects or their meshes are replaced. */
+_Optional ObjCollMap *ObjCollMap_create(void);
+void ObjCollMap_destroy(_Optional ObjCollMap *map);
+
+void ObjCollMap_invalidate(ObjCollMap *map);
+
+void ObjCollMap_update(ObjCollMap *map, struct ObjEditContext const *objects,
+  MapPoint grid_pos);
+
+/* Returns true if no location in the given (possibly wrapped) area is
+   covered by more than max_count collision boxes. */
+bool ObjCollMap_is_vacant(ObjCollMap *map, struct ObjGfxMeshes *meshes,
+  struct ObjEditContext const *objects, MapArea const *area, int max_count);
+
+#endif
@@ -16,7 +16,8 @@
 #endif
 
 struct EditSession;
-
+struct ObjCollMap;
+struct ObjFlat;
 
 typedef void ObjEditPreChangeFn(MapArea const *, struct EditSession *),
              ObjEditRedrawnObjFn(MapPoint, ObjRef, ObjRef, ObjRef, bool, struct EditSession *),
@@ -30,6 +31,8 @@ struct ObjEditContext
   _Optional ObjEditPreChangeFn *prechange_cb;
   _Optional ObjEditRedrawnObjFn *redraw_obj_cb;
   _Optional ObjEditRedrawTrigFn *redraw_trig_cb;
+  _Optional struct ObjCollMap *coll_map; /* maintained on write, if any */
+  _Optional struct ObjFlat *flat; /* maintained on write, if any */
   struct EditSession *session;
 };
 
@@ -0,0 +1,121 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Objects grid with the overlay flattened onto the base grid
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stdlib.h"
+
+#include "Macros.h"
+#include "Debug.h"
+
+#include "MapCoord.h"
+#include "Obj.h"
+#include "ObjEditCtx.h"
+#include "ObjectsEdit.h"
+#include "ObjFlat.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+struct ObjFlat {
+  bool is_valid;
+  unsigned char refs[Obj_Area]; /* object ref shown at each grid location */
+};
+
+/* ---------------- Private functions ---------------- */
+
+static unsigned char resolve(ObjEditContext const *const objects,
+  MapPoint const grid_pos)
+{
+  ObjRef ref = objects_ref_mask();
+  if (objects->overlay) {
+    ref = objects_get_ref(&*objects->overlay, grid_pos);
+  }
+  if (objects_ref_is_mask(ref) && objects->base) {
+    ref = objects_get_ref(&*objects->base, grid_pos);
+  }
+  return objects_ref_to_num(ref);
+}
+
+static void rebuild(ObjFlat *const flat, ObjEditContext const *const objects)
+{
+  DEBUG("Rebuilding flattened objects grid");
+
+  MapAreaIter iter;
+  for (MapPoint p = objects_get_first(&iter);
+       !MapAreaIter_done(&iter);
+       p = MapAreaIter_get_next(&iter))
+  {
+    flat->refs[objects_coords_to_index(p)] = resolve(objects, p);
+  }
+
+  flat->is_valid = true;
+}
+
+/* ---------------- Public functions ---------------- */
+
+_Optional ObjFlat *ObjFlat_create(void)
+{
+  _Optional ObjFlat *const flat = malloc(sizeof(*flat));
+  if (flat) {
+    flat->is_valid = false;
+  }
+  return flat;
+}
+
+void ObjFlat_destroy(_Optional ObjFlat *const flat)
+{
+  free(flat);
+}
+
+void ObjFlat_invalidate(ObjFlat *const flat)
+{
+  assert(flat);
+  flat->is_valid = false;
+}
+
+void ObjFlat_update(ObjFlat *const flat, ObjEditContext const *const objects,
+  MapPoint const grid_pos)
+{
+  assert(flat);
+  assert(objects);
+
+  if (!flat->is_valid) {
+    return; /* will be rebuilt on next use */
+  }
+
+  MapPoint const wrapped_pos = objects_wrap_coords(grid_pos);
+  flat->refs[objects_coords_to_index(wrapped_pos)] = resolve(objects, wrapped_pos);
+}
+
+ObjRef ObjFlat_read_ref(ObjFlat *const flat, ObjEditContext const *const objects,
+  MapPoint const grid_pos)
+{
+  assert(flat);
+  assert(objects);
+
+  if (!flat->is_valid) {
+    rebuild(flat, objects);
+  }
+
+  return objects_ref_from_num(flat->refs[objects_coords_to_index(grid_pos)]);
+}
@@ -0,0 +1,36 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Objects grid with the overlay flattened onto the base grid
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef ObjFlat_h
+#define ObjFlat_h
+
+#include "MapCoord.h"
+#include "Obj.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+struct ObjEditContext;
+
+typedef struct ObjFlat ObjFlat;
+
+/* The object shown at each location of the objects grid: the overlay ref
+   unless it is masked, otherwise the base ref. It is built on first use,
+   updated by writes through the owning editing context and must be
+   invalidated whenever either layer is replaced. */
+_Optional ObjFlat *ObjFlat_create(void);
+void ObjFlat_destroy(_Optional ObjFlat *flat);
+
+void ObjFlat_invalidate(ObjFlat *flat);
+
+void ObjFlat_update(ObjFlat *flat, struct ObjEditContext const *objects,
+  MapPoint grid_pos);
+
+ObjRef ObjFlat_read_ref(ObjFlat *flat, struct ObjEditContext const *objects,
+  MapPoint grid_pos);
+
+#endif
@@ -53,6 +53,8 @@
 #include "ObjPolygon.h"
 #include "Hill.h"
 #include "Obj.h"
+#include "SprPoly.h"
+#include "Instrument.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -222,6 +224,7 @@ static _Optional ObjGfxMesh *obj_array_add(ObjGfxMeshArray *const array,
 
 static _Optional TrigTable *trig_table;
 static long int divide_table[DIV_TABLE_SIZE];
+static _Optional SprPoly *sprite_target;
 
 /* ---------------- Private functions ---------------- */
 
@@ -376,6 +379,15 @@ static void update_bbox(
   } /* next side */
 }
 
+static void set_colour(PaletteEntry const colour)
+{
+  if (sprite_target) {
+    SprPoly_set_colour(&*sprite_target, colour);
+  } else {
+    plot_set_col(colour);
+  }
+}
+
 static void plot_filled(
   Vertex (*const polygon_coords)[ObjPolygonMaxSides],
   Vertex const centre,
@@ -384,6 +396,17 @@ static void plot_filled(
   DEBUGF("Plot %d-sided polygon\n", num_sides);
 
   assert(num_sides >= 3);
+  INSTRUMENT_COUNT(PolygonsDrawn, 1);
+
+  if (sprite_target) {
+    Vertex corners[ObjPolygonMaxSides];
+    for (int side = 0; side < num_sides; side++)
+    {
+      corners[side] = translate_screen(centre, (*polygon_coords)[side]);
+    }
+    SprPoly_fill_convex(&*sprite_target, num_sides, corners);
+    return;
+  }
 
   Vertex const first_corner = translate_screen(centre, (*polygon_coords)[0]);
   Vertex screen_pos = translate_screen(centre, (*polygon_coords)[1]);
@@ -483,7 +506,7 @@ static void plot_group(
         int const colour = obj_polygon_get_colour(&polygon);
         int const pindex = polycol_get_colour(&*colours, colour);
         assert(pindex < (int)ARRAY_SIZE(*pal));
-        plot_set_col((*pal)[pindex]);
+        set_colour((*pal)[pindex]);
       }
       plot_filled(&polygon_coords, centre, num_sides);
       break;
@@ -1105,6 +1128,14 @@ _Optional TrigTable const *ObjGfxMeshes_get_trig_table(void)
   return trig_table;
 }
 
+void ObjGfxMeshes_set_sprite_target(_Optional SprPoly *const target)
+{
+  /* Filled polygons are plotted directly into the target sprite, if any,
+     instead of using the operating system. Other plot styles and lines are
+     unaffected. */
+  sprite_target = target;
+}
+
 static void plot_lines(ObjGfxMeshesView const *const ctx, Vertex const centre,
                        long int const distance, Vertex3D const pos,
                        ObjVertex const vertices[], int const n)
@@ -1352,40 +1383,16 @@ void ObjGfxMeshes_plot(ObjGfxMeshes const *const meshes,
 
 static void plot_hill(
   Vertex const centre,
-  _Optional HillColData const *const hill_colours,
   _Optional BBox *const bounding_box,
-  HillCorner const (*const sides)[Hill_PolygonNumSides],
-  int const colour,
-  _Optional PaletteEntry const (*const pal)[NumColours], ObjGfxMeshStyle const style,
-  Vertex (*const screen_coords)[ObjVertexMax])
+  Vertex const (*const coords)[Hill_PolygonNumSides],
+  int const pindex,
+  _Optional PaletteEntry const (*const pal)[NumColours], ObjGfxMeshStyle const style)
 {
   DEBUGF("Plotting hill polygon\n");
 
   Vertex polygon_coords[ObjPolygonMaxSides];
-  int side = 0;
-
-  /* Get first three coordinates and test for back-facing polygon */
-  assert(side < Hill_PolygonNumSides);
-  HillCorner vertex = (*sides)[side];
-  assert(vertex < ARRAY_SIZE(*screen_coords));
-  polygon_coords[side++] = (*screen_coords)[vertex];
-
-  assert(side < Hill_PolygonNumSides);
-  vertex = (*sides)[side];
-  assert(vertex < ARRAY_SIZE(*screen_coords));
-  polygon_coords[side++] = (*screen_coords)[vertex];
-
-  assert(side < Hill_PolygonNumSides);
-  vertex = (*sides)[side];
-  assert(vertex < ARRAY_SIZE(*screen_coords));
-  polygon_coords[side++] = (*screen_coords)[vertex];
-
-  assert(side == Hill_PolygonNumSides);
-
-  if (!vector_check(polygon_coords, polygon_coords + 1, polygon_coords + 2))
-  {
-    DEBUGF("Cull back-facing hill polygon\n");
-    return;
+  for (int side = 0; side < Hill_PolygonNumSides; ++side) {
+    polygon_coords[side] = (*coords)[side];
   }
 
   /* Finally, we get to plot the polygon on the screen! */
@@ -1395,10 +1402,9 @@ static void plot_hill(
     break;
 
   case ObjGfxMeshStyle_Filled:
-    if (pal && hill_colours) {
-      int const pindex = hillcol_get_colour(&*hill_colours, colour);
+    if (pal && pindex >= 0) {
       assert(pindex <= (int)ARRAY_SIZE(*pal));
-      plot_set_col((*pal)[pindex]);
+      set_colour((*pal)[pindex]);
     }
     plot_filled(&polygon_coords, centre, Hill_PolygonNumSides);
     break;
@@ -1411,17 +1417,21 @@ static void plot_hill(
   }
 }
 
-void ObjGfxMeshes_plot_poly_hill(ObjGfxMeshesView const *const ctx,
-                                 _Optional HillColData const *hill_colours,
-                                 HillType const type,
-                                 _Optional unsigned char (*const colours)[Hill_MaxPolygons],
-                                 unsigned char (*const heights)[HillCorner_Count],
-                                 Vertex const centre, long int const distance,
-                                 Vertex3D const pos,
-                                 _Optional PaletteEntry const (*const pal)[NumColours],
-                                 _Optional BBox *const bounding_box,
-                                 ObjGfxMeshStyle const style)
+void ObjGfxMeshes_get_poly_hill(ObjGfxMeshesView const *const ctx,
+                                _Optional HillColData const *hill_colours,
+                                HillType const type,
+                                _Optional unsigned char (*const colours)[Hill_MaxPolygons],
+                                unsigned char (*const heights)[HillCorner_Count],
+                                long int const distance,
+                                Vertex3D const pos,
+                                ObjGfxHillGeom *const geom)
 {
+  assert(geom);
+  geom->num_polygons = 0;
+
+  if (type == HillType_None) {
+    return;
+  }
 
   Vertex3D obj_pos = pos;
 
@@ -1460,14 +1470,6 @@ void ObjGfxMeshes_plot_poly_hill(ObjGfxMeshesView const *const ctx,
   static Vertex screen_coords[ObjVertexMax];
   to_screen_coords(HillCorner_Count, ctx->map_scaler, rot_vertices, screen_coords);
 
-  if (bounding_box != NULL)
-  {
-    bounding_box->xmin = INT_MAX;
-    bounding_box->ymin = INT_MAX;
-    bounding_box->xmax = INT_MIN;
-    bounding_box->ymax = INT_MIN;
-  }
-
   static HillCorner const sides[HillType_Count][Hill_MaxPolygons][Hill_PolygonNumSides] = {
     [HillType_ABCA_ACDA] = {{HillCorner_A, HillCorner_B, HillCorner_C},
                             {HillCorner_A, HillCorner_C, HillCorner_D}},
@@ -1479,16 +1481,70 @@ void ObjGfxMeshes_plot_poly_hill(ObjGfxMeshesView const *const ctx,
     [HillType_CDAC] = {{HillCorner_C, HillCorner_D, HillCorner_A}},
   };
 
-  int p = 0;
-  int colour = colours ? (*colours)[p] : 0;
-  plot_hill(centre, hill_colours, bounding_box, &sides[type][p++], colour, pal, style, &screen_coords);
+  int const num_polygons =
+    (type == HillType_ABCA_ACDA || type == HillType_ABDA_BCDB) ? 2 : 1;
+
+  for (int p = 0; p < num_polygons; ++p) {
+    Vertex (*const coords)[Hill_PolygonNumSides] = &geom->coords[geom->num_polygons];
+    for (int side = 0; side < Hill_PolygonNumSides; ++side) {
+      HillCorner const vertex = sides[type][p][side];
+      assert(vertex < ARRAY_SIZE(screen_coords));
+      (*coords)[side] = screen_coords[vertex];
+    }
+
+    if (!vector_check(&(*coords)[0], &(*coords)[1], &(*coords)[2]))
+    {
+      DEBUGF("Cull back-facing hill polygon\n");
+      continue;
+    }
 
-  if (type == HillType_ABCA_ACDA || type == HillType_ABDA_BCDB) {
-    colour = colours ? (*colours)[p] : 0;
-    plot_hill(centre, hill_colours, bounding_box, &sides[type][p++], colour, pal, style, &screen_coords);
+    int const colour = colours ? (*colours)[p] : 0;
+    geom->pindex[geom->num_polygons++] =
+      hill_colours ? hillcol_get_colour(&*hill_colours, colour) : -1;
   }
 }
 
+void ObjGfxMeshes_plot_hill_geom(ObjGfxHillGeom const *const geom,
+                                 Vertex const centre,
+                                 _Optional PaletteEntry const (*const pal)[NumColours],
+                                 _Optional BBox *const bounding_box,
+                                 ObjGfxMeshStyle const style)
+{
+  assert(geom);
+  assert(geom->num_polygons >= 0);
+  assert(geom->num_polygons <= Hill_MaxPolygons);
+
+  if (bounding_box != NULL)
+  {
+    bounding_box->xmin = INT_MAX;
+    bounding_box->ymin = INT_MAX;
+    bounding_box->xmax = INT_MIN;
+    bounding_box->ymax = INT_MIN;
+  }
+
+  for (int p = 0; p < geom->num_polygons; ++p) {
+    plot_hill(centre, bounding_box, &geom->coords[p], geom->pindex[p], pal, style);
+  }
+}
+
+void ObjGfxMeshes_plot_poly_hill(ObjGfxMeshesView const *const ctx,
+                                 _Optional HillColData const *hill_colours,
+                                 HillType const type,
+                                 _Optional unsigned char (*const colours)[Hill_MaxPolygons],
+                                 unsigned char (*const heights)[HillCorner_Count],
+                                 Vertex const centre, long int const distance,
+                                 Vertex3D const pos,
+                                 _Optional PaletteEntry const (*const pal)[NumColours],
+                                 _Optional BBox *const bounding_box,
+                                 ObjGfxMeshStyle const style)
+{
+  ObjGfxHillGeom geom;
+  ObjGfxMeshes_get_poly_hill(ctx, hill_colours, type, colours, heights,
+                             distance, pos, &geom);
+
+  ObjGfxMeshes_plot_hill_geom(&geom, centre, pal, bounding_box, style);
+}
+
 
 ObjGfxAngle ObjGfxAngle_from_map(MapAngle const angle)
 {
@@ -73,6 +73,9 @@ void ObjGfxMeshes_global_init(void);
 
 _Optional TrigTable const *ObjGfxMeshes_get_trig_table(void);
 
+struct SprPoly;
+void ObjGfxMeshes_set_sprite_target(_Optional struct SprPoly *target);
+
 void ObjGfxMeshes_set_direction(ObjGfxMeshesView *ctx, ObjGfxDirection direction, int map_scaler);
 
 typedef enum {
@@ -87,6 +90,24 @@ void ObjGfxMeshes_plot(ObjGfxMeshes const *meshes, ObjGfxMeshesView const *ctx,
   _Optional PaletteEntry const (*pal)[NumColours],
   _Optional BBox *bounding_box, ObjGfxMeshStyle style);
 
+/* Projected polygons of a hill, relative to its centre on screen.
+   Back-facing polygons are omitted. */
+typedef struct {
+  int num_polygons;
+  Vertex coords[Hill_MaxPolygons][Hill_PolygonNumSides];
+  int pindex[Hill_MaxPolygons]; /* palette index, or -1 if unknown */
+} ObjGfxHillGeom;
+
+void ObjGfxMeshes_get_poly_hill(ObjGfxMeshesView const *ctx,
+  _Optional HillColData const *hill_colours,
+  HillType type, _Optional unsigned char (*colours)[Hill_MaxPolygons],
+  unsigned char (*heights)[HillCorner_Count],
+  long int distance, Vertex3D pos, ObjGfxHillGeom *geom);
+
+void ObjGfxMeshes_plot_hill_geom(ObjGfxHillGeom const *geom, Vertex centre,
+  _Optional PaletteEntry const (*pal)[NumColours],
+  _Optional BBox *bounding_box, ObjGfxMeshStyle style);
+
 void ObjGfxMeshes_plot_poly_hill(ObjGfxMeshesView const *ctx,
   _Optional HillColData const *hill_colours,
   HillType type, _Optional unsigned char (*colours)[Hill_MaxPolygons],
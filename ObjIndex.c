@@ -0,0 +1,422 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Spatial index of object bounding boxes
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+#include "stdlib.h"
+
+#include "Macros.h"
+#include "Debug.h"
+
+#include "View.h"
+#include "MapCoord.h"
+#include "Obj.h"
+#include "ObjEditCtx.h"
+#include "ObjectsEdit.h"
+#include "ObjGfxMesh.h"
+#include "ObjLayout.h"
+#include "DrawObjs.h"
+#include "ObjIndex.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+enum {
+  BucketsLog2 = 5, /* per axis, so each bucket spans about 4x4 grid locations */
+  NumBucketsPerAxis = 1 << BucketsLog2,
+  NumBuckets = NumBucketsPerAxis * NumBucketsPerAxis,
+  BucketSizeLog2 = MAP_COORDS_LIMIT_LOG2 - BucketsLog2,
+  BucketMinCapacity = 8,
+  NumRefs = Obj_RefMask + 1,
+};
+
+typedef unsigned short ObjIndexEntry; /* index of a grid location */
+
+typedef struct {
+  _Optional ObjIndexEntry *entries;
+  size_t count, capacity;
+} ObjIndexBucket;
+
+struct ObjIndex {
+  bool is_valid;
+  MapAngle angle;
+  ObjIndexBucket buckets[NumBuckets];
+  unsigned char refs[Obj_Area]; /* object type indexed at each grid location */
+  bool has_bbox[NumRefs];
+  MapArea bboxes[NumRefs]; /* selection bounding box of each object type */
+  unsigned char visited[Obj_Area / CHAR_BIT];
+};
+
+typedef struct {
+  ObjIndex *index;
+  ObjIndexEntry entry;
+  bool remove;
+  bool failed;
+} ObjIndexBucketOp;
+
+/* ---------------- Private functions ---------------- */
+
+static bool is_indexed(ObjRef const obj_ref)
+{
+  return !objects_ref_is_none(obj_ref) && !objects_ref_is_mask(obj_ref);
+}
+
+static MapPoint entry_to_coords(ObjIndexEntry const entry)
+{
+  return (MapPoint){entry % Obj_Size, entry / Obj_Size};
+}
+
+static MapArea const *get_bbox(ObjIndex *const index,
+  ObjGfxMeshes *const meshes, View const *const view, ObjRef const obj_ref)
+{
+  size_t const n = objects_ref_to_num(obj_ref);
+  assert(n < ARRAY_SIZE(index->bboxes));
+  if (!index->has_bbox[n]) {
+    index->bboxes[n] = DrawObjs_get_select_bbox(meshes, view, obj_ref);
+    index->has_bbox[n] = true;
+  }
+  return &index->bboxes[n];
+}
+
+static bool add_to_bucket(ObjIndexBucket *const bucket, ObjIndexEntry const entry)
+{
+  assert(bucket);
+  assert(bucket->count <= bucket->capacity);
+
+  if (bucket->count == bucket->capacity) {
+    size_t const new_capacity = bucket->capacity ?
+                                bucket->capacity * 2 : BucketMinCapacity;
+
+    _Optional ObjIndexEntry *const new_entries = realloc(
+      bucket->entries, sizeof(*new_entries) * new_capacity);
+
+    if (!new_entries) {
+      return false;
+    }
+    bucket->entries = new_entries;
+    bucket->capacity = new_capacity;
+  }
+
+  assert(bucket->entries);
+  bucket->entries[bucket->count++] = entry;
+  return true;
+}
+
+static void remove_from_bucket(ObjIndexBucket *const bucket, ObjIndexEntry const entry)
+{
+  assert(bucket);
+
+  for (size_t i = 0; i < bucket->count; ++i) {
+    assert(bucket->entries);
+    if (bucket->entries[i] == entry) {
+      /* Order doesn't matter so overwrite with the last entry */
+      bucket->entries[i] = bucket->entries[--bucket->count];
+      return;
+    }
+  }
+  assert("Entry not found in bucket" == NULL);
+}
+
+static MapArea get_bucket_range(MapArea const *const fine_area)
+{
+  /* Caller must clip the area to the range of valid map coordinates */
+  assert(fine_area->min.x >= 0);
+  assert(fine_area->min.y >= 0);
+  assert(fine_area->max.x < MAP_COORDS_LIMIT);
+  assert(fine_area->max.y < MAP_COORDS_LIMIT);
+
+  return (MapArea){
+    .min = MapPoint_div_log2(fine_area->min, BucketSizeLog2),
+    .max = MapPoint_div_log2(fine_area->max, BucketSizeLog2),
+  };
+}
+
+static bool bucket_op_cb(MapArea const *const piece, void *const arg)
+{
+  ObjIndexBucketOp *const op = arg;
+  assert(op);
+  MapArea const range = get_bucket_range(piece);
+
+  for (MapCoord y = range.min.y; y <= range.max.y; ++y) {
+    for (MapCoord x = range.min.x; x <= range.max.x; ++x) {
+      ObjIndexBucket *const bucket =
+        &op->index->buckets[(y * NumBucketsPerAxis) + x];
+
+      if (op->remove) {
+        remove_from_bucket(bucket, op->entry);
+      } else if (!add_to_bucket(bucket, op->entry)) {
+        op->failed = true;
+        return true; /* stop */
+      }
+    }
+  }
+  return false; /* continue */
+}
+
+static bool bucket_op(ObjIndex *const index, ObjGfxMeshes *const meshes,
+  View const *const view, ObjIndexEntry const entry, ObjRef const obj_ref,
+  bool const remove)
+{
+  /* An object's bounding box may straddle the edge of the map, in which case
+     each part of it is treated separately (as when testing for overlap). */
+  MapPoint const grid_pos = entry_to_coords(entry);
+  MapArea fine_bbox;
+  MapArea_translate(get_bbox(index, meshes, view, obj_ref),
+                    ObjLayout_map_coords_to_centre(view, grid_pos), &fine_bbox);
+
+  ObjIndexBucketOp op = {
+    .index = index,
+    .entry = entry,
+    .remove = remove,
+    .failed = false,
+  };
+  (void)MapArea_split(&fine_bbox, MAP_COORDS_LIMIT_LOG2, bucket_op_cb, &op);
+  return !op.failed;
+}
+
+static bool rebuild(ObjIndex *const index, ObjGfxMeshes *const meshes,
+  View const *const view, ObjEditContext const *const objects)
+{
+  DEBUG("Rebuilding object index for angle %d", view->config.angle);
+
+  /* Keep the allocated bucket storage for reuse */
+  for (size_t b = 0; b < ARRAY_SIZE(index->buckets); ++b) {
+    index->buckets[b].count = 0;
+  }
+  memset(index->has_bbox, 0, sizeof(index->has_bbox));
+  index->angle = view->config.angle;
+
+  MapAreaIter iter;
+  for (MapPoint p = MapAreaIter_get_first(&iter, &(MapArea){{0, 0}, {Obj_Size - 1, Obj_Size - 1}});
+       !MapAreaIter_done(&iter);
+       p = MapAreaIter_get_next(&iter))
+  {
+    ObjRef const obj_ref = ObjectsEdit_read_ref(objects, p);
+    size_t const entry = objects_coords_to_index(p);
+    index->refs[entry] = objects_ref_to_num(obj_ref);
+
+    if (is_indexed(obj_ref) &&
+        !bucket_op(index, meshes, view, (ObjIndexEntry)entry, obj_ref, false)) {
+      DEBUGF("Failed to build object index\n");
+      index->is_valid = false;
+      return false;
+    }
+  }
+
+  index->is_valid = true;
+  return true;
+}
+
+static bool ensure_valid(ObjIndex *const index, ObjGfxMeshes *const meshes,
+  View const *const view, ObjEditContext const *const objects)
+{
+  if (index->is_valid && index->angle == view->config.angle) {
+    return true;
+  }
+  return rebuild(index, meshes, view, objects);
+}
+
+static bool clip_to_map(MapArea const *const fine_area, MapArea *const clipped)
+{
+  *clipped = (MapArea){
+    .min = {HIGHEST(fine_area->min.x, 0), HIGHEST(fine_area->min.y, 0)},
+    .max = {LOWEST(fine_area->max.x, MAP_COORDS_LIMIT - 1),
+            LOWEST(fine_area->max.y, MAP_COORDS_LIMIT - 1)},
+  };
+  return MapArea_is_valid(clipped);
+}
+
+static MapCoord wrapped_distance(MapCoord const a, MapCoord const b)
+{
+  MapCoord const d = labs(a - b);
+  return LOWEST(d, MAP_COORDS_LIMIT - d);
+}
+
+/* ---------------- Public functions ---------------- */
+
+_Optional ObjIndex *ObjIndex_create(void)
+{
+  _Optional ObjIndex *const index = malloc(sizeof(*index));
+  if (index) {
+    for (size_t b = 0; b < ARRAY_SIZE(index->buckets); ++b) {
+      index->buckets[b] = (ObjIndexBucket){.entries = NULL, .count = 0, .capacity = 0};
+    }
+    index->is_valid = false;
+  }
+  return index;
+}
+
+void ObjIndex_destroy(_Optional ObjIndex *const index)
+{
+  if (index) {
+    for (size_t b = 0; b < ARRAY_SIZE(index->buckets); ++b) {
+      free(index->buckets[b].entries);
+    }
+    free(index);
+  }
+}
+
+void ObjIndex_invalidate(ObjIndex *const index)
+{
+  assert(index);
+  index->is_valid = false;
+}
+
+void ObjIndex_update(ObjIndex *const index, ObjGfxMeshes *const meshes,
+  View const *const view, ObjEditContext const *const objects,
+  MapPoint const grid_pos)
+{
+  assert(index);
+  assert(view);
+
+  if (!index->is_valid) {
+    return; /* will be rebuilt on next use */
+  }
+
+  if (index->angle != view->config.angle) {
+    index->is_valid = false;
+    return;
+  }
+
+  MapPoint const wrapped_pos = objects_wrap_coords(grid_pos);
+  size_t const entry = objects_coords_to_index(wrapped_pos);
+  ObjRef const old_ref = objects_ref_from_num(index->refs[entry]);
+  ObjRef const new_ref = ObjectsEdit_read_ref(objects, wrapped_pos);
+
+  if (old_ref.index == new_ref.index) {
+    return;
+  }
+
+  if (is_indexed(old_ref)) {
+    (void)bucket_op(index, meshes, view, (ObjIndexEntry)entry, old_ref, true);
+  }
+
+  index->refs[entry] = objects_ref_to_num(new_ref);
+
+  if (is_indexed(new_ref) &&
+      !bucket_op(index, meshes, view, (ObjIndexEntry)entry, new_ref, false)) {
+    index->is_valid = false;
+  }
+}
+
+bool ObjIndex_find_at_point(ObjIndex *const index, ObjGfxMeshes *const meshes,
+  View const *const view, ObjEditContext const *const objects,
+  MapPoint const fine_pos, ObjRef *const obj_ref_out, MapPoint *const grid_pos_out)
+{
+  assert(index);
+  assert(obj_ref_out);
+  assert(grid_pos_out);
+
+  if (!ensure_valid(index, meshes, view, objects)) {
+    return false;
+  }
+
+  *obj_ref_out = objects_ref_none();
+
+  MapArea const sample_point = {.min = fine_pos, .max = fine_pos};
+  MapArea clipped;
+  if (!clip_to_map(&sample_point, &clipped)) {
+    return true;
+  }
+
+  /* Where objects overlap, prefer the one whose centre is nearest */
+  MapCoord best_dist = 0;
+  MapArea const range = get_bucket_range(&clipped);
+  ObjIndexBucket const *const bucket =
+    &index->buckets[(range.min.y * NumBucketsPerAxis) + range.min.x];
+
+  for (size_t i = 0; i < bucket->count; ++i) {
+    assert(bucket->entries);
+    ObjIndexEntry const entry = bucket->entries[i];
+    MapPoint const grid_pos = entry_to_coords(entry);
+    ObjRef const obj_ref = objects_ref_from_num(index->refs[entry]);
+
+    if (!DrawObjs_touch_bbox(view, grid_pos, get_bbox(index, meshes, view, obj_ref),
+                             &sample_point)) {
+      continue;
+    }
+
+    MapPoint const centre = ObjLayout_map_coords_to_centre(view, grid_pos);
+    MapCoord const dist = wrapped_distance(centre.x, clipped.min.x) +
+                          wrapped_distance(centre.y, clipped.min.y);
+    if (objects_ref_is_none(*obj_ref_out) || dist < best_dist) {
+      best_dist = dist;
+      *obj_ref_out = obj_ref;
+      *grid_pos_out = grid_pos;
+    }
+  }
+
+  return true;
+}
+
+bool ObjIndex_find_in_area(ObjIndex *const index, ObjGfxMeshes *const meshes,
+  View const *const view, ObjEditContext const *const objects,
+  MapArea const *const fine_area, bool const only_inside,
+  ObjIndexFoundFn *const callback, void *const cb_arg)
+{
+  assert(index);
+  assert(MapArea_is_valid(fine_area));
+  assert(callback);
+
+  if (!ensure_valid(index, meshes, view, objects)) {
+    return false;
+  }
+
+  MapArea clipped;
+  if (!clip_to_map(fine_area, &clipped)) {
+    return true;
+  }
+
+  /* An object may be listed in more than one bucket */
+  memset(index->visited, 0, sizeof(index->visited));
+
+  MapArea const range = get_bucket_range(&clipped);
+  for (MapCoord y = range.min.y; y <= range.max.y; ++y) {
+    for (MapCoord x = range.min.x; x <= range.max.x; ++x) {
+      ObjIndexBucket const *const bucket =
+        &index->buckets[(y * NumBucketsPerAxis) + x];
+
+      for (size_t i = 0; i < bucket->count; ++i) {
+        assert(bucket->entries);
+        ObjIndexEntry const entry = bucket->entries[i];
+        unsigned char const bit = 1u << (entry % CHAR_BIT);
+        if (index->visited[entry / CHAR_BIT] & bit) {
+          continue;
+        }
+        index->visited[entry / CHAR_BIT] |= bit;
+
+        MapPoint const grid_pos = entry_to_coords(entry);
+        ObjRef const obj_ref = objects_ref_from_num(index->refs[entry]);
+        MapArea const *const bbox = get_bbox(index, meshes, view, obj_ref);
+
+        if (only_inside ? DrawObjs_in_bbox(view, grid_pos, bbox, fine_area) :
+                          DrawObjs_touch_bbox(view, grid_pos, bbox, fine_area)) {
+          callback(grid_pos, obj_ref, cb_arg);
+        }
+      }
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,49 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Spatial index of object bounding boxes
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef ObjIndex_h
+#define ObjIndex_h
+
+#include <stdbool.h>
+
+#include "MapCoord.h"
+#include "Obj.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+struct View;
+struct ObjGfxMeshes;
+struct ObjEditContext;
+
+typedef struct ObjIndex ObjIndex;
+
+/* An index of the selection bounding boxes of objects in a view, bucketed
+   by fine (screen) coordinates. It is built on first use and must be
+   invalidated whenever the objects, their meshes or the set of visible
+   layers are replaced. */
+_Optional ObjIndex *ObjIndex_create(void);
+void ObjIndex_destroy(_Optional ObjIndex *index);
+
+void ObjIndex_invalidate(ObjIndex *index);
+
+void ObjIndex_update(ObjIndex *index, struct ObjGfxMeshes *meshes,
+  struct View const *view, struct ObjEditContext const *objects,
+  MapPoint grid_pos);
+
+bool ObjIndex_find_at_point(ObjIndex *index, struct ObjGfxMeshes *meshes,
+  struct View const *view, struct ObjEditContext const *objects,
+  MapPoint fine_pos, ObjRef *obj_ref_out, MapPoint *grid_pos_out);
+
+typedef void ObjIndexFoundFn(MapPoint grid_pos, ObjRef obj_ref, void *arg);
+
+bool ObjIndex_find_in_area(ObjIndex *index, struct ObjGfxMeshes *meshes,
+  struct View const *view, struct ObjEditContext const *objects,
+  MapArea const *fine_area, bool only_inside,
+  ObjIndexFoundFn *callback, void *cb_arg);
+
+#endif
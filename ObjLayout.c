@@ -109,6 +109,23 @@ MapPoint ObjLayout_derotate_scr_coords_to_map(MapAngle const angle, MapPoint con
   return pos;
 }
 
+MapPoint ObjLayout_derotate_scr_row_step(MapAngle const angle)
+{
+  /* Change in objects grid coordinates per screen column */
+  switch (angle) {
+  case MapAngle_Count:
+  case MapAngle_North:
+    break;
+  case MapAngle_East:
+    return (MapPoint){0, -1};
+  case MapAngle_South:
+    return (MapPoint){-1, 0};
+  case MapAngle_West:
+    return (MapPoint){0, 1};
+  }
+  return (MapPoint){1, 0};
+}
+
 MapPoint ObjLayout_map_coords_to_fine(View const *const view, MapPoint const pos)
 {
   /* Calculate the corner of the grid location closest to the grid's origin in fine screen coordinates.
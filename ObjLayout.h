@@ -22,6 +22,7 @@ MapArea ObjLayout_map_area_to_centre(struct View const *view, MapArea const *are
 
 /* Screen coordinates to map coordinates */
 MapPoint ObjLayout_derotate_scr_coords_to_map(MapAngle angle, MapPoint pos);
+MapPoint ObjLayout_derotate_scr_row_step(MapAngle angle);
 MapPoint ObjLayout_map_coords_from_fine(struct View const *view, MapPoint pos);
 MapPoint ObjLayout_scr_coords_from_fine(struct View const *view, MapPoint pos);
 MapArea ObjLayout_map_area_from_fine(struct View const *view, MapArea const *area);
@@ -40,6 +40,8 @@
 #include "Shapes.h"
 #include "Triggers.h"
 #include "ObjEditSel.h"
+#include "ObjCollMap.h"
+#include "ObjFlat.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -128,6 +130,9 @@ static ObjRef filter_overlay_ref(ObjEditContext const *const objects,
 static ObjRef read_ref_core(ObjEditContext const *const objects,
   MapPoint const pos)
 {
+  if (objects->flat) {
+    return ObjFlat_read_ref(&*objects->flat, objects, pos);
+  }
   return filter_overlay_ref(objects, pos, read_overlay_core(objects, pos));
 }
 
@@ -154,6 +159,15 @@ static bool write_ref_core(ObjEditContext const *const objects, MapPoint const p
 
   ObjEditChanges_change_ref(change_info);
 
+  /* The collision map reads the flattened grid, so update that first */
+  if (objects->flat) {
+    ObjFlat_update(&*objects->flat, objects, wrapped_pos);
+  }
+
+  if (objects->coll_map) {
+    ObjCollMap_update(&*objects->coll_map, objects, wrapped_pos);
+  }
+
   if (objects->redraw_obj_cb) {
     bool const has_triggers = objects->triggers && triggers_check_locn(&*objects->triggers, wrapped_pos);
     objects->redraw_obj_cb(wrapped_pos, read_base_core(objects, wrapped_pos), old_ref,
@@ -232,6 +246,14 @@ static void clear_overlapped(ObjEditContext const *const objects,
 
   MapPoint const my_coll_size = get_coll_size(meshes, new_disp_ref);
   MapArea const my_obj_area = {MapPoint_sub(grid_pos, my_coll_size), MapPoint_add(grid_pos, my_coll_size)};
+
+  /* The object being placed covers its own collision box once */
+  if (objects->coll_map &&
+      ObjCollMap_is_vacant(&*objects->coll_map, meshes, objects, &my_obj_area,
+                           objects_ref_is_none(new_disp_ref) ? 0 : 1)) {
+    return;
+  }
+
   MapPoint const max_coll_size = ObjGfxMeshes_get_max_collision_size(meshes);
 
   MapArea const overlapping_area = {
@@ -431,6 +453,20 @@ void ObjectsEdit_plot_circ(ObjEditContext *const objects,
   Shapes_circ(write_shape, &context, centre, radius);
 }
 
+void ObjectsEdit_plot_stroke(ObjEditContext *const objects,
+  ShapesStroke *const stroke, MapPoint const start, MapPoint const end,
+  ObjRef const value, MapCoord const thickness,
+  ObjEditChanges *const change_info, ObjGfxMeshes *const meshes)
+{
+  WriteShapeContext context = {
+    .objects = objects,
+    .obj_ref = value,
+    .change_info = change_info,
+    .meshes = meshes,
+  };
+  Shapes_stroke(stroke, write_shape, &context, start, end, thickness);
+}
+
 void ObjectsEdit_global_replace(ObjEditContext *const objects,
   ObjRef const find, ObjRef const replace, ObjEditChanges *const change_info,
   ObjGfxMeshes *const meshes)
@@ -825,6 +861,14 @@ bool ObjectsEdit_can_place(ObjEditContext const *const objects, MapPoint const g
 
     MapPoint const my_coll_size = get_coll_size(meshes, new_disp_ref);
     MapArea const my_obj_area = {MapPoint_sub(grid_pos, my_coll_size), MapPoint_add(grid_pos, my_coll_size)};
+
+    if (objects->coll_map &&
+        ObjCollMap_is_vacant(&*objects->coll_map, meshes, objects, &my_obj_area, 0)) {
+      DEBUGF("Can place object %d at %" PRIMapCoord ",%" PRIMapCoord " (vacant)\n",
+             objects_ref_to_num(value), grid_pos.x, grid_pos.y);
+      return true;
+    }
+
     MapPoint const max_coll_size = ObjGfxMeshes_get_max_collision_size(meshes);
 
     MapArea const overlapping_area = {
@@ -883,13 +927,27 @@ bool ObjectsEdit_can_copy_to_area(ObjEditContext const *const objects,
   assert(MapArea_is_valid(area));
   assert(read);
 
+  /* If no collision box touches the destination area (extended by the
+     largest collision size) then nothing can be occluded. */
+  _Optional ObjEditSelection *area_occluded = occluded;
+  if (occluded && objects->coll_map) {
+    MapPoint const max_coll_size = ObjGfxMeshes_get_max_collision_size(meshes);
+    MapArea const overlapping_area = {
+      MapPoint_sub(area->min, max_coll_size),
+      MapPoint_add(area->max, max_coll_size)
+    };
+    if (ObjCollMap_is_vacant(&*objects->coll_map, meshes, objects, &overlapping_area, 0)) {
+      area_occluded = NULL;
+    }
+  }
+
   MapAreaIter iter;
   for (MapPoint p = MapAreaIter_get_first(&iter, area);
        !MapAreaIter_done(&iter);
        p = MapAreaIter_get_next(&iter))
   {
     ObjRef const obj_ref = read(cb_arg, MapPoint_sub(p, area->min));
-    if (!ObjectsEdit_can_place(objects, p, obj_ref, meshes, occluded)) {
+    if (!ObjectsEdit_can_place(objects, p, obj_ref, meshes, area_occluded)) {
       return false;
     }
   }
@@ -19,6 +19,7 @@
 struct ObjGfxMeshes;
 struct ObjEditChanges;
 struct ObjEditSelection;
+struct ShapesStroke;
 
 typedef enum {
   TriggersWipeAction_None,
@@ -49,6 +50,10 @@ void ObjectsEdit_plot_line(ObjEditContext *objects, MapPoint start,
   MapPoint end, ObjRef value, MapCoord thickness, struct ObjEditChanges *change_info,
   struct ObjGfxMeshes *meshes);
 
+void ObjectsEdit_plot_stroke(ObjEditContext *objects, struct ShapesStroke *stroke,
+  MapPoint start, MapPoint end, ObjRef value, MapCoord thickness,
+  struct ObjEditChanges *change_info, struct ObjGfxMeshes *meshes);
+
 void ObjectsEdit_global_replace(ObjEditContext *objects,
   ObjRef find, ObjRef replace, struct ObjEditChanges *change_info,
   struct ObjGfxMeshes *meshes);
@@ -76,7 +76,9 @@
 #include "Shapes.h"
 #include "DrawObjs.h"
 #include "ObjLayout.h"
+#include "ObjIndex.h"
 #include "ObjEditChg.h"
+#include "NumGlyphs.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -101,6 +103,8 @@ typedef struct
   MapArea drop_bbox, ghost_bbox;
   ObjSnakesContext snake_ctx;
   ObjPropDboxes prop_dboxes;
+  ShapesStroke stroke; /* cells already painted by the brush */
+  _Optional NumGlyphs *num_glyphs; /* created on first use, if any */
 }
 ObjectsModeData;
 
@@ -214,7 +218,7 @@ static void draw_area_as_ghost(MapArea const *const bbox, void *const cb_arg)
     MapArea const scr_area = ObjLayout_rotate_map_area_to_scr(args->view->config.angle, args->overlapping_area);
     DrawObjs_to_screen(args->poly_colours, args->hill_colours, args->clouds, args->meshes,
                        args->view, &scr_area, read_ghost_obj, read_ghost_hill, args,
-                       NULL, NULL, args->min_os, true, NULL);
+                       NULL, NULL, NULL, args->min_os, true, NULL);
   }
 }
 
@@ -318,7 +322,7 @@ static void draw_ghost_paste(ObjTransfer *const transfer,
   DrawObjs_to_screen(poly_colours, hill_colours, clouds, meshes, view,
                      &scr_area, read_transfer, read_ghost_hill,
                      &transfer_args,
-                     NULL, NULL, scr_orig, true, NULL);
+                     NULL, NULL, NULL, scr_orig, true, NULL);
 }
 
 static void draw_pending(ObjectsModeData const *const mode_data, ObjEditContext const *const objects,
@@ -444,6 +448,7 @@ void ObjectsMode_draw(Editor *const editor,
   DrawObjs_to_screen(poly_colours, hill_colours, clouds, meshes, EditWin_get_view(edit_win), &scr_area,
                      read_obj_ctx->base ? redraw_read_grid : redraw_read_overlay,
                      read_hill, &read_args,
+                     EditWin_get_hill_cache(edit_win),
                      read_obj_ctx->triggers,
                      selection, scr_orig, false, occluded);
 
@@ -854,7 +859,7 @@ static ObjRef read_ref_if_select_encloses(ObjGfxMeshes *const meshes, View const
 }
 
 static ObjRef get_obj_at_point(ObjGfxMeshes *const meshes, View const *const view,
-  ObjEditContext const *const read_obj_ctx,
+  ObjEditContext const *const read_obj_ctx, _Optional ObjIndex *const index,
   MapPoint const fine_pos, MapPoint *const grid_coords_out)
 {
   /* If there is an object at the specified grid location then return its
@@ -875,6 +880,10 @@ static ObjRef get_obj_at_point(ObjGfxMeshes *const meshes, View const *const vie
   if (!objects_ref_is_none(obj_ref)) {
     DEBUG("Found object %d at exact location", objects_ref_to_num(obj_ref));
     *grid_coords_out = search_centre;
+  } else if (index &&
+             ObjIndex_find_at_point(&*index, meshes, view, read_obj_ctx, fine_pos,
+                                    &obj_ref, grid_coords_out)) {
+    DEBUG("Searched object index");
   } else {
     /* Nothing at the specified grid location, so search outwards  */
     MapArea overlapping_area;
@@ -903,12 +912,46 @@ static ObjRef get_obj_at_point(ObjGfxMeshes *const meshes, View const *const vie
   return obj_ref;
 }
 
+typedef struct {
+  ObjEditSelection *selected;
+  _Optional MapArea *changed_grid;
+  bool do_redraw;
+  bool is_changed;
+} DragSelectInvertContext;
+
+static void drag_select_invert_cb(MapPoint const grid_pos, ObjRef const obj_ref,
+  void *const arg)
+{
+  NOT_USED(obj_ref);
+  DragSelectInvertContext *const context = arg;
+  assert(context);
+
+  ObjEditSelection_invert(context->selected, grid_pos, context->do_redraw);
+  context->is_changed = true;
+  if (context->changed_grid) {
+    MapArea_expand(&*context->changed_grid, grid_pos);
+  }
+}
+
 static bool drag_select_invert(ObjGfxMeshes *const meshes, View const *const view,
   ObjEditSelection *const selected,
-  ObjEditContext const *const objects,
+  ObjEditContext const *const objects, _Optional ObjIndex *const index,
   bool const only_inside, MapArea const *select_box,
   _Optional MapArea *const changed_grid, bool const do_redraw)
 {
+  if (index) {
+    DragSelectInvertContext context = {
+      .selected = selected,
+      .changed_grid = changed_grid,
+      .do_redraw = do_redraw,
+      .is_changed = false,
+    };
+    if (ObjIndex_find_in_area(&*index, meshes, view, objects, select_box,
+                              only_inside, drag_select_invert_cb, &context)) {
+      return context.is_changed;
+    }
+  }
+
   bool is_changed = false;
   MapArea overlapping_area;
   DrawObjs_get_overlapping_select_area(meshes, view, select_box, &overlapping_area);
@@ -962,10 +1005,12 @@ static void ObjectsMode_update_select(Editor *const editor, bool const only_insi
 
   // Undo the current selection bounding box by inverting the state of objects within it
   bool changed = drag_select_invert(meshes, view, &mode_data->selection, read_obj_ctx,
+                                  EditWin_get_obj_index(edit_win),
                                   only_inside, last_select_box, &changed_grid, false);
 
   // Apply the new selection bounding box by inverting the state of objects within it
-  if (!drag_select_invert(meshes, view, &mode_data->selection, read_obj_ctx, only_inside,
+  if (!drag_select_invert(meshes, view, &mode_data->selection, read_obj_ctx,
+                        EditWin_get_obj_index(edit_win), only_inside,
                         select_box, &changed_grid, false) &&
       !changed) {
     return;
@@ -988,6 +1033,7 @@ static void ObjectsMode_cancel_select(Editor *const editor,
   View const *const view = EditWin_get_view(edit_win);
 
   drag_select_invert(meshes, view, &mode_data->selection, read_obj_ctx,
+                     EditWin_get_obj_index(edit_win),
                      only_inside, last_select_box, NULL, true);
 }
 
@@ -1049,7 +1095,7 @@ static bool ObjectsMode_start_select(Editor *const editor, bool const only_insid
 
   MapPoint sel_coords;
   ObjRef const obj_ref = get_obj_at_point(meshes, view, read_obj_ctx,
-    fine_pos, &sel_coords);
+    EditWin_get_obj_index(edit_win), fine_pos, &sel_coords);
 
   if (!objects_ref_is_none(obj_ref)) {
     ObjEditSelection_invert(&mode_data->selection, sel_coords, true);
@@ -1071,7 +1117,7 @@ static bool ObjectsMode_start_exclusive_select(Editor *const editor, bool const
 
   MapPoint sel_coords;
   ObjRef const obj_ref = get_obj_at_point(meshes, view, read_obj_ctx,
-    fine_pos, &sel_coords);
+    EditWin_get_obj_index(edit_win), fine_pos, &sel_coords);
 
   if (!objects_ref_is_none(obj_ref)) {
     if (!ObjEditSelection_is_selected(&mode_data->selection, sel_coords)) {
@@ -1102,7 +1148,8 @@ static void ObjectsMode_edit_properties_at_pos(Editor *const editor, MapPoint co
   View const *const view = EditWin_get_view(edit_win);
 
   MapPoint sel_coords;
-  ObjRef const obj_ref = get_obj_at_point(meshes, view, read_obj_ctx, fine_pos, &sel_coords);
+  ObjRef const obj_ref = get_obj_at_point(meshes, view, read_obj_ctx,
+    EditWin_get_obj_index(edit_win), fine_pos, &sel_coords);
 
   if (!objects_ref_is_none(obj_ref)) {
     ObjPropDboxes_open(&mode_data->prop_dboxes, sel_coords, edit_win);
@@ -1141,7 +1188,8 @@ static void ObjectsMode_sample_obj(Editor *const editor, MapPoint const fine_pos
   View const *const view = EditWin_get_view(edit_win);
 
   MapPoint grid_coords;
-  ObjRef obj_ref = get_obj_at_point(meshes, view, read_obj_ctx, fine_pos, &grid_coords);
+  ObjRef obj_ref = get_obj_at_point(meshes, view, read_obj_ctx,
+    EditWin_get_obj_index(edit_win), fine_pos, &grid_coords);
   /*if (objects_ref_is_none(obj_ref)) {
     obj_ref = ObjectsEdit_read_ref(read_obj_ctx, ObjLayout_map_coords_from_fine(EditWin_get_view(edit_win), fine_pos));
   }*/
@@ -1162,7 +1210,8 @@ static void ObjectsMode_pending_fill(Editor *const editor, MapPoint const fine_p
 
   ObjEditContext const *const read_obj_ctx = EditWin_get_read_obj_ctx(edit_win);
   MapPoint flood_coords;
-  if (objects_ref_is_none(get_obj_at_point(meshes, view, read_obj_ctx, fine_pos, &flood_coords))) {
+  if (objects_ref_is_none(get_obj_at_point(meshes, view, read_obj_ctx,
+    EditWin_get_obj_index(edit_win), fine_pos, &flood_coords))) {
     flood_coords = map_pos;
   }
 
@@ -1192,7 +1241,8 @@ static void ObjectsMode_flood_fill(Editor *const editor, MapPoint const fine_pos
 
   ObjEditContext const *const read_obj_ctx = EditWin_get_read_obj_ctx(edit_win);
   MapPoint flood_coords;
-  if (objects_ref_is_none(get_obj_at_point(meshes, view, read_obj_ctx, fine_pos, &flood_coords))) {
+  if (objects_ref_is_none(get_obj_at_point(meshes, view, read_obj_ctx,
+    EditWin_get_obj_index(edit_win), fine_pos, &flood_coords))) {
     flood_coords = map_pos;
   }
 
@@ -1220,7 +1270,8 @@ static void ObjectsMode_global_replace(Editor *const editor, MapPoint const fine
 
   ObjEditContext const *const read_obj_ctx = EditWin_get_read_obj_ctx(edit_win);
   MapPoint replace_coords;
-  ObjRef find = get_obj_at_point(meshes, view, read_obj_ctx, fine_pos, &replace_coords);
+  ObjRef find = get_obj_at_point(meshes, view, read_obj_ctx,
+    EditWin_get_obj_index(edit_win), fine_pos, &replace_coords);
   if (objects_ref_is_none(find)) {
     find = ObjectsEdit_read_ref(objects, map_pos);
   }
@@ -1279,8 +1330,9 @@ static void ObjectsMode_start_brush(Editor *const editor, int brush_size,
     brush_size = 0;
   }
 
-  ObjectsEdit_plot_circ(objects, map_pos, brush_size, obj_ref,
-                        &mode_data->change_info, meshes);
+  Shapes_stroke_init(&mode_data->stroke, Obj_SizeLog2);
+  ObjectsEdit_plot_stroke(objects, &mode_data->stroke, map_pos, map_pos,
+                          obj_ref, brush_size, &mode_data->change_info, meshes);
 
   changed_with_msg(editor);
 }
@@ -1305,8 +1357,8 @@ static void ObjectsMode_draw_brush(Editor *const editor, int const brush_size,
     (MapPoint){0,0} : ObjGfxMeshes_get_collision_size(meshes, obj_ref);
 
   if (size.x == 0 && size.y == 0) {
-    ObjectsEdit_plot_line(objects, last_map_pos, map_pos, obj_ref,
-      brush_size, &mode_data->change_info, meshes);
+    ObjectsEdit_plot_stroke(objects, &mode_data->stroke, last_map_pos,
+      map_pos, obj_ref, brush_size, &mode_data->change_info, meshes);
 
     changed_with_msg(editor);
   }
@@ -1466,6 +1518,14 @@ static void ObjectsMode_draw_numbers(Editor *const editor,
     return;
   }
 
+  /* Plot pre-rendered numbers unless they would be too big */
+  int const rubout_margin = SIGNED_R_SHIFT(2, zoom);
+  if (!mode_data->num_glyphs) {
+    mode_data->num_glyphs = NumGlyphs_create();
+  }
+  bool use_glyphs = mode_data->num_glyphs &&
+    NumGlyphs_prepare(&*mode_data->num_glyphs, handle, font_size, rubout_margin);
+
   /* Calculate which rows and columns to redraw */
   MapArea const scr_area = ObjLayout_scr_area_from_fine(EditWin_get_view(edit_win), redraw_area);
 
@@ -1496,12 +1556,16 @@ static void ObjectsMode_draw_numbers(Editor *const editor,
   BBox underline_bbox = {0,0,0,0};
   MapAngle const angle = EditWin_get_angle(edit_win);
 
+  MapPoint const row_step = ObjLayout_derotate_scr_row_step(angle);
+
   for (MapPoint scr_pos = {.y = scr_area.min.y}; scr_pos.y <= scr_area.max.y; scr_pos.y++) {
     coord.x = scr_orig.x + (scr_area.min.x * grid_size.x) + (grid_size.x / 2l);
+    scr_pos.x = scr_area.min.x;
+    MapPoint map_pos = ObjLayout_derotate_scr_coords_to_map(angle, scr_pos);
 
-    for (scr_pos.x = scr_area.min.x; scr_pos.x <= scr_area.max.x; scr_pos.x++) {
+    for (; scr_pos.x <= scr_area.max.x;
+         scr_pos.x++, coord.x += grid_size.x, map_pos = MapPoint_add(map_pos, row_step)) {
       PaletteEntry font_fg_colour, font_bg_colour;
-      MapPoint const map_pos = ObjLayout_derotate_scr_coords_to_map(angle, scr_pos);
       ObjRef const obj_ref = ObjectsEdit_read_ref(read_obj_ctx, map_pos);
 
       bool const is_sel = ObjEditSelection_is_selected(&mode_data->selection, map_pos);
@@ -1510,6 +1574,21 @@ static void ObjectsMode_draw_numbers(Editor *const editor,
                        MaxBrightness/2 ? PAL_BLACK : PAL_WHITE;
 
       unsigned char const this_obj = objects_ref_to_num(obj_ref);
+
+      if (use_glyphs) {
+        bool const has_trigger = objects->triggers &&
+                                 triggers_check_locn(&*objects->triggers, map_pos);
+
+        if (NumGlyphs_plot(&*mode_data->num_glyphs, this_obj, has_trigger,
+                           font_bg_colour, font_fg_colour, coord)) {
+          continue;
+        }
+
+        /* Rendering the images may have changed the font colours */
+        use_glyphs = false;
+        last_bg_colour = last_fg_colour = 1;
+      }
+
       if (last_obj != this_obj) {
         sprintf(string, "%d", this_obj);
         plot_get_string_bbox(handle, string, &text_bbox);
@@ -1539,7 +1618,6 @@ static void ObjectsMode_draw_numbers(Editor *const editor,
       };
 
       /* Use bounding box from Font_ScanString as rubout box for Font_Paint */
-      int const rubout_margin = SIGNED_R_SHIFT(2, zoom);
       BBox const rubout = {
         font_coord.x + combined_bbox.xmin - rubout_margin,
         font_coord.y + combined_bbox.ymin - rubout_margin,
@@ -1565,8 +1643,6 @@ static void ObjectsMode_draw_numbers(Editor *const editor,
       if (is_underlined) {
         plot_font(handle, underline, NULL, font_coord, false);
       }
-
-      coord.x += grid_size.x;
     } /* next scr_pos.x */
 
     coord.y += grid_size.y;
@@ -1774,7 +1850,8 @@ static bool ObjectsMode_auto_select(Editor *const editor, MapPoint const fine_po
   }
 
   MapPoint grid_coords;
-  ObjRef const obj_ref = get_obj_at_point(meshes, view, read_obj_ctx, fine_pos, &grid_coords);
+  ObjRef const obj_ref = get_obj_at_point(meshes, view, read_obj_ctx,
+    EditWin_get_obj_index(edit_win), fine_pos, &grid_coords);
   if (objects_ref_is_none(obj_ref)) {
     return false;
   }
@@ -1802,6 +1879,7 @@ static void ObjectsMode_leave(Editor *const editor)
   ObjEditSelection_destroy(&mode_data->selection);
   ObjEditSelection_destroy(&mode_data->occluded);
   ObjEditSelection_destroy(&mode_data->tmp);
+  NumGlyphs_destroy(mode_data->num_glyphs);
   free(mode_data);
 }
 
@@ -2144,7 +2222,11 @@ static bool ObjectsMode_show_ghost_drop(Editor *const editor,
         return hide_origin_bbox;
       }
 
-      Editor_redraw_ghost(editor); // undraw
+      /* Unknown objects look the same at every location, so only redraw
+         the locations that the ghost entered or left */
+      Editor_move_ghost_unknown_obj(editor, bbox);
+      mode_data->drop_bbox = *bbox;
+      return hide_origin_bbox;
     }
 
     ObjectsMode_wipe_ghost(editor);
@@ -2562,8 +2644,9 @@ bool ObjectsMode_can_enter(Editor *const editor)
 {
   EditSession *const session = Editor_get_session(editor);
 
-  return Session_has_data(session, DataType_BaseObjects) ||
-         Session_has_data(session, DataType_OverlayObjects);
+  return (Session_has_data(session, DataType_BaseObjects) ||
+          Session_has_data(session, DataType_OverlayObjects)) &&
+         Session_objects_ready(session);
 }
 
 bool ObjectsMode_enter(Editor *const editor)
@@ -56,6 +56,7 @@
 #include "Obj.h"
 #include "FilenamesData.h"
 #include "DrawCloud.h"
+#include "SprPoly.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -473,8 +474,34 @@ static void redraw_object(Editor *const editor, Vertex origin, BBox const *bbox,
       }
       else if (!objects_ref_is_none(obj_ref))
       {
+        /* Bypass the OS when plotting polygons into an 8bpp back buffer */
+        _Optional SpriteHeader *sprite = NULL;
+        SprPoly sprite_target;
+        if (selected && Desktop_get_log2bpp() == SprPolyLog2BPP) {
+          sprite = SprMem_get_sprite_address(&back_buffer, "tmp");
+          if (sprite) {
+            if (SprPoly_init_sprite(&sprite_target, &*sprite,
+                                    Desktop_get_eigen_factors(), palette)) {
+              /* Only rasterise the part of the cell being redrawn
+                 (the graphics window is inclusive but the clip is not) */
+              BBox clip;
+              BBox_translate(&temp_window,
+                Vertex_sub((Vertex){0, 0}, BBox_get_min(&plot_bbox)), &clip);
+              clip.xmax++;
+              clip.ymax++;
+              SprPoly_set_clip(&sprite_target, &clip);
+              ObjGfxMeshes_set_sprite_target(&sprite_target);
+            }
+          }
+        }
+
         ObjGfxMeshes_plot(&redraw_graphics->meshes, ctx, poly_colours, obj_ref,
           plot_centre, distance, pos, palette, NULL, ObjGfxMeshStyle_Filled);
+
+        if (sprite) {
+          ObjGfxMeshes_set_sprite_target(NULL);
+          SprMem_put_sprite_address(&back_buffer, &*sprite);
+        }
       }
     }
 
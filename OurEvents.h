@@ -89,6 +89,7 @@ enum
   EVENT_ROTATE_ANTICLOCKWISE = 84,
   EVENT_SET_DEFAULT_MODE_CHOICES  = 85,
   EVENT_SET_DEFAULT_TOOL_CHOICES = 86,
+  EVENT_NAVIGATOR = 87,
 };
 
 #endif
@@ -79,6 +79,12 @@ typedef enum {
   ReformatAction_OnlyIfWidthChanged,
 } ReformatAction;
 
+typedef struct {
+  int first, last; /* range of indices of items that moved */
+  int delta; /* distance moved by each item (-1 or +1) */
+  int dirty; /* index of location to redraw, or NULL_DATA_INDEX */
+} ItemShift;
+
 #define PALETTE_KEEP_VISIBLE_AREA 0
 
 /* ---------------- Private functions ---------------- */
@@ -132,13 +138,96 @@ static BBox bbox_for_object(PaletteData const *const pal_data, Vertex const grid
                 X_BORDER + object_max.x, -Y_BORDER - object_min.y};
 }
 
+static bool has_custom_layout(PaletteData const *const pal_data)
+{
+  assert(pal_data != NULL);
+  return !pal_data->numeric_order && pal_data->client_functions != NULL &&
+         pal_data->client_functions->grid_to_index;
+}
+
+static bool is_sequential(PaletteData const *const pal_data)
+{
+  assert(pal_data != NULL);
+  return pal_data->numeric_order || pal_data->client_functions == NULL ||
+         (!pal_data->client_functions->grid_to_index &&
+          !pal_data->client_functions->index_to_grid);
+}
+
+static void free_layout(PaletteData *const pal_data)
+{
+  assert(pal_data != NULL);
+  free(pal_data->layout_indices);
+  pal_data->layout_indices = NULL;
+  free(pal_data->layout_positions);
+  pal_data->layout_positions = NULL;
+}
+
+static void cache_layout(PaletteData *const pal_data)
+{
+  /* Searching a custom layout can be slow, so ask the client for the item at
+     every grid location once, instead of once per location redrawn. */
+  assert(pal_data != NULL);
+  free_layout(pal_data);
+
+  if (!has_custom_layout(pal_data) ||
+      pal_data->grid_size.x < 1 || pal_data->grid_size.y < 1)
+  {
+    return;
+  }
+  const struct PaletteClientFuncts *client_functions = &*pal_data->client_functions;
+
+  size_t const ncells = (size_t)pal_data->grid_size.x * (size_t)pal_data->grid_size.y;
+  size_t const nitems = (size_t)HIGHEST(pal_data->num_indices, 1);
+  _Optional int *const indices = malloc(sizeof(*indices) * ncells);
+  _Optional Vertex *const positions = malloc(sizeof(*positions) * nitems);
+  if (!indices || !positions)
+  {
+    DEBUG("No memory to cache palette layout");
+    free(indices);
+    free(positions);
+    return; /* ask the client instead */
+  }
+
+  for (size_t index = 0; index < nitems; ++index)
+  {
+    positions[index] = (Vertex){-1, -1}; /* not in layout */
+  }
+
+  Vertex grid_pos;
+  size_t cell = 0;
+  for (grid_pos.y = 0; grid_pos.y < pal_data->grid_size.y; ++grid_pos.y)
+  {
+    for (grid_pos.x = 0; grid_pos.x < pal_data->grid_size.x; ++grid_pos.x)
+    {
+      int const index = client_functions->grid_to_index(
+        pal_data->parent_editor, grid_pos, (int)pal_data->grid_size.x);
+
+      indices[cell++] = index;
+      if (index >= 0 && index < pal_data->num_indices)
+      {
+        positions[index] = grid_pos;
+      }
+    }
+  }
+
+  DEBUG("Cached palette layout of %zu locations", ncells);
+  pal_data->layout_indices = indices;
+  pal_data->layout_positions = positions;
+}
+
 static Vertex grid_from_index(PaletteData *const pal_data, int const index)
 {
   assert(pal_data != NULL);
   assert(index <= pal_data->num_indices); /* intentional for deletion of last object */
 
   Vertex grid_pos = {0,0};
-  if (!pal_data->numeric_order &&
+  if (pal_data->layout_positions && index >= 0 &&
+      index < pal_data->num_indices &&
+      pal_data->layout_positions[index].x >= 0)
+  {
+    grid_pos = pal_data->layout_positions[index];
+  }
+  else if (!pal_data->numeric_order &&
       pal_data->client_functions != NULL &&
       pal_data->client_functions->index_to_grid)
   {
@@ -281,8 +370,16 @@ static int index_from_grid(PaletteData *const pal_data, Vertex grid_pos)
   assert(pal_data != NULL);
   int index = NULL_DATA_INDEX;
 
-  if (!pal_data->numeric_order && pal_data->client_functions != NULL &&
-      pal_data->client_functions->grid_to_index)
+  if (pal_data->layout_indices)
+  {
+    if (grid_pos.x >= 0 && grid_pos.x < pal_data->grid_size.x &&
+        grid_pos.y >= 0 && grid_pos.y < pal_data->grid_size.y)
+    {
+      index = pal_data->layout_indices[
+                (grid_pos.y * pal_data->grid_size.x) + grid_pos.x];
+    }
+  }
+  else if (has_custom_layout(pal_data))
   {
     DEBUGF("Calling grid-to-index function for custom layout\n");
     index = pal_data->client_functions->grid_to_index(pal_data->parent_editor,
@@ -450,19 +547,147 @@ static void redraw_below_pos(PaletteData *const pal_data, Vertex start_pos)
   }
 }
 
+static BBox bbox_for_cells(PaletteData const *const pal_data, int const row,
+  int const first_col, int const last_col)
+{
+  /* Unlike bbox_for_object, the row may be beyond the end of the layout
+     (e.g. where the last object was before it was deleted). */
+  assert(pal_data != NULL);
+  assert(row >= 0);
+  assert(first_col >= 0);
+  assert(first_col <= last_col);
+
+  Vertex const cells_min = Vertex_mul((Vertex){first_col, row},
+                                      pal_data->object_size);
+  Vertex const cells_max = Vertex_mul((Vertex){last_col + 1, row + 1},
+                                      pal_data->object_size);
+  return (BBox){X_BORDER + cells_min.x, -Y_BORDER - cells_max.y,
+                X_BORDER + cells_max.x, -Y_BORDER - cells_min.y};
+}
+
+static void redraw_cells(PaletteData const *const pal_data, int const row,
+  int const first_col, int const last_col)
+{
+  BBox const redraw_box = bbox_for_cells(pal_data, row, first_col, last_col);
+  E(window_force_redraw(0, pal_data->my_object, &redraw_box));
+}
+
+static void shift_items(PaletteData *const pal_data, ItemShift const *const shift)
+{
+  /* Move the images of a range of objects by one location in the
+     sequential layout. Only the visible rows are updated: locations whose new
+     contents were already on screen in the same row are block-copied, and only
+     those that wrapped onto another row (and the dirty location) are redrawn. */
+  assert(pal_data != NULL);
+  assert(shift != NULL);
+  assert(shift->delta == -1 || shift->delta == 1);
+  DEBUG("Shifting items %d..%d of palette %p by %d", shift->first, shift->last,
+        (void *)pal_data, shift->delta);
+
+  if (!is_sequential(pal_data))
+  {
+    /* Objects don't simply move to the next or previous location */
+    Vertex start_pos = grid_from_index(pal_data, shift->first + shift->delta);
+    if (shift->dirty != NULL_DATA_INDEX)
+    {
+      Vertex const dirty_pos = grid_from_index(pal_data, shift->dirty);
+      if (dirty_pos.y < start_pos.y ||
+          (dirty_pos.y == start_pos.y && dirty_pos.x < start_pos.x))
+      {
+        start_pos = dirty_pos;
+      }
+    }
+    redraw_below_pos(pal_data, start_pos);
+    return;
+  }
+
+  if (!pal_data->is_showing)
+  {
+    return; /* whole window will be redrawn when shown */
+  }
+
+  WimpGetWindowStateBlock state;
+  if (E(window_get_wimp_handle(0, pal_data->my_object, &state.window_handle)) ||
+      E(wimp_get_window_state(&state)))
+  {
+    redraw_below_pos(pal_data, (Vertex){0, 0}); /* attempt to recover */
+    return;
+  }
+
+  int const cols = pal_data->grid_size.x;
+  int const row_height = pal_data->object_size.y;
+  assert(cols > 0);
+  assert(row_height > 0);
+
+  /* Find the range of rows that are at least partly visible */
+  int const top = -state.yscroll - Y_BORDER;
+  int const bottom = top + BBox_height(&state.visible_area);
+  int const min_row = HIGHEST(top, 0) / row_height;
+  int const max_row = (HIGHEST(bottom, 1) - 1) / row_height;
+
+  int const dst_first = shift->first + shift->delta,
+            dst_last = shift->last + shift->delta;
+
+  if (dst_first <= dst_last)
+  {
+    int const first_row = HIGHEST(dst_first / cols, min_row),
+              last_row = LOWEST(dst_last / cols, max_row);
+
+    for (int row = first_row; row <= last_row; ++row)
+    {
+      int const dst_min = (row == dst_first / cols) ? dst_first % cols : 0,
+                dst_max = (row == dst_last / cols) ? dst_last % cols : cols - 1;
+
+      /* Locations whose new contents were previously in the same row */
+      int const copy_min = shift->delta > 0 ? HIGHEST(dst_min, shift->delta) : dst_min,
+                copy_max = shift->delta < 0 ? LOWEST(dst_max, cols - 1 + shift->delta) : dst_max;
+
+      if (copy_min <= copy_max)
+      {
+        BBox const src = bbox_for_cells(pal_data, row, copy_min - shift->delta,
+                                        copy_max - shift->delta);
+        BBox const dst = bbox_for_cells(pal_data, row, copy_min, copy_max);
+
+        if (E(wimp_block_copy(state.window_handle, src.xmin, src.ymin,
+                              src.xmax, src.ymax, dst.xmin, dst.ymin)))
+        {
+          redraw_cells(pal_data, row, copy_min, copy_max);
+        }
+      }
+
+      /* Locations whose new contents came from an adjacent row */
+      if (copy_min > dst_min)
+      {
+        redraw_cells(pal_data, row, dst_min, copy_min - 1);
+      }
+      if (copy_max < dst_max)
+      {
+        redraw_cells(pal_data, row, copy_max + 1, dst_max);
+      }
+    }
+  }
+
+  if (shift->dirty != NULL_DATA_INDEX)
+  {
+    redraw_cells(pal_data, shift->dirty / cols, shift->dirty % cols,
+                 shift->dirty % cols);
+  }
+}
+
 static bool reformat_visible(PaletteData *const pal_data, BBox const *const visible_area,
-                             ReformatAction const action, int const change_pos)
+                             ReformatAction const action,
+                             _Optional ItemShift const *const shift)
 {
   /* Reformat window contents to fit given visible area coordinates and clip
-     work area Y extent. 'change_pos' is the index of the object at which to
-     start redraw if no. of columns unchanged. ReformatAction_OnlyIfWidthChanged
+     work area Y extent. 'shift' describes the objects to be moved if no. of
+     columns unchanged, otherwise the whole window is redrawn.
+     ReformatAction_OnlyIfWidthChanged
      means only reformat display if no. of columns changed. ReformatAction_Force
      means force reformat of whole display. Returns true if the display was
      re-formatted. */
   assert(pal_data != NULL);
   assert(visible_area->xmin <= visible_area->xmax);
-  DEBUGF("Visible area will be xmin:%d xmax:%d (change_pos:%d)\n", visible_area->xmin, visible_area->xmax,
-         change_pos);
+  DEBUGF("Visible area will be xmin:%d xmax:%d\n", visible_area->xmin, visible_area->xmax);
 
   /* Calculate number of columns for this window width */
   int new_num_columns = (int)(((visible_area->xmax - X_BORDER) - (visible_area->xmin + X_BORDER)) /
@@ -510,6 +735,8 @@ static bool reformat_visible(PaletteData *const pal_data, BBox const *const visi
 
   DEBUGF("Predicted no. of rows: %d\n", pal_data->grid_size.y);
 
+  cache_layout(pal_data);
+
   /* If the number of columns has changed then our record of the grid location
   of the selected object will have been invalidated */
   if (full_reformat && pal_data->sel_index != NULL_DATA_INDEX)
@@ -524,9 +751,13 @@ static bool reformat_visible(PaletteData *const pal_data, BBox const *const visi
      (and redraw whole window, if layout has changed). */
   set_extent(pal_data, visible_area, full_reformat);
 
-  /* Redraw below the position specified by our caller if layout has not changed. */
+  /* Move only the objects specified by our caller if layout has not changed. */
   if (!full_reformat) {
-    redraw_below_pos(pal_data, grid_from_index(pal_data, change_pos));
+    if (shift) {
+      shift_items(pal_data, &*shift);
+    } else {
+      redraw_below_pos(pal_data, (Vertex){0, 0});
+    }
   }
 
   return true; /* display was reformatted */
@@ -917,11 +1148,11 @@ static int mouse_click(int const event_code, WimpPollBlock *const event,
 }
 
 static bool reformat(PaletteData *const pal_data, ReformatAction const action,
-                     int const change_pos)
+                     _Optional ItemShift const *const shift)
 {
   /* Reformat contents to fit current window width and clip the work area
-     Y extent. 'change_pos' is the index of the object at which to start redraw
-     if no. of columns is unchanged. ReformatAction_OnlyIfWidthChanged means only
+     Y extent. 'shift' describes the objects to be moved if no. of columns is
+     unchanged. ReformatAction_OnlyIfWidthChanged means only
      reformat display if no. of columns changed. ReformatAction_Force means force
      reformat of whole display. Returns true if the display was re-formatted. */
   assert(pal_data != NULL);
@@ -935,7 +1166,7 @@ static bool reformat(PaletteData *const pal_data, ReformatAction const action,
   ON_ERR_RPT_RTN_V(wimp_get_window_state(&state), false);
 
   bool const reformatted = reformat_visible(
-    pal_data, &state.visible_area, action, change_pos);
+    pal_data, &state.visible_area, action, shift);
 
   if (reformatted && action != ReformatAction_OnlyIfWidthChanged)
   {
@@ -982,9 +1213,9 @@ static int about_to_be_shown(int const event_code, ToolboxEvent *const event,
   /* Correctly format the display before the Toolbox opens this window */
   if (atbse->show_type == Toolbox_ShowObject_FullSpec)
     reformat_visible(pal_data, &atbse->info.full_spec.visible_area,
-                     ReformatAction_OnlyIfWidthChanged, 0);
+                     ReformatAction_OnlyIfWidthChanged, NULL);
   else
-    reformat(pal_data, ReformatAction_OnlyIfWidthChanged, 0);
+    reformat(pal_data, ReformatAction_OnlyIfWidthChanged, NULL);
 
   if (!pal_data->is_showing) {
     if (pal_data->client_functions != NULL &&
@@ -1059,7 +1290,7 @@ static void set_labels_flag(PaletteData *const pal_data, bool const show_labels)
     }
     else
     {
-      reformat(pal_data, ReformatAction_Force, 0);
+      reformat(pal_data, ReformatAction_Force, NULL);
     }
   }
 }
@@ -1077,7 +1308,7 @@ static void set_ordered_flag(PaletteData *const pal_data, bool const numeric_ord
 
     Vertex const desktop_size = Desktop_get_size_os();
     calcmaxcolumns(pal_data, desktop_size.x);
-    reformat(pal_data, ReformatAction_Force, 0);
+    reformat(pal_data, ReformatAction_Force, NULL);
   }
 }
 
@@ -1228,6 +1459,7 @@ static void do_finalise(PaletteData *const pal_data, bool const reinit)
 
   /* Forget the client */
   pal_data->client_functions = NULL;
+  free_layout(pal_data);
 }
 
 static bool do_init(PaletteData *const pal_data,
@@ -1270,7 +1502,7 @@ static bool do_init(PaletteData *const pal_data,
 
     Vertex const desktop_size = Desktop_get_size_os();
     calcmaxcolumns(pal_data, desktop_size.x);
-    reformat(pal_data, ReformatAction_Force, 0);
+    reformat(pal_data, ReformatAction_Force, NULL);
 
     int index = index_from_grid(pal_data, default_selected);
     if (index != NULL_DATA_INDEX)
@@ -1454,6 +1686,9 @@ void Palette_object_moved(PaletteData *const pal_data, int const old_object,
   int const old_index = p_object_to_index(pal_data, old_object),
                       new_index = p_object_to_index(pal_data, new_object);
 
+  /* The selection's new grid location must be found in the new layout */
+  cache_layout(pal_data);
+
   if (pal_data->sel_index != NULL_DATA_INDEX) {
     /* Adjust the index of the selected object, according to whether it was
        before or after the object that was moved. */
@@ -1472,19 +1707,13 @@ void Palette_object_moved(PaletteData *const pal_data, int const old_object,
     setselrowcol(pal_data); /* find new grid location */
   }
 
-  Vertex start_pos = grid_from_index(pal_data, old_index);
-  Vertex const new_pos = grid_from_index(pal_data, new_index);
-  if (new_pos.y < start_pos.y)
-  {
-    start_pos.y = new_pos.y;
-    start_pos.x = new_pos.x;
-  }
-  else if (new_pos.y == start_pos.y && new_pos.x < start_pos.x)
-  {
-    start_pos.x = new_pos.x;
-  }
+  /* Objects between the old and new locations move up or down by one to make
+     room for the moved object */
+  ItemShift const shift = old_index < new_index ?
+    (ItemShift){old_index + 1, new_index, -1, new_index} :
+    (ItemShift){new_index, old_index - 1, 1, new_index};
 
-  redraw_below_pos(pal_data, start_pos);
+  shift_items(pal_data, &shift);
 }
 
 void Palette_redraw_object(PaletteData *const pal_data, int object)
@@ -1572,8 +1801,18 @@ void Palette_object_deleted(PaletteData *const pal_data, int const object)
   int const old_sel_index = pal_data->sel_index;
   pal_data->sel_index = NULL_DATA_INDEX;
 
-  /* Reformat the display and redraw it below the index of the deleted object */
-  reformat(pal_data, ReformatAction_Default, index == NULL_DATA_INDEX ? 0 : index);
+  /* Reformat the display and move any later objects up to fill the gap left
+     by the deleted object */
+  if (index == NULL_DATA_INDEX)
+  {
+    reformat(pal_data, ReformatAction_Default, NULL);
+  }
+  else
+  {
+    ItemShift const shift = {index + 1, pal_data->num_indices, -1,
+                             pal_data->num_indices};
+    reformat(pal_data, ReformatAction_Default, &shift);
+  }
 
   if (index == NULL_DATA_INDEX || pal_data->num_indices == 0)
   {
@@ -1593,6 +1832,9 @@ void Palette_object_deleted(PaletteData *const pal_data, int const object)
     {
       pal_data->sel_index = pal_data->num_indices - 1;
       setselrowcol(pal_data); /* find grid location of selected */
+
+      BBox const sel_bbox = bbox_for_object(pal_data, pal_data->sel_pos);
+      E(window_force_redraw(0, pal_data->my_object, &sel_bbox));
     }
   }
   update_menus(pal_data);
@@ -1620,7 +1862,15 @@ void Palette_object_added(PaletteData *const pal_data, int const object)
     Vertex const desktop_size = Desktop_get_size_os();
     calcmaxcolumns(pal_data, desktop_size.x);
   }
-  reformat(pal_data, ReformatAction_Default, index);
+
+  /* Reformat the display and move any later objects down to make room for
+     the new object */
+  ItemShift const shift = {index, pal_data->num_indices - 2, 1, index};
+  reformat(pal_data, ReformatAction_Default, &shift);
+
+  if (pal_data->sel_index != NULL_DATA_INDEX) {
+    setselrowcol(pal_data); /* find new grid location */
+  }
 }
 
 void Palette_update_title(PaletteData *const pal_data)
@@ -33,6 +33,10 @@ struct PaletteData {
   int sel_index, num_indices, max_columns;
   Vertex grid_size, sel_pos, object_size;
   _Optional const struct PaletteClientFuncts *client_functions;
+
+  /* Custom layout cached when the palette is reformatted, if any */
+  _Optional int *layout_indices; /* index at each grid location */
+  _Optional Vertex *layout_positions; /* grid location of each index */
 };
 
 #endif
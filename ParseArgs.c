@@ -21,6 +21,7 @@
 /* ANSI library files */
 #include <stdbool.h>
 #include "stdlib.h"
+#include "stdio.h"
 #include <string.h>
 #include <assert.h>
 #include <ctype.h>
@@ -28,18 +29,30 @@
 #include "scheduler.h"
 #include "Err.h"
 #include "msgtrans.h"
+#include "Macros.h"
 #include "StrExtra.h"
 #include "FilePaths.h"
 #include "FileUtils.h"
 
 #include "Session.h"
 #include "ParseArgs.h"
+#include "BatchCheck.h"
+#include "Bench.h"
+#include "Instrument.h"
+#include "MapPreview.h"
+#include "MapTexBitm.h"
 #include "Utils.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
 #endif
 
+static void usage_error(char const *const usage)
+{
+  printf("Usage: %s\n", usage);
+  exit(EXIT_FAILURE);
+}
+
 void parse_arguments(int argc, char *argv[])
 {
   /*
@@ -48,7 +61,111 @@ void parse_arguments(int argc, char *argv[])
 
   assert(argv != NULL || argc == 0);
 
+  /* -check <levels directory> [-resave] checks files without a desktop
+     session and then quits. So does
+     -preview <base map> <map textures> <sprite file> [-overlay <overlay map>]
+     [-zoom <0..4>] [-angle <0..3>] [-objects <base objects>]
+     [-overlayobjects <overlay objects>] [-graphics <graphics file>]
+     [-polycolours <polygon colours>] [-hillcolours <hill colours>]
+     [-mission <mission file>] and
+     -bench <map textures> [-graphics <graphics file>]
+     [-baseline <results file>]
+     If built with INSTRUMENT defined, -stats <file> saves counters and
+     timers for recent redraws on exit. */
+  _Optional char const *check_dir = NULL;
+  bool resave = false;
+  _Optional char *preview_args[3] = {NULL, NULL, NULL};
+  MapPreviewFiles preview_files = {NULL};
+  int zoom = 2;
+  MapAngle angle = MapAngle_North;
+  _Optional char const *bench_tiles = NULL;
+  _Optional char const *graphics_path = NULL;
+  _Optional char const *baseline_path = NULL;
+
   for (int i = 1; i < argc; i++) {
+    if (stricmp(argv[i], "-check") == 0) {
+      if (i + 1 >= argc) {
+        usage_error("-check <levels directory> [-resave]");
+      }
+      check_dir = argv[++i];
+      continue;
+    }
+
+    if (stricmp(argv[i], "-resave") == 0) {
+      resave = true;
+      continue;
+    }
+
+    if (stricmp(argv[i], "-preview") == 0 && i + ARRAY_SIZE(preview_args) < (size_t)argc) {
+      for (size_t j = 0; j < ARRAY_SIZE(preview_args); ++j) {
+        preview_args[j] = argv[++i];
+      }
+      continue;
+    }
+
+    if (stricmp(argv[i], "-overlay") == 0 && i + 1 < argc) {
+      preview_files.overlay_map = argv[++i];
+      continue;
+    }
+
+    if (stricmp(argv[i], "-objects") == 0 && i + 1 < argc) {
+      preview_files.base_objects = argv[++i];
+      continue;
+    }
+
+    if (stricmp(argv[i], "-overlayobjects") == 0 && i + 1 < argc) {
+      preview_files.overlay_objects = argv[++i];
+      continue;
+    }
+
+    if (stricmp(argv[i], "-polycolours") == 0 && i + 1 < argc) {
+      preview_files.poly_colours = argv[++i];
+      continue;
+    }
+
+    if (stricmp(argv[i], "-hillcolours") == 0 && i + 1 < argc) {
+      preview_files.hill_colours = argv[++i];
+      continue;
+    }
+
+    if (stricmp(argv[i], "-mission") == 0 && i + 1 < argc) {
+      preview_files.mission = argv[++i];
+      continue;
+    }
+
+    if (stricmp(argv[i], "-zoom") == 0 && i + 1 < argc) {
+      zoom = HIGHEST(0, LOWEST(MapTexSizeLog2, atoi(argv[++i])));
+      continue;
+    }
+
+    if (stricmp(argv[i], "-angle") == 0 && i + 1 < argc) {
+      angle = (MapAngle)HIGHEST(MapAngle_First,
+                                LOWEST(MapAngle_Count - 1, atoi(argv[++i])));
+      continue;
+    }
+
+    if (stricmp(argv[i], "-bench") == 0 && i + 1 < argc) {
+      bench_tiles = argv[++i];
+      continue;
+    }
+
+    if (stricmp(argv[i], "-graphics") == 0 && i + 1 < argc) {
+      graphics_path = argv[++i];
+      continue;
+    }
+
+    if (stricmp(argv[i], "-baseline") == 0 && i + 1 < argc) {
+      baseline_path = argv[++i];
+      continue;
+    }
+
+#ifdef INSTRUMENT
+    if (stricmp(argv[i], "-stats") == 0 && i + 1 < argc) {
+      Instrument_dump_at_exit(argv[++i]);
+      continue;
+    }
+#endif
+
     OS_File_CatalogueInfo catalogue_info;
     EF(os_file_read_cat_no_path(argv[i], &catalogue_info));
 
@@ -74,4 +191,30 @@ void parse_arguments(int argc, char *argv[])
       }
     }
   }
+
+  if (resave && !check_dir) {
+    usage_error("-check <levels directory> -resave");
+  }
+
+  if (check_dir) {
+    exit(BatchCheck_run(&*check_dir, resave) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  if (preview_args[0] && preview_args[1] && preview_args[2]) {
+    if ((preview_files.base_objects || preview_files.overlay_objects) &&
+        !graphics_path) {
+      usage_error("-preview <base map> <map textures> <sprite file> "
+                  "-objects <base objects> -graphics <graphics file>");
+    }
+    preview_files.base_map = &*preview_args[0];
+    preview_files.tiles = &*preview_args[1];
+    preview_files.graphics = graphics_path;
+    exit(MapPreview_save(&preview_files, &*preview_args[2], zoom, angle) ?
+         EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  if (bench_tiles) {
+    exit(Bench_run(&*bench_tiles, graphics_path, baseline_path) ?
+         EXIT_SUCCESS : EXIT_FAILURE);
+  }
 }
@@ -37,8 +37,6 @@
 #endif
 
 enum {
-  PathsMax = 8,
-  PathMaxWaypoints = 64,
   BytesPerWaypoint = 4,
   WaypointPadding = 1,
   BytesPerPath = (PathMaxWaypoints * BytesPerWaypoint) + 4,
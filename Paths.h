@@ -17,6 +17,11 @@ struct Writer;
 #define _Optional
 #endif
 
+enum {
+  PathsMax = 8,
+  PathMaxWaypoints = 64,
+};
+
 typedef struct PathsData PathsData;
 typedef struct Path Path;
 typedef struct Waypoint Waypoint;
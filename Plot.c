@@ -33,6 +33,7 @@
 #include "Debug.h"
 
 #include "Plot.h"
+#include "PlotList.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -56,6 +57,10 @@ static int millipoints_to_os(int const mp)
 
 void plot_set_dot_pattern_len(int const len)
 {
+  if (PlotList_capture_unsupported()) {
+    return;
+  }
+
   _kernel_swi_regs regs = {{RWGraphicsInfoR0, RWGraphicsInfoR1, len}};
   DEBUGF("Setting dot pattern length %d\n", len);
   E(_kernel_swi(OS_Byte, &regs, &regs));
@@ -63,6 +68,10 @@ void plot_set_dot_pattern_len(int const len)
 
 void plot_set_dot_pattern(unsigned char (*const bitmap)[8])
 {
+  if (PlotList_capture_unsupported()) {
+    return;
+  }
+
   assert(bitmap);
   _kernel_oswrch(MiscCommand);
   _kernel_oswrch(MiscSetDotPattern);
@@ -74,6 +83,10 @@ void plot_set_dot_pattern(unsigned char (*const bitmap)[8])
 
 void plot_set_dash_pattern(int const len)
 {
+  if (PlotList_capture_unsupported()) {
+    return;
+  }
+
   unsigned char bitmap[8] = {0};
   int plen = 2 * len;
   plen = HIGHEST(CHAR_BIT, plen);
@@ -91,6 +104,10 @@ void plot_set_dash_pattern(int const len)
 
 void plot_set_window(BBox const *const bbox)
 {
+  if (PlotList_capture_unsupported()) {
+    return;
+  }
+
   assert(bbox);
   DEBUGF("Setting graphics window to %d,%d,%d,%d\n",
     bbox->xmin, bbox->ymin, bbox->xmax, bbox->ymax);
@@ -170,6 +187,10 @@ void plot_get_window(BBox *const bbox)
 
 void plot_set_wimp_col(int colour)
 {
+  if (PlotList_capture_value(PlotListOp_SetWimpCol, (unsigned int)colour)) {
+    return;
+  }
+
   assert(colour >= WimpColour_White);
   assert(colour <= WimpColour_LightBlue);
   DEBUG_VERBOSEF("Setting wimp colour %d\n", colour);
@@ -178,6 +199,10 @@ void plot_set_wimp_col(int colour)
 
 void plot_set_col(PaletteEntry const colour)
 {
+  if (PlotList_capture_value(PlotListOp_SetCol, colour)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Setting 24-bit plot colour 0x%x\n", colour);
   E(colourtrans_set_gcol(
     ColourTrans_SetGCOL_UseECF, GCOLAction_Overwrite, colour));
@@ -185,6 +210,10 @@ void plot_set_col(PaletteEntry const colour)
 
 void plot_set_bg_col(PaletteEntry const colour)
 {
+  if (PlotList_capture_value(PlotListOp_SetBgCol, colour)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Setting 24-bit background colour 0x%x\n", colour);
   E(colourtrans_set_gcol(
     ColourTrans_SetGCOL_Background|ColourTrans_SetGCOL_UseECF,
@@ -193,12 +222,20 @@ void plot_set_bg_col(PaletteEntry const colour)
 
 void plot_set_native_col(int colour)
 {
+  if (PlotList_capture_value(PlotListOp_SetNativeCol, (unsigned int)colour)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Setting plot colour 0x%x\n", colour);
   E(os_set_colour(0, GCOLAction_Overwrite, colour));
 }
 
 void plot_clear_window(void)
 {
+  if (PlotList_capture_unsupported()) {
+    return;
+  }
+
   _kernel_oswrch(ClearGraphicsWindow);
 }
 
@@ -279,6 +316,10 @@ void plot_get_string_bbox(int const handle, char const *const string,
 void plot_font(int const handle, char const *const string,
   _Optional BBox const *const rubout, Vertex const scr_pos, bool blend)
 {
+  if (PlotList_capture_unsupported()) {
+    return;
+  }
+
   assert(string != NULL);
   DEBUG_VERBOSEF("Plotting font handle %d string '%s' at %d,%d (%s blending)\n",
         handle, string, scr_pos.x, scr_pos.y, blend ? "with" : "without");
@@ -302,6 +343,10 @@ void plot_font(int const handle, char const *const string,
 void plot_set_font_col(int const handle, PaletteEntry const bg_colour,
   PaletteEntry const fg_colour)
 {
+  if (PlotList_capture_unsupported()) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Setting 24-bit colours 0x%x, 0x%x for font handle %d\n",
     bg_colour, fg_colour, handle);
 
@@ -317,6 +362,10 @@ void plot_lose_font(int const handle)
 
 void plot_move(Vertex const scr_pos)
 {
+  if (PlotList_capture(PlotListOp_Move, scr_pos, scr_pos)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Moving graphics cursor to %d,%d\n", scr_pos.x, scr_pos.y);
   E(os_plot(PlotOp_SolidInclBoth + PlotOp_MoveAbs,
                      scr_pos.x, scr_pos.y));
@@ -324,11 +373,19 @@ void plot_move(Vertex const scr_pos)
 
 void plot_fg_point(Vertex const scr_pos)
 {
+  if (PlotList_capture(PlotListOp_FgPoint, scr_pos, scr_pos)) {
+    return;
+  }
+
   E(os_plot(PlotOp_Point + PlotOp_PlotFGAbs, scr_pos.x, scr_pos.y));
 }
 
 void plot_fg_line(Vertex const scr_pos)
 {
+  if (PlotList_capture(PlotListOp_FgLine, scr_pos, scr_pos)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Plotting foreground line to %d,%d\n",
     scr_pos.x, scr_pos.y);
   E(os_plot(PlotOp_SolidInclBoth + PlotOp_PlotFGAbs,
@@ -337,6 +394,10 @@ void plot_fg_line(Vertex const scr_pos)
 
 void plot_fg_line_ex_start(Vertex const scr_pos)
 {
+  if (PlotList_capture(PlotListOp_FgLineExStart, scr_pos, scr_pos)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Plotting foreground line (ex. start) to %d,%d\n",
     scr_pos.x, scr_pos.y);
   E(os_plot(PlotOp_SolidExclStart + PlotOp_PlotFGAbs,
@@ -345,6 +406,10 @@ void plot_fg_line_ex_start(Vertex const scr_pos)
 
 void plot_fg_line_ex_end(Vertex const scr_pos)
 {
+  if (PlotList_capture(PlotListOp_FgLineExEnd, scr_pos, scr_pos)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Plotting foreground line (ex. end) to %d,%d\n",
     scr_pos.x, scr_pos.y);
   E(os_plot(PlotOp_SolidExclEnd + PlotOp_PlotFGAbs,
@@ -353,6 +418,10 @@ void plot_fg_line_ex_end(Vertex const scr_pos)
 
 void plot_fg_line_ex_both(Vertex const scr_pos)
 {
+  if (PlotList_capture(PlotListOp_FgLineExBoth, scr_pos, scr_pos)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Plotting foreground line (ex. both) to %d,%d\n",
     scr_pos.x, scr_pos.y);
   E(os_plot(PlotOp_SolidExclBoth + PlotOp_PlotFGAbs,
@@ -361,6 +430,10 @@ void plot_fg_line_ex_both(Vertex const scr_pos)
 
 void plot_fg_bbox(BBox const *const bbox)
 {
+  if (PlotList_capture(PlotListOp_FgBBox, BBox_get_min(bbox), BBox_get_max(bbox))) {
+    return;
+  }
+
   assert(BBox_is_valid(bbox));
   DEBUG_VERBOSEF("Plotting foreground bounding box from %d,%d to %d,%d\n",
     bbox->xmin, bbox->ymin, bbox->xmax, bbox->ymax);
@@ -374,6 +447,10 @@ void plot_fg_bbox(BBox const *const bbox)
 
 void plot_inv_bbox(BBox const *const bbox)
 {
+  if (PlotList_capture(PlotListOp_InvBBox, BBox_get_min(bbox), BBox_get_max(bbox))) {
+    return;
+  }
+
   assert(BBox_is_valid(bbox));
   DEBUG_VERBOSEF("Plotting inverted bounding box from %d,%d to %d,%d\n",
     bbox->xmin, bbox->ymin, bbox->xmax, bbox->ymax);
@@ -387,6 +464,10 @@ void plot_inv_bbox(BBox const *const bbox)
 
 void plot_fg_dot_line(Vertex const scr_pos)
 {
+  if (PlotList_capture(PlotListOp_FgDotLine, scr_pos, scr_pos)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Plotting foreground dotted line to %d,%d\n",
     scr_pos.x, scr_pos.y);
 
@@ -396,6 +477,10 @@ void plot_fg_dot_line(Vertex const scr_pos)
 
 void plot_fg_rect_2v(Vertex const scr_pos_1, Vertex const scr_pos_2)
 {
+  if (PlotList_capture(PlotListOp_FgRect2V, scr_pos_1, scr_pos_2)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Plotting foreground rectangle from %d,%d to %d,%d\n",
     scr_pos_1.x, scr_pos_1.y, scr_pos_2.x, scr_pos_2.y);
 
@@ -408,6 +493,10 @@ void plot_fg_rect_2v(Vertex const scr_pos_1, Vertex const scr_pos_2)
 
 void plot_inv_dot_rect_2v(Vertex const scr_pos_1, Vertex const scr_pos_2)
 {
+  if (PlotList_capture(PlotListOp_InvDotRect2V, scr_pos_1, scr_pos_2)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Plotting inverted dotted rectangle from %d,%d to %d,%d\n",
     scr_pos_1.x, scr_pos_1.y, scr_pos_2.x, scr_pos_2.y);
 
@@ -429,6 +518,10 @@ void plot_inv_dot_rect_2v(Vertex const scr_pos_1, Vertex const scr_pos_2)
 
 void plot_fg_ol_rect_2v(Vertex const scr_pos_1, Vertex const scr_pos_2)
 {
+  if (PlotList_capture(PlotListOp_FgOlRect2V, scr_pos_1, scr_pos_2)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Plotting outline rectangle from %d,%d to %d,%d\n",
     scr_pos_1.x, scr_pos_1.y, scr_pos_2.x, scr_pos_2.y);
 
@@ -450,6 +543,10 @@ void plot_fg_ol_rect_2v(Vertex const scr_pos_1, Vertex const scr_pos_2)
 
 void plot_fg_dot_rect_2v(Vertex const scr_pos_1, Vertex const scr_pos_2)
 {
+  if (PlotList_capture(PlotListOp_FgDotRect2V, scr_pos_1, scr_pos_2)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Plotting dotted rectangle from %d,%d to %d,%d\n",
     scr_pos_1.x, scr_pos_1.y, scr_pos_2.x, scr_pos_2.y);
 
@@ -471,6 +568,10 @@ void plot_fg_dot_rect_2v(Vertex const scr_pos_1, Vertex const scr_pos_2)
 
 void plot_fg_tri(Vertex const scr_pos)
 {
+  if (PlotList_capture(PlotListOp_FgTri, scr_pos, scr_pos)) {
+    return;
+  }
+
   DEBUG_VERBOSEF("Plotting foreground triangle to %d,%d\n",
     scr_pos.x, scr_pos.y);
 
@@ -0,0 +1,359 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Recorded lists of graphics operations
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "stdlib.h"
+
+#include "Macros.h"
+#include "Debug.h"
+#include "PalEntry.h"
+
+#include "Vertex.h"
+#include "Plot.h"
+#include "PlotList.h"
+#include "PlotListData.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+enum {
+  MinCapacity = 64,
+  MaxCapacity = 16384, /* give up on lists longer than this */
+  CullMargin = 8, /* allow for line thickness (in OS units) */
+};
+
+typedef struct PlotListCmd {
+  PlotListOp op;
+  union {
+    struct {
+      Vertex a, b;
+    } pos;
+    unsigned int value;
+  } data;
+} PlotListCmd;
+
+static _Optional PlotListData *recording;
+static Vertex recording_origin;
+
+/* ---------------- Private functions ---------------- */
+
+static _Optional PlotListCmd *add_cmd(PlotListData *const list)
+{
+  assert(list);
+  assert(list->count <= list->capacity);
+
+  if (list->failed) {
+    return NULL;
+  }
+
+  if (list->count == list->capacity) {
+    size_t const new_capacity = list->capacity ? list->capacity * 2 : MinCapacity;
+    _Optional PlotListCmd *const new_cmds = new_capacity > MaxCapacity ? NULL :
+      realloc(list->cmds, sizeof(*new_cmds) * new_capacity);
+
+    if (!new_cmds) {
+      DEBUGF("Plot list is too long\n");
+      list->failed = true;
+      return NULL;
+    }
+    list->cmds = new_cmds;
+    list->capacity = new_capacity;
+  }
+
+  assert(list->cmds);
+  return &list->cmds[list->count++];
+}
+
+static int clamp_coord(long int const coord)
+{
+  /* Coordinates in the VDU stream are 16-bit */
+  return (int)HIGHEST(SHRT_MIN, LOWEST(SHRT_MAX, coord));
+}
+
+static Vertex translate(Vertex const pos, Vertex const offset)
+{
+  return (Vertex){
+    clamp_coord((long)pos.x + offset.x),
+    clamp_coord((long)pos.y + offset.y)
+  };
+}
+
+static bool touches_clip(BBox const *const clip, Vertex const a, Vertex const b)
+{
+  /* Both corners are inclusive but the maximum of the clip box isn't */
+  return HIGHEST(a.x, b.x) + CullMargin >= clip->xmin &&
+         LOWEST(a.x, b.x) - CullMargin < clip->xmax &&
+         HIGHEST(a.y, b.y) + CullMargin >= clip->ymin &&
+         LOWEST(a.y, b.y) - CullMargin < clip->ymax;
+}
+
+static bool tri_touches_clip(BBox const *const clip, Vertex const a,
+  Vertex const b, Vertex const c)
+{
+  return touches_clip(clip, Vertex_min(a, Vertex_min(b, c)),
+                            Vertex_max(a, Vertex_max(b, c)));
+}
+
+/* ---------------- Public functions ---------------- */
+
+void PlotList_init(PlotListData *const list)
+{
+  assert(list);
+  *list = (PlotListData){.cmds = NULL, .count = 0, .capacity = 0,
+                         .is_valid = false, .failed = false};
+}
+
+void PlotList_destroy(PlotListData *const list)
+{
+  assert(list);
+  assert(recording != list);
+  free(list->cmds);
+}
+
+void PlotList_invalidate(PlotListData *const list)
+{
+  assert(list);
+  list->is_valid = false;
+}
+
+bool PlotList_is_valid(PlotListData const *const list)
+{
+  assert(list);
+  return list->is_valid;
+}
+
+void PlotList_start(PlotListData *const list, Vertex const origin)
+{
+  assert(list);
+  assert(!recording);
+  DEBUGF("Start recording plot list %p\n", (void *)list);
+
+  list->count = 0;
+  list->is_valid = false;
+  list->failed = false;
+  recording = list;
+  recording_origin = origin;
+}
+
+bool PlotList_stop(PlotListData *const list)
+{
+  assert(list);
+  assert(recording == list);
+  recording = NULL;
+
+  list->is_valid = !list->failed;
+  DEBUGF("Stop recording plot list %p (%zu commands, %s)\n", (void *)list,
+         list->count, list->is_valid ? "valid" : "invalid");
+  return list->is_valid;
+}
+
+bool PlotList_capture(PlotListOp const op, Vertex const a, Vertex const b)
+{
+  if (!recording) {
+    return false;
+  }
+
+  _Optional PlotListCmd *const cmd = add_cmd(&*recording);
+  if (cmd) {
+    cmd->op = op;
+    cmd->data.pos.a = Vertex_sub(a, recording_origin);
+    cmd->data.pos.b = Vertex_sub(b, recording_origin);
+  }
+  return true;
+}
+
+bool PlotList_capture_value(PlotListOp const op, unsigned int const value)
+{
+  if (!recording) {
+    return false;
+  }
+
+  _Optional PlotListCmd *const cmd = add_cmd(&*recording);
+  if (cmd) {
+    cmd->op = op;
+    cmd->data.value = value;
+  }
+  return true;
+}
+
+bool PlotList_capture_unsupported(void)
+{
+  if (!recording) {
+    return false;
+  }
+
+  DEBUGF("Unsupported operation in plot list\n");
+  recording->failed = true;
+  return true;
+}
+
+void PlotList_replay(PlotListData const *const list, Vertex const origin,
+  BBox const *const clip)
+{
+  assert(list);
+  assert(list->is_valid);
+  assert(!recording);
+  assert(clip);
+
+  /* Track the last two points visited by the graphics cursor because
+     some operations plot relative to them. Moves are deferred until
+     something is actually plotted, so that operations outside the clip
+     box cost nothing. */
+  Vertex last = {0, 0}, before_last = {0, 0};
+  bool cursor_stale = true;
+
+  for (size_t i = 0; i < list->count; ++i) {
+    assert(list->cmds);
+    PlotListCmd const *const cmd = &list->cmds[i];
+    Vertex a = {0, 0}, b = {0, 0};
+    if (cmd->op >= PlotListOp_Move) {
+      a = translate(cmd->data.pos.a, origin);
+      b = translate(cmd->data.pos.b, origin);
+    }
+
+    switch (cmd->op) {
+    case PlotListOp_SetWimpCol:
+      plot_set_wimp_col((int)cmd->data.value);
+      break;
+
+    case PlotListOp_SetCol:
+      plot_set_col(cmd->data.value);
+      break;
+
+    case PlotListOp_SetBgCol:
+      plot_set_bg_col(cmd->data.value);
+      break;
+
+    case PlotListOp_SetNativeCol:
+      plot_set_native_col((int)cmd->data.value);
+      break;
+
+    case PlotListOp_Move:
+      before_last = last;
+      last = a;
+      cursor_stale = true;
+      break;
+
+    case PlotListOp_FgPoint:
+    case PlotListOp_FgLine:
+    case PlotListOp_FgLineExStart:
+    case PlotListOp_FgLineExEnd:
+    case PlotListOp_FgLineExBoth:
+    case PlotListOp_FgDotLine:
+    case PlotListOp_FgTri:
+      {
+        bool const is_visible =
+          cmd->op == PlotListOp_FgPoint ? touches_clip(clip, a, a) :
+          cmd->op == PlotListOp_FgTri ? tri_touches_clip(clip, before_last, last, a) :
+          touches_clip(clip, last, a);
+
+        if (is_visible) {
+          if (cursor_stale) {
+            plot_move(before_last);
+            plot_move(last);
+            cursor_stale = false;
+          }
+
+          switch (cmd->op) {
+          case PlotListOp_FgPoint:
+            plot_fg_point(a);
+            break;
+          case PlotListOp_FgLine:
+            plot_fg_line(a);
+            break;
+          case PlotListOp_FgLineExStart:
+            plot_fg_line_ex_start(a);
+            break;
+          case PlotListOp_FgLineExEnd:
+            plot_fg_line_ex_end(a);
+            break;
+          case PlotListOp_FgLineExBoth:
+            plot_fg_line_ex_both(a);
+            break;
+          case PlotListOp_FgDotLine:
+            plot_fg_dot_line(a);
+            break;
+          default:
+            plot_fg_tri(a);
+            break;
+          }
+        } else {
+          cursor_stale = true;
+        }
+        before_last = last;
+        last = a;
+      }
+      break;
+
+    case PlotListOp_FgBBox:
+    case PlotListOp_InvBBox:
+      {
+        BBox const bbox = {a.x, a.y, b.x, b.y};
+        if (touches_clip(clip, a, b)) {
+          if (cmd->op == PlotListOp_FgBBox) {
+            plot_fg_bbox(&bbox);
+          } else {
+            plot_inv_bbox(&bbox);
+          }
+          cursor_stale = false;
+        } else {
+          cursor_stale = true;
+        }
+        before_last = a;
+        last = (Vertex){b.x - 1, b.y - 1};
+      }
+      break;
+
+    case PlotListOp_FgRect2V:
+      if (touches_clip(clip, a, b)) {
+        plot_fg_rect_2v(a, b);
+        cursor_stale = false;
+      } else {
+        cursor_stale = true;
+      }
+      before_last = a;
+      last = b;
+      break;
+
+    case PlotListOp_InvDotRect2V:
+    case PlotListOp_FgOlRect2V:
+    case PlotListOp_FgDotRect2V:
+      if (touches_clip(clip, a, b)) {
+        if (cmd->op == PlotListOp_InvDotRect2V) {
+          plot_inv_dot_rect_2v(a, b);
+        } else if (cmd->op == PlotListOp_FgOlRect2V) {
+          plot_fg_ol_rect_2v(a, b);
+        } else {
+          plot_fg_dot_rect_2v(a, b);
+        }
+        cursor_stale = false;
+      } else {
+        cursor_stale = true;
+      }
+      before_last = (Vertex){b.x, a.y};
+      last = a;
+      break;
+    }
+  }
+}
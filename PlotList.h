@@ -0,0 +1,60 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Recorded lists of graphics operations
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef PlotList_h
+#define PlotList_h
+
+#include <stdbool.h>
+#include "PalEntry.h"
+#include "Vertex.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+typedef enum {
+  PlotListOp_SetWimpCol,
+  PlotListOp_SetCol,
+  PlotListOp_SetBgCol,
+  PlotListOp_SetNativeCol,
+  PlotListOp_Move,
+  PlotListOp_FgPoint,
+  PlotListOp_FgLine,
+  PlotListOp_FgLineExStart,
+  PlotListOp_FgLineExEnd,
+  PlotListOp_FgLineExBoth,
+  PlotListOp_FgDotLine,
+  PlotListOp_FgTri,
+  PlotListOp_FgBBox,
+  PlotListOp_InvBBox,
+  PlotListOp_FgRect2V,
+  PlotListOp_InvDotRect2V,
+  PlotListOp_FgOlRect2V,
+  PlotListOp_FgDotRect2V,
+} PlotListOp;
+
+typedef struct PlotListData PlotListData;
+
+void PlotList_init(PlotListData *list);
+void PlotList_destroy(PlotListData *list);
+void PlotList_invalidate(PlotListData *list);
+bool PlotList_is_valid(PlotListData const *list);
+
+/* While recording, calls to the plot_ functions are captured instead
+   of being executed. Coordinates are recorded relative to the given
+   origin. */
+void PlotList_start(PlotListData *list, Vertex origin);
+bool PlotList_stop(PlotListData *list);
+
+void PlotList_replay(PlotListData const *list, Vertex origin,
+  BBox const *clip);
+
+/* For use by the plot_ functions only */
+bool PlotList_capture(PlotListOp op, Vertex a, Vertex b);
+bool PlotList_capture_value(PlotListOp op, unsigned int value);
+bool PlotList_capture_unsupported(void);
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Private data for recorded lists of graphics operations
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef PlotListData_h
+#define PlotListData_h
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "Vertex.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+struct PlotListCmd;
+
+struct PlotListData {
+  _Optional struct PlotListCmd *cmds;
+  size_t count, capacity;
+  bool is_valid, failed;
+};
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Precompiled copies of text definition files
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "stdlib.h"
+#include "stdio.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "OSFile.h"
+
+#include "Debug.h"
+#include "FilePaths.h"
+#include "Utils.h"
+#include "PreComp.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+typedef struct {
+  char format[PreCompFormatLen];
+  unsigned int load, exec; /* of the text file, including its date stamp */
+  int length; /* of the text file */
+  int param;
+} PreCompHeader;
+
+/* ---------------- Private functions ---------------- */
+
+static bool make_header(PreCompHeader *const hdr, char const *const src_path,
+  char const *const format, int const param)
+{
+  assert(hdr);
+  assert(src_path);
+  assert(format);
+  assert(strlen(format) == PreCompFormatLen);
+
+  OS_File_CatalogueInfo catalogue_info;
+  if (os_file_read_cat_no_path(src_path, &catalogue_info) != NULL ||
+      catalogue_info.object_type != ObjectType_File) {
+    return false;
+  }
+
+  *hdr = (PreCompHeader){
+    .load = catalogue_info.load,
+    .exec = catalogue_info.exec,
+    .length = catalogue_info.length,
+    .param = param,
+  };
+  memcpy(hdr->format, format, sizeof(hdr->format));
+  return true;
+}
+
+static _Optional char *make_path(char const *const dir, char const *const leaf)
+{
+  return make_file_path_in_subdir(CHOICES_WRITE_PATH PRECOMP_DIR, dir, leaf);
+}
+
+/* ---------------- Public functions ---------------- */
+
+_Optional FILE *PreComp_open(char const *const dir, char const *const leaf,
+  char const *const src_path, char const *const format, int const param)
+{
+  PreCompHeader expected;
+  if (!make_header(&expected, src_path, format, param)) {
+    return NULL;
+  }
+
+  _Optional char *const path = make_path(dir, leaf);
+  if (!path) {
+    return NULL;
+  }
+
+  _Optional FILE *file = NULL;
+  if (file_exists(&*path)) {
+    file = fopen(&*path, "rb");
+  }
+
+  if (file) {
+    PreCompHeader hdr;
+    if (fread(&hdr, sizeof(hdr), 1, &*file) != 1 ||
+        memcmp(&hdr, &expected, sizeof(hdr)) != 0) {
+      DEBUGF("Precompiled file '%s' is out of date\n", &*path);
+      fclose(&*file);
+      file = NULL;
+    }
+  }
+
+  free(path);
+  return file;
+}
+
+void PreComp_save(char const *const dir, char const *const leaf,
+  char const *const src_path, char const *const format, int const param,
+  PreCompWriteFn *const write, void *const arg)
+{
+  assert(write);
+
+  PreCompHeader hdr;
+  if (!make_header(&hdr, src_path, format, param)) {
+    return;
+  }
+
+  _Optional char *const path = make_path(dir, leaf);
+  if (!path) {
+    return;
+  }
+
+  if (ensure_path_exists(&*path)) {
+    DEBUGF("Writing precompiled file '%s'\n", &*path);
+    _Optional FILE *const file = fopen(&*path, "wb");
+    if (file) {
+      bool success = fwrite(&hdr, sizeof(hdr), 1, &*file) == 1 &&
+                     write(&*file, arg);
+
+      if (fclose(&*file)) {
+        success = false;
+      }
+
+      if (!success) {
+        /* Don't leave a partial file that might be mistaken for valid */
+        DEBUGF("Failed to write precompiled file\n");
+        remove(&*path);
+      }
+    }
+  }
+
+  free(path);
+}
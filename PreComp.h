@@ -0,0 +1,36 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Precompiled copies of text definition files
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef PreComp_h
+#define PreComp_h
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+enum {
+  PreCompFormatLen = 4,
+};
+
+typedef bool PreCompWriteFn(FILE *file, void *arg);
+
+/* Opens the precompiled copy of a text file (found in a directory of the
+   same name as the text file's own) for reading, positioned after its header.
+   Fails if the copy has a different format or parameter, or if it was
+   compiled from anything other than the text file's current contents
+   according to its date stamp and length. */
+_Optional FILE *PreComp_open(char const *dir, char const *leaf,
+  char const *src_path, char const *format, int param);
+
+/* Writes a precompiled copy of a text file. No error is reported on failure,
+   because the text file remains usable. */
+void PreComp_save(char const *dir, char const *leaf, char const *src_path,
+  char const *format, int param, PreCompWriteFn *write, void *arg);
+
+#endif
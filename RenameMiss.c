@@ -112,12 +112,12 @@ static void setup_win(void)
 
   {
     _Optional filescan_leafname *leaf_list = NULL;
-    bool bad_path = true;
-    for (size_t i = 0; bad_path && i < ARRAY_SIZE(data); ++i) {
+    size_t list_index = 0;
+    for (size_t i = 0; !leaf_list && i < ARRAY_SIZE(data); ++i) {
       char const *const emh_path = filescan_get_emh_path(data[i].dir);
       if (strnicmp(source_sub_path, emh_path, strlen(emh_path)) == 0) {
         leaf_list = data[i].leaves = filescan_get_leaf_names(data[i].dir, NULL);
-        bad_path = false;
+        list_index = i;
       }
     }
 
@@ -126,14 +126,11 @@ static void setup_win(void)
     }
 
     /* Check to see whether that file exists on relevant list */
-    if (!bad_path) {
-      for (size_t i = 0; *leaf_list[i].leaf_name != '\0'; i++) {
-        if (stricmp(leaf_list[i].leaf_name, pathtail(source_sub_path, 1)) == 0) {
-          DEBUG("Previous source leaf name '%s' validates", source_sub_path);
-          config_copy(source_sub_path);
-          return; /* we have matched displayed leaf name with one on list */
-        }
-      }
+    if (filescan_find_leaf_name(data[list_index].dir,
+                                pathtail(source_sub_path, 1), NULL)) {
+      DEBUG("Previous source leaf name '%s' validates", source_sub_path);
+      config_copy(source_sub_path);
+      return; /* we have matched displayed leaf name with one on list */
     }
   }
 
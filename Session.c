@@ -76,6 +76,10 @@
 #include "SpecialShip.h"
 #include "MapEdit.h"
 #include "ObjectsEdit.h"
+#include "ObjCollMap.h"
+#include "MapOverview.h"
+#include "MapFlat.h"
+#include "ObjFlat.h"
 #include "InfoEdit.h"
 #include "MapCoord.h"
 #include "SessionData.h"
@@ -99,6 +103,7 @@
 #include "MSnakes.h"
 #include "OSnakes.h"
 #include "IntDict.h"
+#include "Journal.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -118,12 +123,16 @@ enum {
   PRIORITY = SchedulerPriority_Min,
   AnimPeriodInCs = 4, /* as 'medium' game speed */
   AnimMaxIntervalCs = 100,
+  AutosaveIntervalCs = 3000,
   HistoryLog2 = 9,
 };
 
 static LinkedList all_list;
 static StrDict single_dict, map_dict, mission_dict;
 
+static SchedulerTime load_gfx(void *handle, SchedulerTime new_time,
+  const volatile bool *time_up);
+
 /* ---------------- Private functions ---------------- */
 
 static void set_edit_win_titles(EditSession *const session)
@@ -299,12 +308,45 @@ static bool start_anims(EditSession *const session)
   return true; /* success */
 }
 
+static SchedulerTime autosave(void *const handle,
+  SchedulerTime const new_time, const volatile bool *const time_up)
+{
+  /* Null event handler for journalling unsaved changes */
+  NOT_USED(time_up);
+  EditSession *const session = handle;
+  assert(session != NULL);
+
+  for (DataType data_type = DataType_First; data_type < DataType_SessionCount; ++data_type)
+  {
+    _Optional DFile *const dfile = session->dfiles[data_type];
+    if (dfile && dfile_get_modified(&*dfile))
+    {
+      (void)Journal_update(&session->journals[data_type], &*dfile, data_type);
+    }
+    else
+    {
+      /* Saved, reverted or closed since the last update */
+      Journal_discard(&session->journals[data_type]);
+    }
+  }
+
+  return new_time + AutosaveIntervalCs;
+}
+
 static void redraw_all(EditSession *const session)
 {
   MapArea const redraw_area = MapArea_make_max();
   Session_redraw(session, &redraw_area, false);
 }
 
+static void stop_gfx_loader(EditSession *const session)
+{
+  if (session->has_gfx_loader) {
+    scheduler_deregister(load_gfx, session);
+    session->has_gfx_loader = false;
+  }
+}
+
 static void stop_anims(EditSession *const session)
 {
   if (!session->actual_animate_map) {
@@ -491,6 +533,10 @@ void Session_redraw_map(EditSession *const session, MapArea const *const area)
   DEBUGF("Redraw map at {%" PRIMapCoord ", %" PRIMapCoord " ,%" PRIMapCoord ", %" PRIMapCoord "}\n",
           area->min.x, area->min.y, area->max.x, area->max.y);
 
+  if (session->overview) {
+    MapOverview_invalidate(&*session->overview, area);
+  }
+
   SESSION_FOR_EACH_EDIT_WIN(session, this_edit_win) {
     EditWin_redraw_map(&this_edit_win->edit_win, area);
   }
@@ -580,6 +626,16 @@ void Session_set_ghost_map_bbox(EditSession *const session, MapArea const *const
   }
 }
 
+void Session_move_ghost_map_bbox(EditSession *const session, MapArea const *const area)
+{
+  assert(session != NULL);
+  assert(MapArea_is_valid(area));
+
+  SESSION_FOR_EACH_EDIT_WIN(session, this_edit_win) {
+    EditWin_move_ghost_map_bbox(&this_edit_win->edit_win, area);
+  }
+}
+
 void Session_add_ghost_obj(EditSession *const session, MapPoint const pos, ObjRef const obj_ref)
 {
   assert(session != NULL);
@@ -608,6 +664,16 @@ void Session_add_ghost_unknown_obj(EditSession *const session, MapArea const *co
   }
 }
 
+void Session_move_ghost_unknown_obj(EditSession *const session, MapArea const *const bbox)
+{
+  assert(session != NULL);
+  assert(MapArea_is_valid(bbox));
+
+  SESSION_FOR_EACH_EDIT_WIN(session, this_edit_win) {
+    EditWin_move_ghost_unknown_obj(&this_edit_win->edit_win, bbox);
+  }
+}
+
 void Session_add_ghost_unknown_info(EditSession *const session, MapArea const *const bbox)
 {
   assert(session != NULL);
@@ -719,14 +785,29 @@ static _Optional EditSession *create_session(InterfaceType const ui_type,
   stringbuffer_init(&session->edit_win_titles);
   intdict_init(&session->edit_wins_array);
 
+  /* Any of these may be null if memory is short. They are kept up to date
+     by edits and rebuilt after whole-file changes (see
+     Session_resource_change). */
+  session->objects.coll_map = ObjCollMap_create();
+  session->map.flat = MapFlat_create();
+  session->objects.flat = ObjFlat_create();
+  session->overview = MapOverview_create();
+
   if (set_main_filename(&*session, filename))
   {
     linkedlist_insert(&all_list, NULL, &session->all_link);
+
+    session->has_autosave = !E(scheduler_register_delay(autosave, &*session,
+                                   AutosaveIntervalCs, PRIORITY));
     return session;
   }
 
   stringbuffer_destroy(&session->filename);
   stringbuffer_destroy(&session->edit_win_titles);
+  ObjCollMap_destroy(session->objects.coll_map);
+  MapFlat_destroy(session->map.flat);
+  ObjFlat_destroy(session->objects.flat);
+  MapOverview_destroy(session->overview);
   free(session);
 
   return NULL;
@@ -822,6 +903,32 @@ void Session_openparentdir(EditSession *const session)
   *last_dot = PATH_SEPARATOR;
 }
 
+static void recheck_modified(EditSession *const session)
+{
+  /* Files whose changes have all been undone by hand don't need saving */
+  bool cleared = false;
+  for (DataType data_type = DataType_First; data_type < DataType_SessionCount; ++data_type)
+  {
+    _Optional DFile *const dfile = session->dfiles[data_type];
+    if (!dfile || !dfile_get_modified(&*dfile) ||
+        compare_with_snapshot(&*dfile, NULL, NULL) != 0)
+    {
+      continue;
+    }
+
+    _Optional char const *const fname = dfile_get_name(&*dfile);
+    if (fname && dfile_set_saved(&*dfile, fname, dfile_get_date(&*dfile)))
+    {
+      cleared = true;
+    }
+  }
+
+  if (cleared)
+  {
+    set_edit_win_titles(session); /* remove unsaved indicator */
+  }
+}
+
 int Session_try_delete_edit_win(EditSession *const session,
   EditWin *const edit_win_to_delete, bool const open_parent)
 {
@@ -832,6 +939,7 @@ int Session_try_delete_edit_win(EditSession *const session,
 
   if (session->number_of_edit_wins <= 1) {
     /* Last edit_win of session is closing - count files with unsaved changes */
+    recheck_modified(session);
     count = Session_count_modified(session);
     if (count == 0) {
       /* No unsaved changes */
@@ -874,6 +982,19 @@ void Session_destroy(EditSession *const session)
     scheduler_deregister(update_animations, session);
   }
 
+  if (session->has_autosave)
+  {
+    scheduler_deregister(autosave, session);
+  }
+
+  stop_gfx_loader(session);
+
+  /* Unsaved changes that the user chose to discard are not recoverable */
+  for (DataType data_type = DataType_First; data_type < DataType_SessionCount; ++data_type)
+  {
+    Journal_discard(&session->journals[data_type]);
+  }
+
 #if !PER_VIEW_SELECT
   if (session->has_editor) {
     Editor_destroy(&session->editor);
@@ -920,6 +1041,10 @@ void Session_destroy(EditSession *const session)
 
   stringbuffer_destroy(&session->filename);
   stringbuffer_destroy(&session->edit_win_titles);
+  ObjCollMap_destroy(session->objects.coll_map);
+  MapFlat_destroy(session->map.flat);
+  ObjFlat_destroy(session->objects.flat);
+  MapOverview_destroy(session->overview);
   linkedlist_remove(&all_list, &session->all_link);
   free(session);
 }
@@ -957,8 +1082,28 @@ static char *get_data_type_string(DataType const data_type)
   return type_desc;
 }
 
+static bool set_saved_state(DFile *const dfile, char const *const fname)
+{
+  if (!set_saved_with_stamp(dfile, fname))
+  {
+    return false;
+  }
+
+  /* Keep a copy of the saved state for reverting without reloading
+     (not fatal if there isn't enough memory) */
+  (void)take_snapshot(dfile);
+  return true;
+}
+
 static bool read_comp_typed(DFile *const dfile, char const *const fname)
 {
+  return !report_error(load_compressed(dfile, fname), fname, "") &&
+         set_saved_state(dfile, fname);
+}
+
+static bool read_comp_shared(DFile *const dfile, char const *const fname)
+{
+  /* Shared files are never edited so there is no need to snapshot them */
   return !report_error(load_compressed(dfile, fname), fname, "") &&
          set_saved_with_stamp(dfile, fname);
 }
@@ -1092,7 +1237,7 @@ bool Session_savemission(EditSession *const session,
         success = write_comp_typed(&*dfile, &*file_paths[0], DataType_Mission);
         if (success) {
           saved_count++;
-          success = set_saved_with_stamp(&*dfile, &*file_paths[0]);
+          success = set_saved_state(&*dfile, &*file_paths[0]);
           filescan_directory_updated(filescan_get_emh_type(path_suffix));
         }
       }
@@ -1106,7 +1251,7 @@ bool Session_savemission(EditSession *const session,
         _Optional DFile *const dfile = Session_get_dfile(session, data_types[i]);
         assert(dfile);
         if (dfile) {
-          success = set_saved_with_stamp(&*dfile, &*file_paths[i]);
+          success = set_saved_state(&*dfile, &*file_paths[i]);
         }
       } else {
         /* Restore paths to ancillary files stored in mission data */
@@ -1211,7 +1356,7 @@ bool Session_savemap(EditSession *const session, char const *const leaf_name, bo
       {
         success = write_comp_typed(&*dfile, &*file_paths[i], data_types[i]);
         if (success) {
-          success = set_saved_with_stamp(&*dfile, &*file_paths[i]);
+          success = set_saved_state(&*dfile, &*file_paths[i]);
           ++saved_count;
         }
       }
@@ -1394,7 +1539,7 @@ static _Optional DFile *get_shared_base_map(EditSession *const session, char con
   map = map_create_base();
   if (map) {
     DFile *const dfile = map_get_dfile(&*map);
-    if (read_comp_typed(&*dfile, filename)) {
+    if (read_comp_shared(&*dfile, filename)) {
       session->map.base = map;
       if (map_share(&*map)) {
         return dfile;
@@ -1421,7 +1566,7 @@ static _Optional DFile *get_shared_base_obj(EditSession *const session, char con
   obj = objects_create_base();
   if (obj) {
     DFile *const dfile = objects_get_dfile(&*obj);
-    if (read_comp_typed(&*dfile, filename)) {
+    if (read_comp_shared(&*dfile, filename)) {
       session->objects.base = obj;
       if (objects_share(&*obj)) {
         return dfile;
@@ -1448,7 +1593,7 @@ static _Optional DFile *get_shared_tiles(EditSession *const session, char const
   textures = MapTex_create();
   if (textures) {
     DFile *const dfile = MapTex_get_dfile(&*textures);
-    if (read_comp_typed(dfile, filename)) {
+    if (read_comp_shared(dfile, filename)) {
       MapTex_load_metadata(&*textures);
       session->textures = &*textures;
       if (MapTex_share(&*textures)) {
@@ -1474,7 +1619,7 @@ static _Optional DFile *get_shared_poly(EditSession *const session, char const *
   graphics = ObjGfx_create();
   if (graphics) {
     DFile *const dfile = ObjGfx_get_dfile(&*graphics);
-    if (read_comp_typed(dfile, filename)) {
+    if (read_comp_shared(dfile, filename)) {
       ObjGfx_load_metadata(&*graphics);
       session->graphics = &*graphics;
       if (ObjGfx_share(&*graphics)) {
@@ -1502,7 +1647,7 @@ static _Optional DFile *get_shared_polycol(EditSession *const session, char cons
   poly_colours = polycol_create();
   if (poly_colours) {
     DFile *const dfile = polycol_get_dfile(&*poly_colours);
-    if (read_comp_typed(dfile, filename)) {
+    if (read_comp_shared(dfile, filename)) {
       session->poly_colours = poly_colours;
       if (polycol_share(&*poly_colours)) {
         return dfile;
@@ -1529,7 +1674,7 @@ static _Optional DFile *get_shared_hillcol(EditSession *const session, char cons
   hill_colours = hillcol_create();
   if (hill_colours) {
     DFile *const dfile = hillcol_get_dfile(&*hill_colours);
-    if (read_comp_typed(dfile, filename)) {
+    if (read_comp_shared(dfile, filename)) {
       session->hill_colours = hill_colours;
       if (hillcol_share(&*hill_colours)) {
         return dfile;
@@ -1606,6 +1751,7 @@ static bool get_shared_file(EditSession *const session, char const *const full_p
       dfile_release(&*session->dfiles[data_type]);
     }
     session->dfiles[data_type] = dfile;
+    session->pending_gfx &= ~(1u << data_type);
   }
 
   return dfile || is_none;
@@ -1628,51 +1774,143 @@ static bool get_shared_leaf(EditSession *const session, DataType const data_type
   return success;
 }
 
-static bool Session_loadreqgfx(EditSession *const session)
+static const struct {
+  DataType resource;
+  DataType dependents[5];
+  bool can_defer; /* may be loaded after the first edit_win has opened */
+} gfx_deps[] = {
+  { DataType_MapTextures, /* is required by... */
+    {DataType_BaseMap, DataType_OverlayMap,
+     DataType_BaseMapAnimations, DataType_OverlayMapAnimations,
+     DataType_Count}, false },
+
+  /* Colours are loaded before meshes so that objects can be drawn as soon
+     as the meshes arrive */
+  { DataType_PolygonColours, /* is required by... */
+    {DataType_BaseObjects, DataType_OverlayObjects,
+     DataType_Mission,
+     DataType_Count}, true },
+
+  { DataType_PolygonMeshes, /* is required by... */
+    {DataType_BaseObjects, DataType_OverlayObjects,
+     DataType_Mission,
+     DataType_Count}, true },
+
+  { DataType_HillColours, /* is required by... */
+    {DataType_BaseObjects, DataType_OverlayObjects,
+     DataType_Count}, true },
+};
+
+static void gfx_loaded(EditSession *const session, DataType const data_type)
+{
+  EditorChangeParams const params = {0};
+  switch (data_type)
+  {
+  case DataType_PolygonColours:
+    Session_resource_change(session, EDITOR_CHANGE_POLYGON_COLOURS, &params);
+    break;
+
+  case DataType_PolygonMeshes:
+    Session_resource_change(session, EDITOR_CHANGE_GFX_ALL_RELOADED, &params);
+    check_ref_range(session);
+    break;
+
+  case DataType_HillColours:
+    Session_resource_change(session, EDITOR_CHANGE_HILL_COLOURS, &params);
+    break;
+
+  default:
+    break;
+  }
+
+  if (Session_objects_ready(session))
+  {
+    redraw_all(session);
+  }
+}
+
+static SchedulerTime load_gfx(void *const handle,
+  SchedulerTime const new_time, const volatile bool *const time_up)
+{
+  /* Null event handler for loading graphics after the first edit_win has
+     opened, one file per call */
+  NOT_USED(time_up);
+  EditSession *const session = handle;
+  assert(session != NULL);
+
+  size_t i = 0;
+  while (i < ARRAY_SIZE(gfx_deps) &&
+         !TEST_BITS(session->pending_gfx, 1u << gfx_deps[i].resource))
+  {
+    ++i;
+  }
+
+  if (i < ARRAY_SIZE(gfx_deps))
+  {
+    DataType const data_type = gfx_deps[i].resource;
+    FilenamesData const *const filenames = Session_get_filenames(session);
+    if (get_shared_leaf(session, data_type, filenames_get(filenames, data_type)))
+    {
+      gfx_loaded(session, data_type);
+    }
+    else
+    {
+      /* Objects can't be shown but the ground map can still be edited */
+      stop_gfx_loader(session);
+      return new_time;
+    }
+  }
+
+  if (!session->pending_gfx)
+  {
+    stop_gfx_loader(session);
+  }
+  return new_time;
+}
+
+static bool Session_loadreqgfx(EditSession *const session, bool const in_background)
 {
   /* Load or borrow graphics data (shared) */
   DEBUG("Loading only those graphics required for session %p", (void *)session);
 
-  static const struct {
-    DataType resource;
-    DataType dependents[5];
-  } deps[] = {
-    { DataType_MapTextures, /* is required by... */
-      {DataType_BaseMap, DataType_OverlayMap,
-       DataType_BaseMapAnimations, DataType_OverlayMapAnimations,
-       DataType_Count} },
-
-    { DataType_PolygonMeshes, /* is required by... */
-      {DataType_BaseObjects, DataType_OverlayObjects,
-       DataType_Mission,
-       DataType_Count} },
-
-    { DataType_PolygonColours, /* is required by... */
-      {DataType_BaseObjects, DataType_OverlayObjects,
-       DataType_Mission,
-       DataType_Count} },
-
-    { DataType_HillColours, /* is required by... */
-      {DataType_BaseObjects, DataType_OverlayObjects,
-       DataType_Count} },
-  };
-
   FilenamesData const *const filenames = Session_get_filenames(session);
-  for (size_t i = 0; i < ARRAY_SIZE(deps); ++i)
+  for (size_t i = 0; i < ARRAY_SIZE(gfx_deps); ++i)
   {
-    for (size_t j = 0; deps[i].dependents[j] != DataType_Count; ++j)
+    /* Each resource is loaded (or borrowed) once, however many of the
+       session's files require it */
+    bool required = false;
+    for (size_t j = 0; !required && gfx_deps[i].dependents[j] != DataType_Count; ++j)
     {
-      if (!Session_has_data(session, deps[i].dependents[j]))
-      {
-        continue;
-      }
+      required = Session_has_data(session, gfx_deps[i].dependents[j]);
+    }
 
-      char const *const leaf_name = filenames_get(filenames, deps[i].resource);
-      if (!get_shared_leaf(session, deps[i].resource, leaf_name))
-      {
-        return false;
-      }
+    if (!required)
+    {
+      continue;
+    }
+
+    if (in_background && gfx_deps[i].can_defer)
+    {
+      session->pending_gfx |= 1u << gfx_deps[i].resource;
+      continue;
     }
+
+    char const *const leaf_name = filenames_get(filenames, gfx_deps[i].resource);
+    if (!get_shared_leaf(session, gfx_deps[i].resource, leaf_name))
+    {
+      return false;
+    }
+  }
+
+  if (session->pending_gfx && !session->has_gfx_loader)
+  {
+    /* Show the ground map as soon as possible and objects once the
+       remaining graphics arrive */
+    if (E(scheduler_register_delay(load_gfx, session, 0, PRIORITY)))
+    {
+      return Session_loadreqgfx(session, false);
+    }
+    session->has_gfx_loader = true;
   }
 
   return true; /* success */
@@ -1788,7 +2026,7 @@ static bool load_map_core(EditSession *const session, char const *const leaf_nam
 
   /* Load or borrow graphics data to display stuff
   (there is no tolerance of bad filenames in MapTex file) */
-  if (!Session_loadreqgfx(session))
+  if (!Session_loadreqgfx(session, true))
   {
     return false;
   }
@@ -2001,7 +2239,7 @@ void Session_notify_saved(EditSession *const session, DataType const data_type,
     {
       /* For oddball files we don't care where they are saved */
       DEBUG("Is oddball file");
-      (void)set_saved_with_stamp(&*dfile, &*canon_save_path);
+      (void)set_saved_state(&*dfile, &*canon_save_path);
       set_main_filename(session, &*canon_save_path);
     }
     else if (Session_can_quick_save(session))
@@ -2036,7 +2274,7 @@ void Session_notify_saved(EditSession *const session, DataType const data_type,
           }
         }
 
-        (void)set_saved_with_stamp(&*dfile, &*canon_save_path);
+        (void)set_saved_state(&*dfile, &*canon_save_path);
         set_edit_win_titles(session); /* remove unsaved indicator */
       }
       free(expect_path);
@@ -2106,7 +2344,7 @@ static bool load_single_core(EditSession *const session, char const *const filen
   }
 
   /* Load only those graphics files that are necessary */
-  if (!Session_loadreqgfx(session))
+  if (!Session_loadreqgfx(session, false))
   {
     return false;
   }
@@ -2156,7 +2394,7 @@ bool Session_open_single_file(char *const filename, DataType const data_type)
           _Optional DFile *const dfile = Session_get_dfile(&*session, data_type);
           assert(dfile);
           if (dfile) {
-            success = set_saved_with_stamp(&*dfile, filename);
+            success = set_saved_state(&*dfile, filename);
           }
         } else {
           Session_destroy(&*session);
@@ -2223,7 +2461,7 @@ static bool load_mission_core(EditSession *const session, char const *const file
 
   /* Load or borrow graphics data to display stuff
   (there is no tolerance of bad filenames in the mission file) */
-  if (!Session_loadreqgfx(session))
+  if (!Session_loadreqgfx(session, false))
   {
     return false;
   }
@@ -2328,6 +2566,18 @@ MapEditContext const *Session_get_map(EditSession const *const session)
   return &session->map;
 }
 
+_Optional MapOverview *Session_get_overview(EditSession *const session)
+{
+  assert(session != NULL);
+  if (!session->overview) {
+    return NULL;
+  }
+
+  MapTex *const textures = Session_get_textures(session);
+  MapOverview_update(&*session->overview, &session->map, &textures->tiles);
+  return session->overview;
+}
+
 void Session_display_msg(EditSession *const session, char const *hint, bool const temp)
 {
   assert(session != NULL);
@@ -2397,7 +2647,7 @@ static void mission_replaced(EditSession *const session,
   Session_resource_change(session, EDITOR_CHANGE_MAP_ALL_REPLACED, &params);
   Session_resource_change(session, EDITOR_CHANGE_OBJ_ALL_REPLACED, &params);
 
-  Session_loadreqgfx(session);
+  Session_loadreqgfx(session, false);
   Session_resource_change(session, EDITOR_CHANGE_TEX_ALL_RELOADED, &params);
   Session_resource_change(session, EDITOR_CHANGE_GFX_ALL_RELOADED, &params);
   Session_resource_change(session, EDITOR_CHANGE_POLYGON_COLOURS, &params);
@@ -2408,6 +2658,29 @@ static void mission_replaced(EditSession *const session,
   check_ref_range(session);
 }
 
+static void contents_replaced(EditSession *const session,
+  DataType const data_type, Filename (*const fnames)[ARRAY_SIZE(fnames_to_keep)])
+{
+  switch (data_type) {
+    case DataType_BaseObjects:
+    case DataType_OverlayObjects:
+      objects_replaced(session);
+      break;
+
+    case DataType_BaseMap:
+    case DataType_OverlayMap:
+      map_replaced(session);
+      break;
+
+    case DataType_Mission:
+      mission_replaced(session, fnames);
+      break;
+
+    default:
+      break;
+  }
+}
+
 void Session_reload(EditSession *const session, DataType const data_type)
 {
   assert(session != NULL);
@@ -2426,33 +2699,59 @@ void Session_reload(EditSession *const session, DataType const data_type)
       keep_fnames(session, &fnames);
     }
 
-    if (!check_file_type(&*fname, data_type) ||
-        !read_comp_typed(&*dfile, &*fname)) {
+    if (has_snapshot(&*dfile)) {
+      /* Restore the saved state from memory instead of reloading it */
+      if (report_error(revert_to_snapshot(&*dfile), &*fname, "") ||
+          !dfile_set_saved(&*dfile, fname, dfile_get_date(&*dfile))) {
+        return;
+      }
+    } else if (!check_file_type(&*fname, data_type) ||
+               !read_comp_typed(&*dfile, &*fname)) {
       return;
     }
 
-    switch (data_type) {
-      case DataType_BaseObjects:
-      case DataType_OverlayObjects:
-        objects_replaced(session);
-        break;
+    contents_replaced(session, data_type, &fnames);
+    set_edit_win_titles(session); /* remove unsaved indicator from title */
+    redraw_all(session);
+  }
+}
 
-      case DataType_BaseMap:
-      case DataType_OverlayMap:
-        map_replaced(session);
-        break;
+bool Session_recover_single_file(char *const filename,
+  DataType const data_type, DFilePatchFn *const patch, void *const arg)
+{
+  if (!Session_open_single_file(filename, data_type))
+  {
+    return false;
+  }
 
-      case DataType_Mission:
-        mission_replaced(session, &fnames);
-        break;
+  _Optional EditSession *const session = strdict_find_value(&single_dict,
+                                                            filename, NULL);
+  if (!session)
+  {
+    return false;
+  }
 
-      default:
-        break;
-    }
+  _Optional DFile *const dfile = Session_get_dfile(&*session, data_type);
+  if (!dfile)
+  {
+    return false;
+  }
 
-    set_edit_win_titles(session); /* remove unsaved indicator from title */
-    redraw_all(session);
+  Filename fnames[ARRAY_SIZE(fnames_to_keep)] = {{0}};
+  if (data_type == DataType_Mission)
+  {
+    keep_fnames(&*session, &fnames);
   }
+
+  if (report_error(patch_uncompressed(&*dfile, patch, arg), filename, ""))
+  {
+    return false;
+  }
+
+  contents_replaced(&*session, data_type, &fnames);
+  Session_notify_changed(&*session, data_type); /* add unsaved indicator */
+  redraw_all(&*session);
+  return true;
 }
 
 static Filename original_leaf; /* FIXME */
@@ -2683,6 +2982,7 @@ int Session_all_count_modified(void)
   LINKEDLIST_FOR_EACH(&all_list, item)
   {
     EditSession *const session = CONTAINER_OF(item, EditSession, all_link);
+    recheck_modified(session);
     count += Session_count_modified(session);
   }
 
@@ -2767,6 +3067,25 @@ void Session_resource_change(EditSession *const session,
     break;
   }
 
+  /* Invalidate cached state before anyone can use it */
+  if (event == EDITOR_CHANGE_MAP_ALL_REPLACED && session->map.flat) {
+    MapFlat_invalidate(&*session->map.flat);
+  }
+
+  if (event == EDITOR_CHANGE_OBJ_ALL_REPLACED && session->objects.flat) {
+    ObjFlat_invalidate(&*session->objects.flat);
+  }
+
+  if ((event == EDITOR_CHANGE_OBJ_ALL_REPLACED ||
+       event == EDITOR_CHANGE_GFX_ALL_RELOADED) && session->objects.coll_map) {
+    ObjCollMap_invalidate(&*session->objects.coll_map);
+  }
+
+  if ((event == EDITOR_CHANGE_MAP_ALL_REPLACED ||
+       event == EDITOR_CHANGE_TEX_ALL_RELOADED) && session->overview) {
+    MapOverview_invalidate_all(&*session->overview);
+  }
+
   SESSION_FOR_EACH_EDIT_WIN(session, this_edit_win) {
 #if PER_VIEW_SELECT
     Editor_resource_change(EditWin_get_editor(&this_edit_win->edit_win), event, params);
@@ -2801,7 +3120,8 @@ void Session_all_graphics_changed(ObjGfx *const graphics, EditorChange const eve
   LINKEDLIST_FOR_EACH(&all_list, item)
   {
     EditSession *const session = CONTAINER_OF(item, EditSession, all_link);
-    if (Session_get_graphics(session) == graphics)
+    /* Graphics may still be loading in the background */
+    if (session->graphics == graphics)
     {
       Session_resource_change(session, event, params);
     }
@@ -3102,6 +3422,13 @@ _Optional PolyColData const *Session_get_poly_colours(const EditSession *const s
   return session->poly_colours;
 }
 
+bool Session_objects_ready(EditSession const *const session)
+{
+  assert(session != NULL);
+  return !TEST_BITS(session->pending_gfx, (1u << DataType_PolygonMeshes) |
+                                          (1u << DataType_PolygonColours));
+}
+
 bool Session_can_quick_save(const EditSession *const session)
 {
   assert(session != NULL);
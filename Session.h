@@ -15,6 +15,7 @@
 #include "Ships.h"
 #include "Editor.h"
 #include "Triggers.h"
+#include "DFileUtils.h"
 
 #if !defined(USE_OPTIONAL) && !defined(_Optional)
 #define _Optional
@@ -83,6 +84,11 @@ void Session_open_mission(const char *filename);
 bool Session_open_single_file(char *filename, DataType data_type);
 bool Session_load_single(const char *filename, DataType data_type, struct Reader *reader);
 
+/* Opens a file in isolation and then modifies its contents, e.g. to restore
+   unsaved changes from an autosave journal. */
+bool Session_recover_single_file(char *filename, DataType data_type,
+  DFilePatchFn *patch, void *arg);
+
 void Session_redraw(EditSession *session, MapArea const *const redraw_area, bool immediate);
 
 bool Session_savemission(EditSession *session, const char *filename, bool force);
@@ -142,6 +148,10 @@ InterfaceType Session_get_ui_type(const EditSession *session);
 struct MapTex *Session_get_textures(const EditSession *session);
 struct ObjGfx *Session_get_graphics(const EditSession *session);
 _Optional struct PolyColData const *Session_get_poly_colours(const EditSession *session);
+
+/* Returns false whilst the graphics needed to draw objects are still being
+   loaded in the background, or if loading them failed. */
+bool Session_objects_ready(EditSession const *session);
 char *Session_get_filename(EditSession *session);
 char *Session_get_save_filename(EditSession *session);
 bool Session_can_save_all(const EditSession *session);
@@ -155,6 +165,9 @@ _Optional struct HillColData const *Session_get_hill_colours(EditSession const *
 struct ObjEditContext *Session_get_objects(EditSession *session);
 struct MapEditContext const *Session_get_map(EditSession const *session);
 
+/* Returns an up-to-date overview of the ground map, or NULL if none. */
+_Optional struct MapOverview *Session_get_overview(EditSession *session);
+
 void Session_show_briefing(EditSession *session);
 void Session_show_performance(EditSession *session, ShipType ship_type);
 void Session_show_special(EditSession *session);
@@ -175,9 +188,11 @@ void Session_display_mode(EditSession *session);
 void Session_redraw_ghost(EditSession *session);
 void Session_clear_ghost_bbox(EditSession *session);
 void Session_set_ghost_map_bbox(EditSession *session, MapArea const *area);
+void Session_move_ghost_map_bbox(EditSession *session, MapArea const *area);
 void Session_add_ghost_obj(EditSession *session, MapPoint pos, ObjRef obj_ref);
 void Session_add_ghost_info(EditSession *session, MapPoint pos);
 void Session_add_ghost_unknown_obj(EditSession *session, MapArea const *area);
+void Session_move_ghost_unknown_obj(EditSession *session, MapArea const *area);
 void Session_add_ghost_unknown_info(EditSession *session, MapArea const *area);
 
 #else
@@ -34,6 +34,7 @@
 #include "DataType.h"
 #include "EditorData.h"
 #include "IntDict.h"
+#include "Journal.h"
 
 #if !defined(USE_OPTIONAL) && !defined(_Optional)
 #define _Optional
@@ -63,6 +64,7 @@ file ("IDEFS::Tamzin.$.H.H_08") */
   StringBuffer edit_win_titles;
 
   _Optional DFile *dfiles[DataType_SessionCount];
+  JournalFile journals[DataType_SessionCount];
 
   struct MapEditContext map;
   struct ObjEditContext objects;
@@ -77,6 +79,9 @@ file ("IDEFS::Tamzin.$.H.H_08") */
   _Optional struct HillColData *hill_colours; /* (Map/Mission) */
   _Optional struct PolyColData *poly_colours; /* (Map/Mission) */
 
+  /* Cached image of the whole ground map, or NULL if none */
+  _Optional struct MapOverview *overview;
+
   /* Filenames of graphics to use and cloud colours
      (copied from mission data if any loaded): */
   GfxConfig gfx_config;
@@ -85,8 +90,12 @@ file ("IDEFS::Tamzin.$.H.H_08") */
 
   unsigned char number_of_edit_wins;
 
+  /* Bit for each data type of graphics still to be loaded in the background */
+  unsigned int pending_gfx;
+
   bool oddball_file:1, desired_animate_map:1, actual_animate_map:1,
-       has_briefing:1, has_special_ship:1, untitled:1;
+       has_briefing:1, has_special_ship:1, untitled:1, has_autosave:1,
+       has_gfx_loader:1;
 #if !PER_VIEW_SELECT
   bool has_editor:1;
 #endif
@@ -24,6 +24,7 @@
 #include <inttypes.h>
 #include <stdint.h>
 #include <math.h>
+#include <string.h>
 
 #include "Macros.h"
 #include "Debug.h"
@@ -701,6 +702,118 @@ void Shapes_line(ShapesWriteFunction *const write, void *const arg,
   }
 }
 
+typedef struct
+{
+  ShapesStroke *stroke;
+  ShapesWriteFunction *write;
+  void *arg;
+  MapArea pending;
+} StrokeContext;
+
+static bool stroke_test_and_set(ShapesStroke *const stroke, MapPoint const pos)
+{
+  assert(stroke);
+  unsigned long const mask = (1ul << stroke->size_log2) - 1;
+  size_t const index = (((unsigned long)pos.y & mask) << stroke->size_log2) |
+                       ((unsigned long)pos.x & mask);
+
+  uint32_t const bit = UINT32_C(1) << (index % 32);
+  uint32_t *const word = &stroke->covered[index / 32];
+  if (*word & bit) {
+    return true;
+  }
+  *word |= bit;
+  return false;
+}
+
+static void stroke_flush(StrokeContext *const context)
+{
+  assert(context);
+  if (MapArea_is_valid(&context->pending)) {
+    context->write(&context->pending, context->arg);
+    context->pending = MapArea_make_invalid();
+  }
+}
+
+static void stroke_run(StrokeContext *const context, MapCoord const y,
+  MapCoord const min_x, MapCoord const max_x)
+{
+  assert(context);
+  assert(min_x <= max_x);
+
+  /* Merge runs of equal width on consecutive rows into one rectangle */
+  MapArea *const pending = &context->pending;
+  if (MapArea_is_valid(pending) && pending->max.y == y - 1 &&
+      pending->min.x == min_x && pending->max.x == max_x) {
+    pending->max.y = y;
+  } else {
+    stroke_flush(context);
+    *pending = (MapArea){{min_x, y}, {max_x, y}};
+  }
+}
+
+static void stroke_filter(MapArea const *const map_area, void *const arg)
+{
+  assert(MapArea_is_valid(map_area));
+  StrokeContext *const context = arg;
+  assert(context);
+
+  for (MapCoord y = map_area->min.y; y <= map_area->max.y; ++y) {
+    MapCoord run_start = 0;
+    bool in_run = false;
+
+    for (MapCoord x = map_area->min.x; x <= map_area->max.x; ++x) {
+      bool const covered = stroke_test_and_set(context->stroke, (MapPoint){x, y});
+      if (!covered && !in_run) {
+        run_start = x;
+        in_run = true;
+      } else if (covered && in_run) {
+        stroke_run(context, y, run_start, x - 1);
+        in_run = false;
+      }
+    }
+
+    if (in_run) {
+      stroke_run(context, y, run_start, map_area->max.x);
+    }
+  }
+}
+
+void Shapes_stroke_init(ShapesStroke *const stroke, int const size_log2)
+{
+  assert(stroke);
+  assert(size_log2 >= 0);
+  assert(size_log2 <= ShapesStroke_MaxSizeLog2);
+
+  stroke->size_log2 = size_log2;
+  memset(stroke->covered, 0, sizeof(stroke->covered));
+}
+
+void Shapes_stroke(ShapesStroke *const stroke, ShapesWriteFunction *const write,
+  void *const arg, MapPoint const start, MapPoint const end,
+  MapCoord const thickness)
+{
+  assert(write);
+  DEBUG("Stroke of thickness %" PRIMapCoord
+        " from %" PRIMapCoord ",%" PRIMapCoord
+        " to %" PRIMapCoord ",%" PRIMapCoord,
+        thickness, start.x, start.y, end.x, end.y);
+
+  StrokeContext context = {
+    .stroke = stroke,
+    .write = write,
+    .arg = arg,
+    .pending = MapArea_make_invalid(),
+  };
+
+  if (MapPoint_compare(start, end)) {
+    Shapes_circ(stroke_filter, &context, start, thickness);
+  } else {
+    Shapes_line(stroke_filter, &context, start, end, thickness);
+  }
+  stroke_flush(&context);
+}
+
 enum {
   STACK_CHUNK_SIZE = 32,
 };
@@ -7,11 +7,24 @@
 #ifndef Shapes_h
 #define Shapes_h
 
+#include <stdint.h>
+
 #include "MapCoord.h"
 
 typedef unsigned char ShapesReadFunction(MapPoint, void *);
 typedef void ShapesWriteFunction(MapArea const *, void *);
 
+enum {
+  ShapesStroke_MaxSizeLog2 = 8,
+};
+
+/* Coverage mask for a stroke made up of many segments, so that each
+   cell is only written once however often the segments overlap. */
+typedef struct ShapesStroke {
+  uint32_t covered[(1ul << (ShapesStroke_MaxSizeLog2 * 2)) / 32];
+  int size_log2;
+} ShapesStroke;
+
 void Shapes_tri(ShapesWriteFunction *write, void *arg,
   MapPoint vertex_A, MapPoint vertex_B, MapPoint vertex_C);
 
@@ -24,6 +37,14 @@ void Shapes_circ(ShapesWriteFunction *write, void *arg,
 void Shapes_line(ShapesWriteFunction *write, void *arg,
   MapPoint start, MapPoint end, MapCoord thickness);
 
+void Shapes_stroke_init(ShapesStroke *stroke, int size_log2);
+
+/* Plots a thick line with rounded ends (or a circle if start and end
+   are the same) but only writes cells not already covered by the stroke.
+   Coordinates wrap at the size given when the stroke was initialised. */
+void Shapes_stroke(ShapesStroke *stroke, ShapesWriteFunction *write,
+  void *arg, MapPoint start, MapPoint end, MapCoord thickness);
+
 bool Shapes_flood(ShapesReadFunction *read,
   ShapesWriteFunction *write, void *arg,
   size_t find, MapPoint centre,
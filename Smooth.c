@@ -28,6 +28,7 @@
 #include <string.h>
 
 #include "flex.h"
+#include "NoBudge.h"
 
 #include "Err.h"
 #include "msgtrans.h"
@@ -43,6 +44,7 @@
 #include "Utils.h"
 #include "MapCoord.h"
 #include "SmoothData.h"
+#include "PreComp.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -57,6 +59,9 @@
 #define UX_SUBGROUP "SubGroup"
 #define SUBGROUP UX_SUBGROUP" %d\n"
 
+/* Change the version number if TexGroupRoot or TileSmoothData change */
+#define COMPILED_FORMAT "TGp1"
+
 enum {
   LineBufferSize = 255,
   InitGroupSize = 8,
@@ -70,6 +75,7 @@ enum {
   MaxScore = NumAdjacent * PerfectMatch,
   MinFuzzyScore = NumAdjacent * FuzzyMatch,
   ErrBufferSize = 64,
+  PreAllocSize = 512,
 };
 
 /* array of TileSmoothData, in tile number order */
@@ -84,19 +90,74 @@ typedef struct
 } TileSmoothData;
 
 
+/* Groups are built in separate arrays whilst reading a text file, then
+   flattened into a single flex block */
+typedef struct
+{
+  bool super;
+  int count, size;
+  _Optional unsigned char *members; /* tile or group numbers in definition order */
+} GroupBuilder;
+
+typedef struct
+{
+  int count, ntiles;
+  _Optional GroupBuilder *groups; /* malloced array, one for each group */
+  _Optional TileSmoothData *smooth; /* malloced array, in tile number order */
+} GroupsBuilder;
+
+/* Precompiled form follows the common header */
+typedef struct
+{
+  int count, ntiles, nmembers;
+} CompiledHeader;
+
 /* ---------------- Private functions ---------------- */
 
-static unsigned char get_group_member(TexGroupRoot *const group, int const index)
+static size_t get_data_size(int const count, int const ntiles,
+  int const nmembers)
 {
-  assert(group != NULL);
-  assert(index < group->count);
-  assert(group->array_anchor != NULL);
-  DEBUG_VERBOSEF("get_group_member %p,%d, count %d\n", (void *)group, index,
-                 group->count);
-  assert(index < flex_size(&group->array_anchor));
+  assert(count >= 0);
+  assert(ntiles >= 0);
+  assert(nmembers >= 0);
+  return ((size_t)count * sizeof(TexGroupRoot)) +
+         ((size_t)ntiles * sizeof(TileSmoothData)) + (size_t)nmembers;
+}
+
+static TexGroupRoot *get_group_root(const MapTexGroups *const groups_data,
+  int const group)
+{
+  assert(groups_data != NULL);
+  assert(groups_data->data_anchor != NULL);
+  assert(group >= 0);
+  assert(group < groups_data->count);
+  return (TexGroupRoot *)groups_data->data_anchor + group;
+}
+
+static TileSmoothData *get_smooth_array(const MapTexGroups *const groups_data)
+{
+  assert(groups_data != NULL);
+  assert(groups_data->data_anchor != NULL);
+  return (TileSmoothData *)((char *)groups_data->data_anchor +
+                            ((size_t)groups_data->count * sizeof(TexGroupRoot)));
+}
 
-  const unsigned char *const member_array = group->array_anchor;
-  return member_array[index];
+static unsigned char *get_member_array(const MapTexGroups *const groups_data)
+{
+  return (unsigned char *)(get_smooth_array(groups_data) + groups_data->ntiles);
+}
+
+static unsigned char get_group_member(const MapTexGroups *const groups_data,
+  int const group, int const index)
+{
+  TexGroupRoot const *const root = get_group_root(groups_data, group);
+  assert(index >= 0);
+  assert(index < root->count);
+  DEBUG_VERBOSEF("get_group_member %d,%d, count %d\n", group, index,
+                 root->count);
+  assert(root->start + index < groups_data->nmembers);
+
+  return get_member_array(groups_data)[root->start + index];
 }
 
 static int calc_match_2(const MapTexGroups *const groups_data,
@@ -116,38 +177,34 @@ static int calc_match_2(const MapTexGroups *const groups_data,
   }
 
   /* the advent of super-groups complicates things somewhat... */
-  assert(groups_data->array);
-  if (!groups_data->array)
-  {
-    return ChangesMismatch;
-  }
-  TexGroupRoot *const tile_groups = &*groups_data->array;
-  TexGroupRoot *const a_group_def = &tile_groups[cand_edge];
-  TexGroupRoot *const b_group_def = &tile_groups[ideal_edge];
-
-  if (b_group_def->super) {
-    for (int b_member = 0; b_member < b_group_def->count; b_member++) {
-      assert(get_group_member(b_group_def, b_member) != UCHAR_MAX);
-      if (a_group_def->super) {
-        for (int a_member = 0; a_member < a_group_def->count; a_member++) {
-          assert(get_group_member(a_group_def, a_member) != UCHAR_MAX);
-          if (get_group_member(b_group_def, b_member) ==
-              get_group_member(a_group_def, a_member)) {
+  TexGroupRoot const a_group_def = *get_group_root(groups_data, cand_edge);
+  TexGroupRoot const b_group_def = *get_group_root(groups_data, ideal_edge);
+
+  if (b_group_def.super) {
+    for (int b_member = 0; b_member < b_group_def.count; b_member++) {
+      unsigned char const b_sub = get_group_member(groups_data, ideal_edge, b_member);
+      assert(b_sub != UCHAR_MAX);
+      if (a_group_def.super) {
+        for (int a_member = 0; a_member < a_group_def.count; a_member++) {
+          unsigned char const a_sub = get_group_member(groups_data, cand_edge, a_member);
+          assert(a_sub != UCHAR_MAX);
+          if (b_sub == a_sub) {
             DEBUG("Perfect subgroup match");
             return PerfectMatch; /* perfect match of two subgroups */
           }
         }
       } else {
-        if (get_group_member(b_group_def, b_member) == cand_edge) {
+        if (b_sub == cand_edge) {
           DEBUG("Perfect match with B subgroup");
           return PerfectMatch; /* perfect match with B subgroup */
         }
       }
     }
-  } else if (a_group_def->super) {
-    for (int a_member = 0; a_member < a_group_def->count; a_member++) {
-      assert(get_group_member(a_group_def, a_member) != UCHAR_MAX);
-      if (get_group_member(a_group_def, a_member) == ideal_edge) {
+  } else if (a_group_def.super) {
+    for (int a_member = 0; a_member < a_group_def.count; a_member++) {
+      unsigned char const a_sub = get_group_member(groups_data, cand_edge, a_member);
+      assert(a_sub != UCHAR_MAX);
+      if (a_sub == ideal_edge) {
         DEBUG("Perfect match with A subgroup");
         return PerfectMatch; /* perfect match with A subgroup */
       }
@@ -184,62 +241,63 @@ static int calc_match(const MapTexGroups *const groups_data,
   return score;
 }
 
-static void init_group(TexGroupRoot *const tile_group)
+static void init_group(GroupBuilder *const tile_group)
 {
   assert(tile_group != NULL);
-  *tile_group = (TexGroupRoot){
+  *tile_group = (GroupBuilder){
     .count = 0,
+    .size = 0,
     .super = false,
+    .members = NULL,
   };
 }
 
-static bool add_group_member(TexGroupRoot *const group, unsigned char const new_member)
+static bool add_group_member(GroupBuilder *const group, unsigned char const new_member)
 {
   assert(group != NULL);
   assert(new_member < UCHAR_MAX);
 
   /*
-    Create or extend the flexblock holding this group's members
+    Create or extend the array holding this group's members
   */
-  bool success = true;
+  if (group->count >= group->size) {
+    int const new_size = group->size > 0 ?
+                         group->size * GroupGrowthFactor : InitGroupSize;
 
-  if (group->count == 0) {
-    success = flex_alloc(&group->array_anchor, InitGroupSize);
-  } else {
-    int const size = flex_size(&group->array_anchor);
-    if (group->count >= size) {
-      success = flex_extend(&group->array_anchor, size * GroupGrowthFactor);
+    _Optional unsigned char *const new_members = realloc(group->members,
+                                                         (size_t)new_size);
+    if (!new_members) {
+      return false;
     }
+    group->members = new_members;
+    group->size = new_size;
   }
 
-  if (success) {
-    /* Add tile number to array of group members */
-    DEBUG("Adding member %d to group %p at index %d", new_member, (void *)group,
-          group->count);
-
-    unsigned char *const member_array = group->array_anchor;
-    member_array[group->count++] = new_member;
-  }
+  /* Add tile number to array of group members */
+  DEBUG("Adding member %d to group %p at index %d", new_member, (void *)group,
+        group->count);
 
-  return success;
+  assert(group->members);
+  group->members[group->count++] = new_member;
+  return true;
 }
 
-static void set_tile_smooth_data(MapTexGroups *const groups_data, MapRef const tile,
+static void set_tile_smooth_data(GroupsBuilder *const builder, MapRef const tile,
                                  bool const dont_smooth, unsigned char const main,
                                  unsigned char const n, unsigned char const e,
                                  unsigned char const s, unsigned char const w)
 {
-  assert(groups_data != NULL);
-  assert(groups_data->smooth_anchor != NULL);
+  assert(builder != NULL);
+  assert(builder->smooth != NULL);
   unsigned char const index = map_ref_to_num(tile);
-  assert(index * (int)sizeof(TileSmoothData) < flex_size(&groups_data->smooth_anchor));
-  assert(main == UCHAR_MAX || main < groups_data->count);
-  assert(n == UCHAR_MAX || n < groups_data->count);
-  assert(e == UCHAR_MAX || e < groups_data->count);
-  assert(s == UCHAR_MAX || s < groups_data->count);
-  assert(w == UCHAR_MAX || w < groups_data->count);
-
-  ((TileSmoothData *)groups_data->smooth_anchor)[index] = (TileSmoothData){
+  assert(index < builder->ntiles);
+  assert(main == UCHAR_MAX || main < builder->count);
+  assert(n == UCHAR_MAX || n < builder->count);
+  assert(e == UCHAR_MAX || e < builder->count);
+  assert(s == UCHAR_MAX || s < builder->count);
+  assert(w == UCHAR_MAX || w < builder->count);
+
+  builder->smooth[index] = (TileSmoothData){
     .dont_smooth = dont_smooth,
     .main_group = main,
     .north_group = n,
@@ -249,38 +307,35 @@ static void set_tile_smooth_data(MapTexGroups *const groups_data, MapRef const t
   };
 }
 
-static void init_tile_smooth_data(MapTexGroups *const groups_data, MapRef const tile)
+static void init_tile_smooth_data(GroupsBuilder *const builder, MapRef const tile)
 {
   /* If there is no UndefinedGroup specified then it is legitimate for
      undefined tiles to remain in the TileSmoothData array. That is why we
      mark ALL fields. */
-  set_tile_smooth_data(groups_data, tile, true, UCHAR_MAX,
+  set_tile_smooth_data(builder, tile, true, UCHAR_MAX,
     UCHAR_MAX, UCHAR_MAX, UCHAR_MAX, UCHAR_MAX);
 }
 
-static void init_smooth_data(MapTexGroups *const groups_data, int const ntiles)
+static void init_smooth_data(GroupsBuilder *const builder)
 {
-  assert(groups_data);
-  groups_data->ntiles = ntiles;
+  assert(builder);
 
-  for (int tile = 0; tile < ntiles; tile++) {
+  for (int tile = 0; tile < builder->ntiles; tile++) {
     assert(tile <= UCHAR_MAX);
     unsigned char const tile_number = (unsigned char)tile;
-    init_tile_smooth_data(groups_data, map_ref_from_num(tile_number));
+    init_tile_smooth_data(builder, map_ref_from_num(tile_number));
   }
 }
 
 static inline TileSmoothData get_tile_smooth_data(
-  MapTexGroups *const groups_data, MapRef const tile)
+  const MapTexGroups *const groups_data, MapRef const tile)
 {
   assert(groups_data != NULL);
-  assert(groups_data->smooth_anchor != NULL);
 
   unsigned char const index = map_ref_to_num(tile);
-  if (index < groups_data->ntiles)
+  if (groups_data->data_anchor != NULL && index < groups_data->ntiles)
   {
-    assert(index * (int)sizeof(TileSmoothData) < flex_size(&groups_data->smooth_anchor));
-    return ((TileSmoothData *)groups_data->smooth_anchor)[index];
+    return get_smooth_array(groups_data)[index];
   }
   else
   {
@@ -324,46 +379,84 @@ static int count_groups_in_file(FILE *const file)
   return num_groups;
 }
 
-static _Optional TexGroupRoot *alloc_groups(int const ngroups)
+static bool init_builder(GroupsBuilder *const builder, int const ngroups,
+  int const ntiles)
 {
-  assert(ngroups > 0);
-  _Optional TexGroupRoot *const roots_array = calloc(ngroups, sizeof(*roots_array));
-  if (roots_array != NULL) {
-    /* For each group, set the flex anchor to NULL and the membership to 0 */
+  assert(builder);
+  assert(ngroups >= 0);
+  assert(ntiles >= 0);
+
+  *builder = (GroupsBuilder){.count = ngroups, .ntiles = ntiles,
+                             .groups = NULL, .smooth = NULL};
+
+  if (ngroups > 0) {
+    builder->groups = malloc(sizeof(*builder->groups) * (size_t)ngroups);
+    if (builder->groups == NULL) {
+      builder->count = 0;
+      return false;
+    }
+
+    /* For each group, set the array pointer to NULL and the membership to 0 */
     for (int i = 0; i < ngroups; ++i) {
-      init_group(&roots_array[i]);
+      init_group(&builder->groups[i]);
     }
   }
-  return roots_array;
+
+  /*
+    Make table for quick look-up of smoothing data for a given tile
+  */
+  builder->smooth = malloc(sizeof(*builder->smooth) * (size_t)HIGHEST(ntiles, 1));
+  if (builder->smooth == NULL) {
+    return false;
+  }
+
+  /*
+    Mark all tiles with magic (reserved) group number
+  */
+  init_smooth_data(builder);
+  return true;
 }
 
-static bool add_undef_to_group(MapTexGroups *const groups_data,
+static void destroy_builder(GroupsBuilder *const builder)
+{
+  assert(builder);
+
+  if (builder->groups != NULL) {
+    GroupBuilder *const tile_groups = &*builder->groups;
+    for (int i = 0; i < builder->count; i++) {
+      free(tile_groups[i].members);
+    }
+    free(tile_groups);
+  }
+  free(builder->smooth);
+}
+
+static bool add_undef_to_group(GroupsBuilder *const builder,
   unsigned char const undef_group, int const ntiles)
 {
-  assert(groups_data != NULL);
+  assert(builder != NULL);
   assert(undef_group < UCHAR_MAX);
-  assert(groups_data->array);
-  if (!groups_data->array) {
+  assert(builder->groups);
+  assert(builder->smooth);
+  if (!builder->groups || !builder->smooth) {
     return false;
   }
 
   /*
     Append undefined tiles to specified group
   */
-  TexGroupRoot *const pgroup = &groups_data->array[undef_group];
+  GroupBuilder *const pgroup = &builder->groups[undef_group];
 
   for (int tile = 0; tile < ntiles; tile++) {
     assert(tile <= UCHAR_MAX);
     unsigned char const tile_number = (unsigned char)tile;
 
-    TileSmoothData const smooth_data =
-      get_tile_smooth_data(groups_data, map_ref_from_num(tile_number));
-
+    TileSmoothData const smooth_data = builder->smooth[tile_number];
     if (smooth_data.main_group != UCHAR_MAX)
       continue;
 
     /* Found an undefined tile */
-    set_tile_smooth_data(groups_data, map_ref_from_num(tile_number),
+    set_tile_smooth_data(builder, map_ref_from_num(tile_number),
                          smooth_data.dont_smooth, undef_group, undef_group,
                          undef_group, undef_group, undef_group);
 
@@ -378,12 +471,12 @@ static bool add_undef_to_group(MapTexGroups *const groups_data,
 }
 
 static SFError read_from_file(FILE *const file,
-  MapTexGroups *const groups_data, unsigned char *const undef_group,
+  GroupsBuilder *const builder, unsigned char *const undef_group,
   int const ntiles, char *const err_buf)
 {
   assert(file != NULL);
   assert(!ferror(file));
-  assert(groups_data != NULL);
+  assert(builder != NULL);
   assert(err_buf);
 
   *err_buf = '\0';
@@ -391,14 +484,14 @@ static SFError read_from_file(FILE *const file,
   char read_line[LineBufferSize];
   int line = 0;
   unsigned char group_num = 0;
-  _Optional TexGroupRoot *pgroup = NULL;
-  int const ngroups = groups_data->count;
-  
-  assert(groups_data->array);
-  if (!groups_data->array) {
+  _Optional GroupBuilder *pgroup = NULL;
+  int const ngroups = builder->count;
+
+  assert(builder->groups);
+  if (!builder->groups) {
     return SFERROR(OK);
   }
-  TexGroupRoot *const array = &*groups_data->array;
+  GroupBuilder *const array = &*builder->groups;
 
   while (read_line_comm(read_line, sizeof(read_line), file, &line) != NULL)
   {
@@ -564,7 +657,7 @@ static SFError read_from_file(FILE *const file,
     pgroup->super = false;
 
     /* Enter full smoothing data into TileSmoothData array */
-    set_tile_smooth_data(groups_data, map_ref_from_num((unsigned char)tile),
+    set_tile_smooth_data(builder, map_ref_from_num((unsigned char)tile),
                          no_smooth != 0, group_num,
                          (unsigned char)n, (unsigned char)e,
                          (unsigned char)s, (unsigned char)w);
@@ -579,6 +672,191 @@ static SFError read_from_file(FILE *const file,
   return SFERROR(OK);
 }
 
+static bool flatten_groups(GroupsBuilder const *const builder,
+  MapTexGroups *const groups_data)
+{
+  assert(builder != NULL);
+  assert(builder->smooth != NULL);
+  assert(builder->groups != NULL || builder->count == 0);
+  assert(groups_data != NULL);
+  assert(groups_data->data_anchor == NULL);
+
+  int nmembers = 0;
+  for (int g = 0; g < builder->count; ++g) {
+    nmembers += builder->groups[g].count;
+  }
+
+  if (!flex_alloc(&groups_data->data_anchor,
+                  (int)get_data_size(builder->count, builder->ntiles, nmembers))) {
+    return false;
+  }
+
+  groups_data->count = builder->count;
+  groups_data->ntiles = builder->ntiles;
+  groups_data->nmembers = nmembers;
+
+  /* Nothing below can cause the flex block to move */
+  unsigned char *const member_array = get_member_array(groups_data);
+  int start = 0;
+
+  for (int g = 0; g < builder->count; ++g) {
+    GroupBuilder const *const group = &builder->groups[g];
+    *get_group_root(groups_data, g) = (TexGroupRoot){
+      .super = group->super,
+      .start = start,
+      .count = group->count,
+    };
+
+    if (group->count > 0) {
+      assert(group->members);
+      memcpy(member_array + start, &*group->members, (size_t)group->count);
+      start += group->count;
+    }
+  }
+
+  memcpy(get_smooth_array(groups_data), &*builder->smooth,
+         sizeof(TileSmoothData) * (size_t)builder->ntiles);
+
+  return true;
+}
+
+static SFError read_text(MapTexGroups *const groups_data,
+  char const *const full_path, int const ntiles, char *const err_buf)
+{
+  DEBUG("Opening tile groups file '%s'", full_path);
+  _Optional FILE *const file = fopen(full_path, "r");
+  if (file == NULL) {
+    return SFERROR(OpenInFail);
+  }
+
+  SFError err = SFERROR(OK);
+  unsigned char undef_group = UCHAR_MAX; /* default is to append undefined tiles to no group */
+
+  /*
+    First pass over file is to establish the maximum group number
+  */
+  GroupsBuilder builder;
+  if (!init_builder(&builder, count_groups_in_file(&*file), ntiles)) {
+    err = SFERROR(NoMem);
+  } else if (builder.count > 0) {
+    /*
+      Second pass over file is to actually read the smoothing data
+    */
+    fseek(&*file, 0, SEEK_SET); /* back to beginning of file */
+    err = read_from_file(&*file, &builder, &undef_group, ntiles, err_buf);
+  }
+  fclose(&*file);
+
+  if (!SFError_fail(err) && undef_group != UCHAR_MAX) {
+    if (!add_undef_to_group(&builder, undef_group, ntiles)) {
+      err = SFERROR(NoMem);
+    }
+  }
+
+  if (!SFError_fail(err) && !flatten_groups(&builder, groups_data)) {
+    err = SFERROR(NoMem);
+  }
+
+  destroy_builder(&builder);
+  return err;
+}
+
+static bool write_compiled(FILE *const file, void *const arg)
+{
+  const MapTexGroups *const groups_data = arg;
+  assert(groups_data != NULL);
+  assert(groups_data->data_anchor != NULL);
+
+  CompiledHeader const hdr = {
+    .count = groups_data->count,
+    .ntiles = groups_data->ntiles,
+    .nmembers = groups_data->nmembers,
+  };
+
+  if (fwrite(&hdr, sizeof(hdr), 1, file) != 1) {
+    return false;
+  }
+
+  nobudge_register(PreAllocSize);
+  bool const success = fwrite(groups_data->data_anchor,
+    get_data_size(hdr.count, hdr.ntiles, hdr.nmembers), 1, file) == 1;
+  nobudge_deregister();
+
+  return success;
+}
+
+static bool is_group_ref(const MapTexGroups *const groups_data,
+  unsigned char const group)
+{
+  return group == UCHAR_MAX || group < groups_data->count;
+}
+
+static bool check_compiled(const MapTexGroups *const groups_data)
+{
+  /* A precompiled file may be corrupt or stale, so check that every index
+     stored in it is in range before anything relies on it */
+  for (int g = 0; g < groups_data->count; ++g) {
+    TexGroupRoot const root = *get_group_root(groups_data, g);
+    if (root.start < 0 || root.count < 0 ||
+        root.count > groups_data->nmembers - root.start) {
+      DEBUGF("Bad members %d..+%d of group %d\n", root.start, root.count, g);
+      return false;
+    }
+
+    unsigned char const *const members = get_member_array(groups_data) + root.start;
+    for (int m = 0; m < root.count; ++m) {
+      if (root.super ? members[m] >= groups_data->count :
+                       members[m] >= groups_data->ntiles) {
+        DEBUGF("Bad member %d of group %d\n", members[m], g);
+        return false;
+      }
+    }
+  }
+
+  TileSmoothData const *const smooth = get_smooth_array(groups_data);
+  for (int t = 0; t < groups_data->ntiles; ++t) {
+    if (!is_group_ref(groups_data, smooth[t].main_group) ||
+        !is_group_ref(groups_data, smooth[t].north_group) ||
+        !is_group_ref(groups_data, smooth[t].east_group) ||
+        !is_group_ref(groups_data, smooth[t].south_group) ||
+        !is_group_ref(groups_data, smooth[t].west_group)) {
+      DEBUGF("Bad group for tile %d\n", t);
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool read_compiled(FILE *const file, MapTexGroups *const groups_data,
+  int const ntiles)
+{
+  assert(groups_data != NULL);
+  assert(groups_data->data_anchor == NULL);
+
+  CompiledHeader hdr;
+  if (fread(&hdr, sizeof(hdr), 1, file) != 1 ||
+      hdr.count < 0 || hdr.count > UCHAR_MAX || hdr.ntiles != ntiles ||
+      hdr.nmembers < 0) {
+    return false;
+  }
+
+  size_t const size = get_data_size(hdr.count, hdr.ntiles, hdr.nmembers);
+  if (!flex_alloc(&groups_data->data_anchor, (int)size)) {
+    return false;
+  }
+
+  groups_data->count = hdr.count;
+  groups_data->ntiles = hdr.ntiles;
+  groups_data->nmembers = hdr.nmembers;
+
+  nobudge_register(PreAllocSize);
+  bool const success = fread(groups_data->data_anchor, size, 1, file) == 1 &&
+                       check_compiled(groups_data);
+  nobudge_deregister();
+
+  return success;
+}
+
 /* ----------------- Public functions ---------------- */
 
 void MapTexGroups_edit(char const *const tiles_set)
@@ -589,7 +867,7 @@ void MapTexGroups_edit(char const *const tiles_set)
 void MapTexGroups_init(MapTexGroups *const groups_data)
 {
   assert(groups_data);
-  *groups_data = (MapTexGroups){.count = 0, .ntiles = 0};
+  *groups_data = (MapTexGroups){.count = 0, .ntiles = 0, .nmembers = 0};
 }
 
 void MapTexGroups_load(MapTexGroups *const groups_data, char const *tiles_set,
@@ -609,50 +887,26 @@ void MapTexGroups_load(MapTexGroups *const groups_data, char const *tiles_set,
 
   hourglass_on();
   if (file_exists(&*full_path)) {
-    /*
-      Make table for quick look-up of smoothing data for a given tile
-    */
-    if (!flex_alloc(&groups_data->smooth_anchor,
-                    ntiles * sizeof(TileSmoothData))) {
-      err = SFERROR(NoMem);
-    } else {
-      /*
-        Mark all tiles with magic (reserved) group number
-      */
-      init_smooth_data(groups_data, ntiles);
-
-      unsigned char undef_group = UCHAR_MAX; /* default is to append undefined tiles to no group */
-
-      DEBUG("Opening tile groups file '%s'", &*full_path);
-      _Optional FILE *const file = fopen(&*full_path, "r");
-      if (file == NULL) {
-        err = SFERROR(OpenInFail);
-      } else {
-        /*
-          First pass over file is to establish the maximum group number
-          (Cannot extend the pointers array using realloc() since the flex anchors
-          would be be invalidated)
-        */
-        groups_data->count = count_groups_in_file(&*file);
-        if (groups_data->count > 0) {
-          groups_data->array = alloc_groups(groups_data->count);
-          if (groups_data->array == NULL) {
-            err = SFERROR(NoMem);
-          } else {
-            /*
-              Second pass over file is to actually read the smoothing data
-            */
-            fseek(&*file, 0, SEEK_SET); /* back to beginning of file */
-            err = read_from_file(&*file, groups_data, &undef_group, ntiles, err_buf);
-          }
-        } /* endif (groups_data->count > 0) */
-        fclose(&*file);
+    /* Prefer a precompiled copy of the text file, if up-to-date */
+    bool loaded = false;
+    _Optional FILE *const file = PreComp_open(TILEGROUPS_DIR, tiles_set,
+                                              &*full_path, COMPILED_FORMAT,
+                                              ntiles);
+    if (file) {
+      loaded = read_compiled(&*file, groups_data, ntiles);
+      fclose(&*file);
+
+      if (!loaded) {
+        MapTexGroups_free(groups_data);
+        MapTexGroups_init(groups_data);
       }
+    }
 
-      if (!SFError_fail(err) && undef_group != UCHAR_MAX) {
-        if (!add_undef_to_group(groups_data, undef_group, ntiles)) {
-          err = SFERROR(NoMem);
-        }
+    if (!loaded) {
+      err = read_text(groups_data, &*full_path, ntiles, err_buf);
+      if (!SFError_fail(err)) {
+        PreComp_save(TILEGROUPS_DIR, tiles_set, &*full_path, COMPILED_FORMAT,
+                     ntiles, write_compiled, groups_data);
       }
     }
   }
@@ -671,13 +925,7 @@ int MapTexGroups_get_count(MapTexGroups const *const groups_data)
 
 int MapTexGroups_get_num_group_members(MapTexGroups *const groups_data, int const group)
 {
-  assert(groups_data != NULL);
-  assert(group < groups_data->count);
-  assert(groups_data->array);
-  if (!groups_data->array) {
-    return 0;
-  }
-  const TexGroupRoot *const pgroup = &groups_data->array[group];
+  const TexGroupRoot *const pgroup = get_group_root(groups_data, group);
   int const n = pgroup->super ? 0 : pgroup->count;
   DEBUGF("There are %d members of texture group %d\n", n, group);
   return n;
@@ -686,26 +934,15 @@ int MapTexGroups_get_num_group_members(MapTexGroups *const groups_data, int cons
 MapRef MapTexGroups_get_group_member(MapTexGroups *const groups_data, int const group,
   int const index)
 {
-  assert(groups_data != NULL);
-  assert(group < groups_data->count);
-  assert(groups_data->array);
-  if (!groups_data->array) {
-    return map_ref_from_num(0);
-  }
-  TexGroupRoot *const pgroup = &groups_data->array[group];
-  unsigned char const tile = get_group_member(pgroup, index);
+  unsigned char const tile = get_group_member(groups_data, group, index);
   DEBUGF("Member %d of texture group %d is tile %d\n", index, group, tile);
   return map_ref_from_num(tile);
 }
 
 int MapTexGroups_get_group_of_tile(MapTexGroups *const groups_data, MapRef const tile)
 {
-  assert(groups_data != NULL);
-  unsigned char const index = map_ref_to_num(tile);
-  assert(index * (int)sizeof(TileSmoothData) < flex_size(&groups_data->smooth_anchor));
-
-  int const group = ((TileSmoothData *)groups_data->smooth_anchor)[index].main_group;
-  DEBUGF("Tile %d is a member of texture group %d\n", index, group);
+  int const group = get_tile_smooth_data(groups_data, tile).main_group;
+  DEBUGF("Tile %d is a member of texture group %d\n", map_ref_to_num(tile), group);
   return group;
 }
 
@@ -713,18 +950,10 @@ void MapTexGroups_free(MapTexGroups *const groups_data)
 {
   assert(groups_data != NULL);
 
-  if (groups_data->array != NULL) {
-    TexGroupRoot *const tile_groups = &*groups_data->array;
-    for (int i = 0; i < groups_data->count; i++) {
-      if (tile_groups[i].array_anchor != NULL)
-        flex_free(&tile_groups[i].array_anchor);
-    }
-    free(tile_groups);
-  }
   groups_data->count = 0;
 
-  if (groups_data->smooth_anchor != NULL) {
-    flex_free(&groups_data->smooth_anchor);
+  if (groups_data->data_anchor != NULL) {
+    flex_free(&groups_data->data_anchor);
   }
 }
 
@@ -736,11 +965,9 @@ void MapTexGroups_smooth(MapEditContext const *const map,
         map_pos.x, map_pos.y);
 
   assert(groups_data != NULL);
-  if (groups_data->smooth_anchor == NULL || groups_data->array == NULL)
+  if (groups_data->data_anchor == NULL || groups_data->count == 0)
     return; /* can do nothing without smoothing data! */
 
-  TexGroupRoot *const array = &*groups_data->array;
-
   MapRef const Ctile = MapEdit_read_tile(map, map_pos);
   if (map_ref_is_mask(Ctile)) {
     DEBUG("no tile at this location");
@@ -802,8 +1029,10 @@ void MapTexGroups_smooth(MapEditContext const *const map,
      Search for a replacement tile (within the same group)
      that fits better with the surrounding tiles
   */
-  TexGroupRoot *const centre_group = &array[ideal_tile.main_group];
-  _Optional MapRef *const best_tiles = malloc(sizeof(*best_tiles) * centre_group->count);
+  TexGroupRoot const centre_group = *get_group_root(groups_data,
+                                                   ideal_tile.main_group);
+  _Optional MapRef *const best_tiles = malloc(sizeof(*best_tiles) *
+                                              (size_t)HIGHEST(centre_group.count, 1));
   if (!best_tiles) {
     report_error(SFERROR(NoMem), "", "");
     return;
@@ -811,13 +1040,11 @@ void MapTexGroups_smooth(MapEditContext const *const map,
 
   int num_found = 0, best_score = current_score;
 
-  if (centre_group == NULL)
-    return; /* don't know about this group! */
-
-  assert(!centre_group->super);
-  for (int member = 0; member < centre_group->count; member++)
+  assert(!centre_group.super);
+  for (int member = 0; member < centre_group.count; member++)
   {
-    MapRef const member_tile = map_ref_from_num(get_group_member(centre_group, member));
+    MapRef const member_tile = map_ref_from_num(
+      get_group_member(groups_data, ideal_tile.main_group, member));
     TileSmoothData const member_data =
       get_tile_smooth_data(groups_data, member_tile);
 
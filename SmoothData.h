@@ -14,27 +14,31 @@
 #endif
 
 /*
+  All of the data is held in a single flex block so that it can be loaded
+from a precompiled file with one read.
+
+  The array of TexGroupRoot elements allows us to quickly find the tiles in a
+given group. Each block contains the index of the group's first member in the
+array of all groups' members.
+
   The array of TileSmoothData allows us to quickly find the group number of a
 given tile. Each element is a TileSmoothData block that contains the NESW edge
 data for use of the smoothing wand.
-
-  The array of TexGroupRoot elements allows us to quickly find the tiles in a
-given group. Each block contains a pointer to a flex array of group members.
 */
 
 typedef struct
 {
   bool super;
+  int start; /* index of the first tile or group number */
   int count;
-  /* flex anchor for array of tile or group numbers in definition order */
-  void *array_anchor;
 } TexGroupRoot;
 
 struct MapTexGroups {
-  int count, ntiles;
-  _Optional TexGroupRoot *array; /* malloced array of TexGroupRoots, one for each group */
-  void *smooth_anchor; /* flex anchor for an array of
-                          TileSmoothData, in tile number order */
+  int count, ntiles, nmembers;
+  void *data_anchor; /* flex anchor for an array of TexGroupRoot, one for each
+                        group, followed by an array of TileSmoothData in tile
+                        number order, followed by the tile or group numbers of
+                        all groups' members in definition order */
 };
 
 #endif
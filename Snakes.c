@@ -26,6 +26,7 @@
 #include <stdint.h>
 
 #include "flex.h"
+#include "NoBudge.h"
 #include "Macros.h"
 #include "Debug.h"
 
@@ -33,6 +34,7 @@
 #include "SnakesData.h"
 #include "MapCoord.h"
 #include "Utils.h"
+#include "PreComp.h"
 
 #ifdef USE_OPTIONAL
 #include "Optional.h"
@@ -43,6 +45,9 @@
 #define UX_ENDSNAKEMARK "EndSnake"
 #define ENDSNAKEMARK UX_ENDSNAKEMARK"\n"
 
+/* Change the version number if SnakeDefinition changes */
+#define COMPILED_FORMAT "Snk1"
+
 /*
   SNAKE_INSIDE is a fudge to allow the snakes tool to double as an edging tool:
 Unlike simple road pieces, edging bits have 'sides' and therefore
@@ -81,6 +86,7 @@ enum {
   LineBufferSize = 255,
   InitSnakesArraySize = 8,
   SnakesArrayGrowthFactor = 2,
+  PreAllocSize = 512,
 };
 
 typedef struct {
@@ -291,6 +297,28 @@ static bool add_snake(Snakes *const snakes_data, SnakeDefinition *const snake)
   return success;
 }
 
+static bool write_compiled(FILE *const file, void *const arg)
+{
+  Snakes const *const snakes_data = arg;
+  assert(snakes_data != NULL);
+
+  if (fwrite(&snakes_data->count, sizeof(snakes_data->count), 1, file) != 1) {
+    return false;
+  }
+
+  if (snakes_data->count == 0) {
+    return true;
+  }
+
+  nobudge_register(PreAllocSize);
+  bool const success = fwrite(snakes_data->data_anchor, sizeof(SnakeDefinition),
+                         (size_t)snakes_data->count, file) ==
+                       (size_t)snakes_data->count;
+  nobudge_deregister();
+
+  return success;
+}
+
 //static bool part_is_bi_sided(const SnakeContext *const ctx,
 //  unsigned int const snake_part)
 //{
@@ -1220,6 +1248,73 @@ SFError Snakes_load(FILE *const file, Snakes *const snakes_data,
   return SFERROR(OK);
 }
 
+static bool check_compiled(SnakeDefinition const *const defs, int const count,
+  int const nobj)
+{
+  /* A precompiled file may be corrupt or stale */
+  for (int s = 0; s < count; ++s) {
+    if (memchr(defs[s].name, '\0', sizeof(defs[s].name)) == NULL) {
+      return false;
+    }
+    for (size_t p = 0; p < ARRAY_SIZE(defs[s].read_parts); ++p) {
+      if ((defs[s].read_parts[p] != UCHAR_MAX && defs[s].read_parts[p] >= nobj) ||
+          (defs[s].write_parts[p] != UCHAR_MAX && defs[s].write_parts[p] >= nobj)) {
+        DEBUG("Bad part %zu of snake %d", p, s);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool Snakes_load_compiled(Snakes *const snakes_data, char const *const dir,
+  char const *const leaf, char const *const src_path, int const nobj)
+{
+  assert(snakes_data != NULL);
+
+  _Optional FILE *const file = PreComp_open(dir, leaf, src_path,
+                                            COMPILED_FORMAT, nobj);
+  if (!file) {
+    return false;
+  }
+
+  Snakes_free(snakes_data);
+  Snakes_init(snakes_data);
+
+  int count;
+  bool success = fread(&count, sizeof(count), 1, &*file) == 1 && count >= 0;
+
+  if (success && count > 0) {
+    /* The definition array is read in one go */
+    success = flex_alloc(&snakes_data->data_anchor,
+                         count * (int)sizeof(SnakeDefinition));
+    if (success) {
+      nobudge_register(PreAllocSize);
+      success = fread(snakes_data->data_anchor, sizeof(SnakeDefinition),
+                      (size_t)count, &*file) == (size_t)count &&
+                check_compiled(snakes_data->data_anchor, count, nobj);
+      nobudge_deregister();
+    }
+  }
+  fclose(&*file);
+
+  if (success) {
+    DEBUG("Loaded %d precompiled snakes", count);
+    snakes_data->count = count;
+  } else {
+    Snakes_free(snakes_data);
+    Snakes_init(snakes_data);
+  }
+  return success;
+}
+
+void Snakes_save_compiled(Snakes *const snakes_data, char const *const dir,
+  char const *const leaf, char const *const src_path, int const nobj)
+{
+  PreComp_save(dir, leaf, src_path, COMPILED_FORMAT, nobj, write_compiled,
+               snakes_data);
+}
+
 void Snakes_free(Snakes *const snakes_data)
 {
   assert(snakes_data != NULL);
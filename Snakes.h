@@ -54,6 +54,14 @@ enum {
 SFError Snakes_load(FILE *const file, Snakes *const snakes_data,
   int const nobj, char *const err_buf);
 
+/* Loads snake definitions from a precompiled copy of the given text file,
+   if up-to-date. */
+bool Snakes_load_compiled(Snakes *snakes_data, char const *dir,
+  char const *leaf, char const *src_path, int nobj);
+
+void Snakes_save_compiled(Snakes *snakes_data, char const *dir,
+  char const *leaf, char const *src_path, int nobj);
+
 int Snakes_begin_line(SnakeContext *ctx,
   Snakes *snakes_data, MapPoint map_pos, int snake,
   bool inside, SnakesReadFunction *read,
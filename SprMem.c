@@ -19,6 +19,7 @@
  */
 
 #include "stdlib.h"
+#include "stdio.h"
 #include <stdbool.h>
 #include "kernel.h"
 
@@ -471,6 +472,55 @@ bool SprMem_save(const SprMem *const sm, char const *const filename)
   return success;
 }
 
+bool SprMem_write(const SprMem *const sm, FILE *const file)
+{
+  assert(sm != NULL);
+  assert(file != NULL);
+
+  nobudge_register(PREALLOC_SIZE);
+  SpriteAreaHeader hdr = *(SpriteAreaHeader *)sm->mem;
+  int const size = hdr.used;
+  assert(size >= (int)sizeof(hdr));
+  hdr.size = size; /* exclude free space */
+
+  bool const success = fwrite(&size, sizeof(size), 1, file) == 1 &&
+    fwrite(&hdr, sizeof(hdr), 1, file) == 1 &&
+    (size == (int)sizeof(hdr) ||
+     fwrite((char *)sm->mem + sizeof(hdr), (size_t)size - sizeof(hdr), 1, file) == 1);
+  nobudge_deregister();
+
+  return success;
+}
+
+bool SprMem_read(SprMem *const sm, FILE *const file)
+{
+  assert(sm != NULL);
+  assert(file != NULL);
+
+  int size;
+  if (fread(&size, sizeof(size), 1, file) != 1 ||
+      size < (int)sizeof(SpriteAreaHeader)) {
+    return false;
+  }
+
+  if (!flex_alloc(&sm->mem, size)) {
+    return false;
+  }
+
+  nobudge_register(PREALLOC_SIZE);
+  SpriteAreaHeader *const area = sm->mem;
+  bool const success = fread(area, (size_t)size, 1, file) == 1 &&
+                       area->size == size && area->used == size &&
+                       os_sprite_op_verify(area) == NULL;
+  nobudge_deregister();
+
+  if (!success) {
+    DEBUGF("Bad sprite area data\n");
+    flex_free(&sm->mem);
+  }
+  return success;
+}
+
 void SprMem_destroy(SprMem *const sm)
 {
   assert(sm != NULL);
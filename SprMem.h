@@ -7,6 +7,7 @@
 #ifndef SprMem_h
 #define SprMem_h
 
+#include <stdio.h>
 #include <stdbool.h>
 #include "SprFormats.h"
 #include "Vertex.h"
@@ -81,6 +82,14 @@ bool SprMem_verify(const SprMem *sm);
 
 bool SprMem_save(const SprMem *sm, char const *filename);
 
+/* Writes the used part of the sprite area to an open file, preceded by its
+   size. Unlike SprMem_save, no error is reported on failure. */
+bool SprMem_write(const SprMem *sm, FILE *file);
+
+/* Initialises a sprite area from data written by SprMem_write. Fails without
+   reporting an error if the data is truncated or not a valid sprite area. */
+bool SprMem_read(SprMem *sm, FILE *file);
+
 void SprMem_destroy(SprMem *sm);
 
 #endif
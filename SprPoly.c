@@ -0,0 +1,210 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Plot filled polygons directly into an 8bpp sprite
+ *  Copyright (C) 2026 Christopher Bazley
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public Licence as published by
+ *  the Free Software Foundation; either version 2 of the Licence, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public Licence for more details.
+ *
+ *  You should have received a copy of the GNU General Public Licence
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include "SprFormats.h"
+
+#include "Macros.h"
+#include "Debug.h"
+#include "PalEntry.h"
+
+#include "Vertex.h"
+#include "SprPoly.h"
+
+#ifdef USE_OPTIONAL
+#include "Optional.h"
+#endif
+
+enum {
+  BytesPerWord = 4,
+};
+
+/* ---------------- Private functions ---------------- */
+
+static long int ceil_div(long long int const n, long int const d)
+{
+  assert(d > 0);
+  long long int const q = n / d;
+  return (long int)((n % d > 0) ? q + 1 : q);
+}
+
+static long int first_pixel_at_or_after(long long int const os_coord, int const eig)
+{
+  /* Smallest pixel index whose centre is at or after the given coordinate */
+  long int const unit = 1l << eig;
+  return ceil_div(os_coord - (unit / 2), unit);
+}
+
+static void fill_row(SprPoly *const sp, int const y, int x_min, int x_max)
+{
+  x_min = HIGHEST(x_min, sp->clip.xmin);
+  x_max = LOWEST(x_max, sp->clip.xmax);
+  if (x_min >= x_max) {
+    return;
+  }
+
+  /* Pixel rows are numbered upwards but stored top-down */
+  unsigned char *const row = sp->image + ((size_t)(sp->size.y - 1 - y) * sp->row_bytes);
+  memset(row + x_min, sp->colour, (size_t)(x_max - x_min));
+}
+
+/* ---------------- Public functions ---------------- */
+
+void SprPoly_init(SprPoly *const sp, unsigned char *const image,
+  size_t const row_bytes, Vertex const size, Vertex const eig,
+  PaletteEntry const (*const palette)[NumColours])
+{
+  assert(sp);
+  assert(image);
+  assert(size.x >= 0);
+  assert(size.y >= 0);
+  assert(row_bytes >= (size_t)size.x);
+  assert(palette);
+
+  *sp = (SprPoly){
+    .image = image,
+    .row_bytes = row_bytes,
+    .size = size,
+    .eig = eig,
+    .clip = {0, 0, size.x, size.y},
+    .colour = 0,
+    .palette = palette,
+  };
+}
+
+bool SprPoly_init_sprite(SprPoly *const sp, SpriteHeader *const sprite,
+  Vertex const eig, PaletteEntry const (*const palette)[NumColours])
+{
+  /* Only 8 bits per pixel sprites with no left-hand wastage are supported,
+     like those created by SprMem_create_sprite. */
+  assert(sprite);
+  if (sprite->left_bit != 0) {
+    return false;
+  }
+
+  size_t const row_bytes = (size_t)(sprite->width + 1) * BytesPerWord;
+  int const last_byte_bits = sprite->right_bit + 1;
+  Vertex const size = {
+    .x = (sprite->width * BytesPerWord) + (last_byte_bits >> SprPolyLog2BPP),
+    .y = sprite->height + 1,
+  };
+
+  SprPoly_init(sp, (unsigned char *)sprite + sprite->image, row_bytes, size,
+               eig, palette);
+  return true;
+}
+
+void SprPoly_set_clip(SprPoly *const sp, BBox const *const bbox)
+{
+  assert(sp);
+  assert(bbox);
+
+  /* Pixels are clipped if their centre lies outside the bounding box */
+  sp->clip = (BBox){
+    .xmin = HIGHEST(0, (int)first_pixel_at_or_after(bbox->xmin, sp->eig.x)),
+    .ymin = HIGHEST(0, (int)first_pixel_at_or_after(bbox->ymin, sp->eig.y)),
+    .xmax = LOWEST(sp->size.x, (int)first_pixel_at_or_after(bbox->xmax, sp->eig.x)),
+    .ymax = LOWEST(sp->size.y, (int)first_pixel_at_or_after(bbox->ymax, sp->eig.y)),
+  };
+}
+
+void SprPoly_set_colour(SprPoly *const sp, PaletteEntry const colour)
+{
+  assert(sp);
+
+  /* Most polygons share a few colours so remember recent matches */
+  size_t const slot = (colour >> CHAR_BIT) % SprPolyColourCacheSize;
+  if (!sp->cache_valid[slot] || sp->cache_keys[slot] != colour) {
+    int const nearest = nearest_palette_entry(*sp->palette, NumColours, colour);
+    assert(nearest >= 0);
+    assert(nearest < NumColours);
+    sp->cache_keys[slot] = colour;
+    sp->cache_values[slot] = (unsigned char)nearest;
+    sp->cache_valid[slot] = true;
+  }
+  sp->colour = sp->cache_values[slot];
+}
+
+void SprPoly_set_native_colour(SprPoly *const sp, unsigned char const colour)
+{
+  assert(sp);
+  sp->colour = colour;
+}
+
+void SprPoly_fill_tri(SprPoly *const sp, Vertex const a, Vertex const b, Vertex const c)
+{
+  Vertex const corners[] = {a, b, c};
+  SprPoly_fill_convex(sp, ARRAY_SIZE(corners), corners);
+}
+
+void SprPoly_fill_convex(SprPoly *const sp, int const num_sides,
+  Vertex const *const corners)
+{
+  assert(sp);
+  assert(num_sides >= 3);
+  assert(corners);
+
+  int os_ymin = corners[0].y, os_ymax = corners[0].y;
+  for (int side = 1; side < num_sides; ++side) {
+    os_ymin = LOWEST(os_ymin, corners[side].y);
+    os_ymax = HIGHEST(os_ymax, corners[side].y);
+  }
+
+  int const y_min = HIGHEST(sp->clip.ymin,
+                            (int)first_pixel_at_or_after(os_ymin, sp->eig.y));
+  int const y_max = LOWEST(sp->clip.ymax,
+                           (int)first_pixel_at_or_after(os_ymax, sp->eig.y));
+
+  long int const y_unit = 1l << sp->eig.y;
+  for (int y = y_min; y < y_max; ++y) {
+    /* Find where the row's centre line crosses the edges. Each edge
+       includes its lower end but not its upper end so that no row is
+       crossed twice at a shared vertex. */
+    long int const os_y = (y * y_unit) + (y_unit / 2);
+    long long int os_xmin = LLONG_MAX, os_xmax = LLONG_MIN;
+
+    for (int side = 0; side < num_sides; ++side) {
+      Vertex const p = corners[side];
+      Vertex const q = corners[(side + 1) % num_sides];
+      Vertex const lo = p.y <= q.y ? p : q;
+      Vertex const hi = p.y <= q.y ? q : p;
+
+      if (os_y < lo.y || os_y >= hi.y) {
+        continue;
+      }
+
+      long long int const os_x = lo.x +
+        ((long long int)(os_y - lo.y) * (hi.x - lo.x)) / (hi.y - lo.y);
+
+      os_xmin = LOWEST(os_xmin, os_x);
+      os_xmax = HIGHEST(os_xmax, os_x);
+    }
+
+    if (os_xmin <= os_xmax) {
+      fill_row(sp, y, (int)first_pixel_at_or_after(os_xmin, sp->eig.x),
+                      (int)first_pixel_at_or_after(os_xmax, sp->eig.x));
+    }
+  }
+}
@@ -0,0 +1,56 @@
+/*
+ *  SFeditor - Star Fighter 3000 map/mission editor
+ *  Plot filled polygons directly into an 8bpp sprite
+ *  Copyright (C) 2026 Christopher Bazley
+ */
+
+#ifndef SprPoly_h
+#define SprPoly_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "SprFormats.h"
+#include "PalEntry.h"
+#include "Vertex.h"
+#include "SFInit.h"
+
+#if !defined(USE_OPTIONAL) && !defined(_Optional)
+#define _Optional
+#endif
+
+enum {
+  SprPolyLog2BPP = 3,
+  SprPolyColourCacheSize = 16,
+};
+
+typedef struct SprPoly {
+  unsigned char *image; /* top row of pixels */
+  size_t row_bytes;
+  Vertex size; /* in pixels */
+  Vertex eig; /* log2 of OS units per pixel */
+  BBox clip; /* in pixels, exclusive of max */
+  unsigned char colour;
+  PaletteEntry const (*palette)[NumColours];
+  PaletteEntry cache_keys[SprPolyColourCacheSize];
+  unsigned char cache_values[SprPolyColourCacheSize];
+  bool cache_valid[SprPolyColourCacheSize];
+} SprPoly;
+
+/* Coordinates are in OS units relative to the bottom left corner of the
+   image, as they would be if output were switched to the sprite. */
+void SprPoly_init(SprPoly *sp, unsigned char *image, size_t row_bytes,
+  Vertex size, Vertex eig, PaletteEntry const (*palette)[NumColours]);
+
+bool SprPoly_init_sprite(SprPoly *sp, SpriteHeader *sprite, Vertex eig,
+  PaletteEntry const (*palette)[NumColours]);
+
+void SprPoly_set_clip(SprPoly *sp, BBox const *bbox);
+
+void SprPoly_set_colour(SprPoly *sp, PaletteEntry colour);
+void SprPoly_set_native_colour(SprPoly *sp, unsigned char colour);
+
+void SprPoly_fill_tri(SprPoly *sp, Vertex a, Vertex b, Vertex c);
+void SprPoly_fill_convex(SprPoly *sp, int num_sides, Vertex const *corners);
+
+#endif
@@ -839,9 +839,9 @@ _Optional char *make_file_path_in_dir(char const *const dir, char const *const l
   return make_file_path_in_dir_on_path("", dir, leaf);
 }
 
-bool report_error(SFError const err, char const *const path, char const *const extra)
+char *get_error_text(SFError const err, char const *const path,
+  char const *const extra)
 {
-  bool is_err = true;
   static char const *const ms_to_token[] = {
 #define DECLARE_ERROR(ms) [SFErrorType_ ## ms] = #ms,
 #include "DeclErrors.h"
@@ -852,14 +852,22 @@ bool report_error(SFError const err, char const *const path, char const *const e
 
 #undef DECLARE_ERROR
   };
+  assert(err.type >= 0);
+  assert((size_t)err.type < ARRAY_SIZE(ms_to_token));
+  DEBUGF("Error %s from %s\n", ms_to_token[err.type], err.loc);
+  return msgs_lookup_subn(ms_to_token[err.type], 2, path, extra);
+}
+
+bool report_error(SFError const err, char const *const path, char const *const extra)
+{
+  bool is_err = true;
   if (!SFError_fail(err))
   {
     is_err = false;
   }
   else if (err.type != SFErrorType_AlreadyReported)
   {
-    DEBUGF("Reporting %s from %s\n", ms_to_token[err.type], err.loc);
-    err_report(DUMMY_ERRNO, msgs_lookup_subn(ms_to_token[err.type], 2, path, extra));
+    err_report(DUMMY_ERRNO, get_error_text(err, path, extra));
   }
   return is_err;
 }
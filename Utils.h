@@ -111,6 +111,9 @@ _Optional char *make_file_path_in_subdir(char const *dir, char const *subdir,
 
 _Optional char *make_file_path_in_dir(char const *dir, char const *leaf);
 
+/* Gets the message for an error, without reporting it */
+char *get_error_text(SFError err, char const *load_path, char const *extra);
+
 bool report_error(SFError err, char const *load_path, char const *extra);
 
 void load_fail(_Optional CONST _kernel_oserror *error, void *client_handle);